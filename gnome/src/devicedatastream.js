@@ -5,7 +5,9 @@ import Globals from './globals.js';
 import { 
     dataViewEnd,
     dataViewUint8,
+    dataViewUint,
     dataViewBigUint,
+    dataViewBigUintArray,
     dataViewUint32Array,
     dataViewUint8Array,
     dataViewFloat,
@@ -20,31 +22,58 @@ import { isValidKeepAlive, getEpochSec, toSec } from "./time.js";
 const IPC_FILE_PATH = "/dev/shm/breezy_desktop_imu";
 const KEEPALIVE_REFRESH_INTERVAL_SEC = 1;
 
-// the driver should be using the same data layout version
-const DATA_LAYOUT_VERSION = 5;
+// the driver should be using one of these data layout versions (see shared/ipc/breezy_shm_layout.h)
+const DATA_LAYOUT_VERSION_V5 = 5;
+const DATA_LAYOUT_VERSION_V6 = 6;
 
 // DataView info: [offset, size, count]
 const VERSION = [0, UINT8_SIZE, 1];
 const ENABLED = [dataViewEnd(VERSION), BOOL_SIZE, 1];
-const LOOK_AHEAD_CFG = [dataViewEnd(ENABLED), FLOAT_SIZE, 4];
-const DISPLAY_RES = [dataViewEnd(LOOK_AHEAD_CFG), UINT_SIZE, 2];
-const DISPLAY_FOV = [dataViewEnd(DISPLAY_RES), FLOAT_SIZE, 1];
-const LENS_DISTANCE_RATIO = [dataViewEnd(DISPLAY_FOV), FLOAT_SIZE, 1];
-const SBS_ENABLED = [dataViewEnd(LENS_DISTANCE_RATIO), BOOL_SIZE, 1];
-const CUSTOM_BANNER_ENABLED = [dataViewEnd(SBS_ENABLED), BOOL_SIZE, 1];
-const SMOOTH_FOLLOW_ENABLED = [dataViewEnd(CUSTOM_BANNER_ENABLED), BOOL_SIZE, 1];
-const SMOOTH_FOLLOW_ORIGIN_DATA = [dataViewEnd(SMOOTH_FOLLOW_ENABLED), FLOAT_SIZE, 16];
-const POSE_POSITION = [dataViewEnd(SMOOTH_FOLLOW_ORIGIN_DATA), FLOAT_SIZE, 3];
-const EPOCH_MS = [dataViewEnd(POSE_POSITION), UINT_SIZE, 2];
-const POSE_ORIENTATION = [dataViewEnd(EPOCH_MS), FLOAT_SIZE, 16];
-const IMU_PARITY_BYTE = [dataViewEnd(POSE_ORIENTATION), UINT8_SIZE, 1];
-const DATA_VIEW_LENGTH = dataViewEnd(IMU_PARITY_BYTE);
+
+// version 5: packed, XOR parity over the epoch and pose orientation
+const V5_LOOK_AHEAD_CFG = [dataViewEnd(ENABLED), FLOAT_SIZE, 4];
+const V5_DISPLAY_RES = [dataViewEnd(V5_LOOK_AHEAD_CFG), UINT_SIZE, 2];
+const V5_DISPLAY_FOV = [dataViewEnd(V5_DISPLAY_RES), FLOAT_SIZE, 1];
+const V5_LENS_DISTANCE_RATIO = [dataViewEnd(V5_DISPLAY_FOV), FLOAT_SIZE, 1];
+const V5_SBS_ENABLED = [dataViewEnd(V5_LENS_DISTANCE_RATIO), BOOL_SIZE, 1];
+const V5_CUSTOM_BANNER_ENABLED = [dataViewEnd(V5_SBS_ENABLED), BOOL_SIZE, 1];
+const V5_SMOOTH_FOLLOW_ENABLED = [dataViewEnd(V5_CUSTOM_BANNER_ENABLED), BOOL_SIZE, 1];
+const V5_SMOOTH_FOLLOW_ORIGIN_DATA = [dataViewEnd(V5_SMOOTH_FOLLOW_ENABLED), FLOAT_SIZE, 16];
+const V5_POSE_POSITION = [dataViewEnd(V5_SMOOTH_FOLLOW_ORIGIN_DATA), FLOAT_SIZE, 3];
+const V5_EPOCH_MS = [dataViewEnd(V5_POSE_POSITION), UINT_SIZE, 2];
+const V5_POSE_ORIENTATION = [dataViewEnd(V5_EPOCH_MS), FLOAT_SIZE, 16];
+const V5_IMU_PARITY_BYTE = [dataViewEnd(V5_POSE_ORIENTATION), UINT8_SIZE, 1];
+const V5_DATA_VIEW_LENGTH = dataViewEnd(V5_IMU_PARITY_BYTE);
+
+// version 6: naturally aligned, pose and config in separate blocks that each start with a
+// sequence counter (odd while the driver writes) and a checksum over the rest of the block
+const V6_FLAGS = [dataViewEnd(ENABLED), UINT8_SIZE, 1];
+const V6_FLAG_MONOTONIC_TIME = 0x01;
+const V6_POSE_BLOCK = [64, UINT8_SIZE, 192];
+const V6_POSE_SEQUENCE = [64, UINT_SIZE, 1];
+const V6_POSE_CHECKSUM = [68, UINT_SIZE, 1];
+const V6_EPOCH_MS = [72, UINT_SIZE, 2];
+const V6_POSE_POSITION = [80, FLOAT_SIZE, 3];
+const V6_SMOOTH_FOLLOW_ENABLED = [92, BOOL_SIZE, 1];
+const V6_POSE_ORIENTATION = [96, FLOAT_SIZE, 16];
+const V6_SMOOTH_FOLLOW_ORIGIN_DATA = [160, FLOAT_SIZE, 16];
+const V6_SAMPLE_TIME_NS = [224, 2 * UINT_SIZE, 3];
+const V6_CONFIG_BLOCK = [256, UINT8_SIZE, 64];
+const V6_CONFIG_GENERATION = [256, UINT_SIZE, 1];
+const V6_CONFIG_CHECKSUM = [260, UINT_SIZE, 1];
+const V6_LOOK_AHEAD_CFG = [264, FLOAT_SIZE, 4];
+const V6_DISPLAY_RES = [280, UINT_SIZE, 2];
+const V6_DISPLAY_FOV = [288, FLOAT_SIZE, 1];
+const V6_LENS_DISTANCE_RATIO = [292, FLOAT_SIZE, 1];
+const V6_SBS_ENABLED = [296, BOOL_SIZE, 1];
+const V6_CUSTOM_BANNER_ENABLED = [297, BOOL_SIZE, 1];
+const V6_DATA_VIEW_LENGTH = dataViewEnd(V6_CONFIG_BLOCK);
 
 function checkParityByte(dataView) {
-    const parityByte = dataViewUint8(dataView, IMU_PARITY_BYTE);
+    const parityByte = dataViewUint8(dataView, V5_IMU_PARITY_BYTE);
     let parity = 0;
-    const epochUint8 = dataViewUint8Array(dataView, EPOCH_MS);
-    const imuDataUint8 = dataViewUint8Array(dataView, POSE_ORIENTATION);
+    const epochUint8 = dataViewUint8Array(dataView, V5_EPOCH_MS);
+    const imuDataUint8 = dataViewUint8Array(dataView, V5_POSE_ORIENTATION);
     for (let i = 0; i < epochUint8.length; i++) {
         parity ^= epochUint8[i];
     }
@@ -54,6 +83,87 @@ function checkParityByte(dataView) {
     return parityByte === parity;
 }
 
+// FNV-1a over little-endian 32-bit words, skipping the block's sequence and checksum words
+function blockChecksum(dataView, blockInfo) {
+    let hash = 2166136261;
+    for (let offset = blockInfo[0] + 2 * UINT_SIZE; offset < dataViewEnd(blockInfo); offset += UINT_SIZE) {
+        hash = Math.imul(hash ^ dataView.getUint32(offset, true), 16777619) >>> 0;
+    }
+    return hash;
+}
+
+function checkSeqlockBlock(dataView, blockInfo, sequenceInfo, checksumInfo) {
+    return (dataViewUint(dataView, sequenceInfo) & 1) === 0 &&
+           blockChecksum(dataView, blockInfo) === dataViewUint(dataView, checksumInfo);
+}
+
+const V5_LAYOUT = {
+    LOOK_AHEAD_CFG: V5_LOOK_AHEAD_CFG,
+    DISPLAY_RES: V5_DISPLAY_RES,
+    DISPLAY_FOV: V5_DISPLAY_FOV,
+    LENS_DISTANCE_RATIO: V5_LENS_DISTANCE_RATIO,
+    SBS_ENABLED: V5_SBS_ENABLED,
+    CUSTOM_BANNER_ENABLED: V5_CUSTOM_BANNER_ENABLED,
+    SMOOTH_FOLLOW_ENABLED: V5_SMOOTH_FOLLOW_ENABLED,
+    SMOOTH_FOLLOW_ORIGIN_DATA: V5_SMOOTH_FOLLOW_ORIGIN_DATA,
+    POSE_POSITION: V5_POSE_POSITION,
+    EPOCH_MS: V5_EPOCH_MS,
+    POSE_ORIENTATION: V5_POSE_ORIENTATION,
+    SAMPLE_TIME_NS: null,
+    checkIntegrity: checkParityByte
+};
+
+const V6_LAYOUT = {
+    LOOK_AHEAD_CFG: V6_LOOK_AHEAD_CFG,
+    DISPLAY_RES: V6_DISPLAY_RES,
+    DISPLAY_FOV: V6_DISPLAY_FOV,
+    LENS_DISTANCE_RATIO: V6_LENS_DISTANCE_RATIO,
+    SBS_ENABLED: V6_SBS_ENABLED,
+    CUSTOM_BANNER_ENABLED: V6_CUSTOM_BANNER_ENABLED,
+    SMOOTH_FOLLOW_ENABLED: V6_SMOOTH_FOLLOW_ENABLED,
+    SMOOTH_FOLLOW_ORIGIN_DATA: V6_SMOOTH_FOLLOW_ORIGIN_DATA,
+    POSE_POSITION: V6_POSE_POSITION,
+    EPOCH_MS: V6_EPOCH_MS,
+    POSE_ORIENTATION: V6_POSE_ORIENTATION,
+    SAMPLE_TIME_NS: V6_SAMPLE_TIME_NS,
+    checkIntegrity: (dataView) =>
+        checkSeqlockBlock(dataView, V6_POSE_BLOCK, V6_POSE_SEQUENCE, V6_POSE_CHECKSUM) &&
+        checkSeqlockBlock(dataView, V6_CONFIG_BLOCK, V6_CONFIG_GENERATION, V6_CONFIG_CHECKSUM)
+};
+
+// pick the layout matching the version byte and buffer length, or null if unsupported
+function dataViewLayout(dataView) {
+    if (dataView.byteLength === 0) return null;
+
+    const version = dataViewUint8(dataView, VERSION);
+    if (version === DATA_LAYOUT_VERSION_V6 && dataView.byteLength >= V6_DATA_VIEW_LENGTH) return V6_LAYOUT;
+
+    // unknown versions of the v5 length are still parsed so the version check can disable the effect
+    if (dataView.byteLength === V5_DATA_VIEW_LENGTH) return V5_LAYOUT;
+
+    return null;
+}
+
+// CLOCK_MONOTONIC nanosecond times of the t0..t2 pose samples, or null if the driver doesn't publish them
+function dataViewSampleTimesNs(dataView, layout) {
+    if (!layout.SAMPLE_TIME_NS || (dataViewUint8(dataView, V6_FLAGS) & V6_FLAG_MONOTONIC_TIME) === 0) return null;
+
+    const sampleTimesNs = dataViewBigUintArray(dataView, layout.SAMPLE_TIME_NS);
+    if (sampleTimesNs[2] === 0 || sampleTimesNs[0] < sampleTimesNs[1] || sampleTimesNs[1] < sampleTimesNs[2]) return null;
+
+    return sampleTimesNs;
+}
+
+// row 3 of the pose orientation only feeds sample deltas, so rebase it on t2 to keep sub-millisecond precision
+function rebasePoseSampleTimes(poseOrientation, sampleTimesNs) {
+    if (!sampleTimesNs) return poseOrientation;
+
+    for (let i = 0; i < 3; i++) {
+        poseOrientation[12 + i] = (sampleTimesNs[i] - sampleTimesNs[2]) / 1e6;
+    }
+    return poseOrientation;
+}
+
 const COUNTER_MAX = 300;
 function nextDebugIMUQuaternion(counter) {
     const angle = counter / COUNTER_MAX * 2 * Math.PI;
@@ -204,20 +314,23 @@ export const DeviceDataStream = GObject.registerClass({
             if (data_success) {
                 let buffer = new Uint8Array(data[1]).buffer;
                 let dataView = new DataView(buffer);
-                if (dataView.byteLength === DATA_VIEW_LENGTH) {
-                    let imuDateMs = dataViewBigUint(dataView, EPOCH_MS);
-                    const displayFov = dataViewFloat(dataView, DISPLAY_FOV);
+                let layout = dataViewLayout(dataView);
+                if (layout) {
+                    let imuDateMs = dataViewBigUint(dataView, layout.EPOCH_MS);
+                    const displayFov = dataViewFloat(dataView, layout.DISPLAY_FOV);
                     const validKeepAlive = isValidKeepAlive(toSec(imuDateMs));
                     const validData = validKeepAlive && displayFov !== 0.0;
                     const version = dataViewUint8(dataView, VERSION);
-                    const enabled = dataViewUint8(dataView, ENABLED) !== 0 && version === DATA_LAYOUT_VERSION && validData;
-                    let poseOrientation = dataViewFloatArray(dataView, POSE_ORIENTATION);
-                    let posePosition = dataViewFloatArray(dataView, POSE_POSITION);
-                    let smoothFollowEnabled = !this.legacy_follow_mode && dataViewUint8(dataView, SMOOTH_FOLLOW_ENABLED) !== 0;
-                    let smoothFollowOrigin = dataViewFloatArray(dataView, SMOOTH_FOLLOW_ORIGIN_DATA);
+                    const validVersion = version === DATA_LAYOUT_VERSION_V5 || version === DATA_LAYOUT_VERSION_V6;
+                    const enabled = dataViewUint8(dataView, ENABLED) !== 0 && validVersion && validData;
+                    let sampleTimesNs = dataViewSampleTimesNs(dataView, layout);
+                    let poseOrientation = rebasePoseSampleTimes(dataViewFloatArray(dataView, layout.POSE_ORIENTATION), sampleTimesNs);
+                    let posePosition = dataViewFloatArray(dataView, layout.POSE_POSITION);
+                    let smoothFollowEnabled = !this.legacy_follow_mode && dataViewUint8(dataView, layout.SMOOTH_FOLLOW_ENABLED) !== 0;
+                    let smoothFollowOrigin = dataViewFloatArray(dataView, layout.SMOOTH_FOLLOW_ORIGIN_DATA);
                     const imuResetState = enabled && validData && poseOrientation[0] === 0.0 && poseOrientation[1] === 0.0 && poseOrientation[2] === 0.0 && poseOrientation[3] === 1.0;
-                    const customBannerEnabled = dataViewUint8(dataView, CUSTOM_BANNER_ENABLED) !== 0;
-                    const sbsEnabled = dataViewUint8(dataView, SBS_ENABLED) !== 0;
+                    const customBannerEnabled = dataViewUint8(dataView, layout.CUSTOM_BANNER_ENABLED) !== 0;
+                    const sbsEnabled = dataViewUint8(dataView, layout.SBS_ENABLED) !== 0;
 
                     if (validKeepAlive && !validData) Globals.logger.log('[ERROR] Received invalid device data');
 
@@ -233,11 +346,11 @@ export const DeviceDataStream = GObject.registerClass({
                                 version,
                                 enabled,
                                 imuResetState,
-                                displayRes: dataViewUint32Array(dataView, DISPLAY_RES),
+                                displayRes: dataViewUint32Array(dataView, layout.DISPLAY_RES),
                                 sbsEnabled,
                                 displayFov,
-                                lookAheadCfg: dataViewFloatArray(dataView, LOOK_AHEAD_CFG),
-                                lensDistanceRatio: dataViewFloat(dataView, LENS_DISTANCE_RATIO)
+                                lookAheadCfg: dataViewFloatArray(dataView, layout.LOOK_AHEAD_CFG),
+                                lensDistanceRatio: dataViewFloat(dataView, layout.LENS_DISTANCE_RATIO)
                             };
                         } else if (keepalive_only) {
                             this.device_data = {
@@ -259,19 +372,20 @@ export const DeviceDataStream = GObject.registerClass({
 
                         let attempts = 0;
                         while (!success && attempts < 2) {
-                            if (dataView.byteLength === DATA_VIEW_LENGTH) {
-                                if (checkParityByte(dataView)) {
+                            if (layout) {
+                                if (layout.checkIntegrity(dataView)) {
                                     
                                     this.imu_snapshots = {
                                         pose_orientation: poseOrientation,
                                         pose_position: posePosition,
                                         timestamp_ms: imuDateMs,
+                                        sample_time_ns: sampleTimesNs?.[0] ?? null,
                                         smooth_follow_origin: smoothFollowOrigin
                                     };
                                     success = true;
                                 }
                             } else if (dataView.byteLength !== 0) {
-                                Globals.logger.log(`[ERROR] Invalid dataView.byteLength: ${dataView.byteLength} !== ${DATA_VIEW_LENGTH}`)
+                                Globals.logger.log(`[ERROR] Invalid dataView.byteLength: ${dataView.byteLength} for layout version ${dataViewUint8(dataView, VERSION)}`)
                             }
             
                             if (!success && ++attempts < 2) {
@@ -279,9 +393,12 @@ export const DeviceDataStream = GObject.registerClass({
                                 if (data[0]) {
                                     buffer = new Uint8Array(data[1]).buffer;
                                     dataView = new DataView(buffer);
-                                    imuDateMs = dataViewBigUint(dataView, EPOCH_MS);
-                                    poseOrientation = dataViewFloatArray(dataView, POSE_ORIENTATION);
-                                    posePosition = dataViewFloatArray(dataView, POSE_POSITION);
+                                    layout = dataViewLayout(dataView);
+                                    if (!layout) continue;
+                                    imuDateMs = dataViewBigUint(dataView, layout.EPOCH_MS);
+                                    sampleTimesNs = dataViewSampleTimesNs(dataView, layout);
+                                    poseOrientation = rebasePoseSampleTimes(dataViewFloatArray(dataView, layout.POSE_ORIENTATION), sampleTimesNs);
+                                    posePosition = dataViewFloatArray(dataView, layout.POSE_POSITION);
                                 }
                             }
                         }
@@ -327,6 +444,7 @@ export const DeviceDataStream = GObject.registerClass({
                     pose_orientation: poseOrientation,
                     pose_position: posePosition,
                     timestamp_ms: Date.now(),
+                    sample_time_ns: null,
                     smooth_follow_origin: [0.0, 0.0, 0.0, 1.0]
                 };
             }
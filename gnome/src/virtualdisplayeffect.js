@@ -19,9 +19,11 @@ function smoothFollowSlerpProgress(elapsedMs) {
 }
 
 // how far to look ahead is how old the IMU data is plus a constant that is either the default for this device or an override
-function lookAheadMS(imuDateMs, lookAheadCfg, override) {
-    // how stale the imu data is
-    const dataAge = Date.now() - imuDateMs;
+function lookAheadMS(imuSnapshots, lookAheadCfg, override) {
+    // how stale the imu data is, from the driver's monotonic sample time when available (immune to wall-clock steps)
+    const dataAge = imuSnapshots.sample_time_ns ?
+        Math.max(0, GLib.get_monotonic_time() / 1000 - imuSnapshots.sample_time_ns / 1e6) :
+        Date.now() - imuSnapshots.timestamp_ms;
 
     return (override === -1 ? lookAheadCfg[0] : override) + dataAge;
 }
@@ -579,7 +581,7 @@ export const VirtualDisplayEffect = GObject.registerClass({
                 this.set_uniform_float(this.get_uniform_location("u_pose_position"), 3, [0.0, 0.0, 0.0]);
             }
             if (!lookAheadSet) {
-                this.set_uniform_float(this.get_uniform_location('u_look_ahead_ms'), 1, [lookAheadMS(this.imu_snapshots.timestamp_ms, Globals.data_stream.device_data.lookAheadCfg, this.look_ahead_override)]);
+                this.set_uniform_float(this.get_uniform_location('u_look_ahead_ms'), 1, [lookAheadMS(this.imu_snapshots, Globals.data_stream.device_data.lookAheadCfg, this.look_ahead_override)]);
             }
 
             if (!this.disable_anti_aliasing) {
@@ -1,2 +1,25 @@
 add_test (NAME KWinEffectSupport COMMAND sh ${CMAKE_CURRENT_SOURCE_DIR}/tools/isSupported.sh)
 set_property (TEST KWinEffectSupport PROPERTY PASS_REGULAR_EXPRESSION "true")
+
+if (BREEZY_ALLOC_TRACE)
+    # a frame that stops allocating after warm-up passes, one that keeps allocating fails
+    add_test (NAME AllocTraceSteady COMMAND breezy_alloc_trace_test steady)
+    add_test (NAME AllocTraceAllocating COMMAND breezy_alloc_trace_test allocating)
+    set_tests_properties (AllocTraceSteady AllocTraceAllocating PROPERTIES
+        ENVIRONMENT "LD_PRELOAD=$<TARGET_FILE:breezy_alloc_trace>;BREEZY_ALLOC_TRACE_STRICT=1")
+    set_property (TEST AllocTraceAllocating PROPERTY WILL_FAIL TRUE)
+endif ()
+
+if (TARGET breezy_scene_benchmark)
+    # a short run of every display count on llvmpipe; skipped where no QRhi can be created
+    add_test (NAME SceneBenchmark COMMAND breezy_scene_benchmark --frames 30 --warmup 10)
+    set_tests_properties (SceneBenchmark PROPERTIES
+        ENVIRONMENT "QT_QPA_PLATFORM=offscreen;QSG_RHI_BACKEND=opengl;LIBGL_ALWAYS_SOFTWARE=1"
+        SKIP_RETURN_CODE 77)
+endif ()
+
+if (TARGET breezy_qml_tests)
+    # Qt Quick Test cases of the scene QML's logic, no rendering involved
+    add_test (NAME QmlTests COMMAND breezy_qml_tests -input ${CMAKE_CURRENT_SOURCE_DIR}/tests/qml)
+    set_tests_properties (QmlTests PROPERTIES ENVIRONMENT "QT_QPA_PLATFORM=offscreen")
+endif ()
@@ -1,4 +1,5 @@
 #include "core/output.h"
+#include "core/renderloop.h"
 #include "core/rendertarget.h"
 #include "core/renderviewport.h"
 #include "cursor.h"
@@ -6,10 +7,13 @@
 #include "kcm/shortcuts.h"
 #include "breezydesktopeffect.h"
 #include "breezydesktopconfig.h"
+#include "posesourcemonitor.h"
 #include "effect/effect.h"
 #include "effect/effecthandler.h"
 #include "opengl/glutils.h"
 #include "xrdriveripc.h"
+#include "breezy_shm_layout.h"
+#include "breezy_alloc_trace.h"
 
 #include <kwin/main.h>
 #include <core/outputbackend.h>
@@ -17,18 +21,23 @@
 #include <functional>
 #include <QAction>
 #include <QBuffer>
-#include <QFile>
-#include <QFileSystemWatcher>
 #include <QLoggingCategory>
 #include <QQuickItem>
 #include <QTimer>
 #include <QDBusConnection>
+#include <QDBusContext>
+#include <QDBusError>
 #include <QDateTime>
 
 #include <KGlobalAccel>
 #include <KLocalizedString>
 
 #include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 Q_LOGGING_CATEGORY(KWIN_XR, "kwin.xr")
 
@@ -36,7 +45,7 @@ Q_LOGGING_CATEGORY(KWIN_XR, "kwin.xr")
 // Service is provided by KWin (org.kde.KWin). We only register an object path.
 // Interface: com.xronlinux.BreezyDesktop, Path: /com/xronlinux/BreezyDesktop
 namespace {
-class BreezyDesktopDBusAdaptor : public QObject {
+class BreezyDesktopDBusAdaptor : public QObject, protected QDBusContext {
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "com.xronlinux.BreezyDesktop")
 public:
@@ -58,10 +67,60 @@ public Q_SLOTS:
         return m_effect->listVirtualDisplays();
     }
 
+    // refreshRate in Hz, 0 for the output's native rate; InvalidArgs for an unknown display
+    QVariantList SetVirtualDisplayRefreshRate(const QString &id, int refreshRate) {
+        if (!m_effect->setVirtualDisplayRefreshRate(id, refreshRate)) {
+            sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("No virtual display %1").arg(id));
+            return {};
+        }
+        return m_effect->listVirtualDisplays();
+    }
+
     bool CurvedDisplaySupported() {
         return m_effect->curvedDisplaySupported();
     }
 
+    // Live preview from the KCM while a slider is dragged; name is the kcfg entry, value is in
+    // its units. Coalesced to one update per frame, not persisted.
+    void PreviewSetting(const QString &name, int value) {
+        m_effect->previewSetting(name, value);
+    }
+
+    // time from the last activation to the 3D scene's first frame, -1 if it hasn't rendered yet
+    double ActivationToFirstFrameMs() const {
+        return m_effect->activationToFirstFrameMs();
+    }
+
+    // usedBytes, budgetBytes, downscaledDisplays, evictions
+    QVariantMap TextureMemory() const {
+        return m_effect->textureMemoryStats();
+    }
+
+    private:
+        KWin::BreezyDesktopEffect *m_effect;
+    };
+
+// Performance counters for monitoring, always collected (see PerformanceStats).
+// Interface: com.xronlinux.BreezyDesktop.Stats, Path: /com/xronlinux/BreezyDesktop/Stats
+class BreezyDesktopStatsDBusAdaptor : public QObject {
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.xronlinux.BreezyDesktop.Stats")
+public:
+    explicit BreezyDesktopStatsDBusAdaptor(KWin::BreezyDesktopEffect *effect)
+        : QObject(effect), m_effect(effect) {}
+
+public Q_SLOTS:
+    // frameTimeMs, gpuTimeMs, poseAgeAtPaintMs, poseIntervalMs (each count, mean, min, max,
+    // p50, p99), poseUpdateRateHz, poseUpdates, missedPoseUpdates, rejectedPoseReads,
+    // textureMemory, activationToFirstFrameMs, secondsSinceReset
+    QVariantMap Snapshot() const {
+        return m_effect->performanceStats();
+    }
+
+    void Reset() {
+        m_effect->resetPerformanceStats();
+    }
+
     private:
         KWin::BreezyDesktopEffect *m_effect;
     };
@@ -70,7 +129,8 @@ public Q_SLOTS:
 namespace DataView
 {
     const QString SHM_DIR = QStringLiteral("/dev/shm");
-    const QString SHM_PATH = SHM_DIR + QStringLiteral("/breezy_desktop_imu");
+    const QString SHM_FILE_NAME = QStringLiteral("breezy_desktop_imu");
+    constexpr char SHM_PATH[] = "/dev/shm/breezy_desktop_imu";
 
     // Helper constants and functions for shared memory buffer offsets
     constexpr int UINT8_SIZE = sizeof(uint8_t);
@@ -104,6 +164,53 @@ namespace DataView
     constexpr int POSE_ORIENTATION_DATA[3] = {dataViewEnd(POSE_DATE_MS), FLOAT_SIZE, 4 * POSE_ORIENTATION_ENTRIES};
     constexpr int POSE_PARITY_BYTE[3] = {dataViewEnd(POSE_ORIENTATION_DATA), UINT8_SIZE, 1};
     constexpr int LENGTH = dataViewEnd(POSE_PARITY_BYTE);
+
+    // Field offsets for one layout version; v5 is the packed layout above, v6 is aligned
+    // (see shared/ipc/breezy_shm_layout.h)
+    struct Offsets {
+        int lookAheadCfg;
+        int displayRes;
+        int displayFov;
+        int lensDistanceRatio;
+        int sbsEnabled;
+        int customBannerEnabled;
+        int smoothFollowEnabled;
+        int smoothFollowOrigin;
+        int posePosition;
+        int poseDateMs;
+        int poseOrientation;
+        int sampleTimeNs; // -1 if the layout has no monotonic sample times
+    };
+
+    constexpr Offsets V5_OFFSETS = {
+        LOOK_AHEAD_CFG[OFFSET_INDEX],
+        DISPLAY_RES[OFFSET_INDEX],
+        DISPLAY_FOV[OFFSET_INDEX],
+        LENS_DISTANCE_RATIO[OFFSET_INDEX],
+        SBS_ENABLED[OFFSET_INDEX],
+        CUSTOM_BANNER_ENABLED[OFFSET_INDEX],
+        SMOOTH_FOLLOW_ENABLED[OFFSET_INDEX],
+        SMOOTH_FOLLOW_ORIGIN_DATA[OFFSET_INDEX],
+        POSE_POSITION_DATA[OFFSET_INDEX],
+        POSE_DATE_MS[OFFSET_INDEX],
+        POSE_ORIENTATION_DATA[OFFSET_INDEX],
+        -1
+    };
+
+    constexpr Offsets V6_OFFSETS = {
+        BREEZY_SHM_V6_OFFSET_LOOK_AHEAD_CFG,
+        BREEZY_SHM_V6_OFFSET_DISPLAY_RES,
+        BREEZY_SHM_V6_OFFSET_DISPLAY_FOV,
+        BREEZY_SHM_V6_OFFSET_LENS_DISTANCE_RATIO,
+        BREEZY_SHM_V6_OFFSET_SBS_ENABLED,
+        BREEZY_SHM_V6_OFFSET_CUSTOM_BANNER_ENABLED,
+        BREEZY_SHM_V6_OFFSET_SMOOTH_FOLLOW_ENABLED,
+        BREEZY_SHM_V6_OFFSET_SMOOTH_FOLLOW_ORIGIN,
+        BREEZY_SHM_V6_OFFSET_POSE_POSITION,
+        BREEZY_SHM_V6_OFFSET_EPOCH_MS,
+        BREEZY_SHM_V6_OFFSET_POSE_ORIENTATION,
+        BREEZY_SHM_V6_OFFSET_SAMPLE_TIME_NS
+    };
 }
 
 namespace KWin
@@ -141,42 +248,35 @@ BreezyDesktopEffect::BreezyDesktopEffect()
     updateCursorImage();
     reconfigure(ReconfigureAll);
 
-    setSource(QUrl::fromLocalFile(QStandardPaths::locate(QStandardPaths::GenericDataLocation, QStringLiteral("kwin/effects/breezy_desktop/qml/main.qml"))));
-
-    // Monitor the IPC file for changes, even if it doesn't exist at startup
-    m_shmDirectoryWatcher = new QFileSystemWatcher(this);
-    m_shmDirectoryWatcher->addPath(DataView::SHM_DIR);
-
-    m_shmFileWatcher = new QFileSystemWatcher(this);
-
-    // Setup file watcher with recreation detection
-    auto setupFileWatcher = [this]() {
-        if (QFile::exists(DataView::SHM_PATH) && (
-            m_poseTimestamp == 0 || 
-            QDateTime::currentMSecsSinceEpoch() - m_poseTimestamp > 50 || // file may have been deleted and recreated
-            !m_shmFileWatcher->files().contains(DataView::SHM_PATH)
-        )) {
-            m_shmFileWatcher->removePath(DataView::SHM_PATH);
-            disconnect(m_shmFileWatcher, &QFileSystemWatcher::fileChanged, this, &BreezyDesktopEffect::updatePoseOrientation);
-            m_shmFileWatcher->addPath(DataView::SHM_PATH);
-            connect(m_shmFileWatcher, &QFileSystemWatcher::fileChanged, this, &BreezyDesktopEffect::updatePoseOrientation);
-        }
-    };
+    // compiled into the plugin, see breezy_desktop_qml in CMakeLists.txt
+    setSource(QUrl(QStringLiteral("qrc:/BreezyDesktopScene/main.qml")));
 
-    // Handle directory changes (file creation/recreation)
-    connect(m_shmDirectoryWatcher, &QFileSystemWatcher::directoryChanged, this, setupFileWatcher);
+    m_poseSnapshot.resize(std::max<qsizetype>(BREEZY_SHM_V6_LENGTH, DataView::LENGTH));
 
-    // Initial setup
-    setupFileWatcher();
+    // Monitor the IPC file for changes, even if it doesn't exist at startup. inotify runs on the
+    // monitor's thread; only events for the pose file itself are forwarded here.
+    m_poseSourceMonitor = new PoseSourceMonitor(DataView::SHM_DIR, DataView::SHM_FILE_NAME, this);
+    connect(m_poseSourceMonitor, &PoseSourceMonitor::poseDataChanged, this, [this]() {
+        m_poseSourceMonitor->acknowledgePoseData();
+        updatePoseOrientation();
+    }, Qt::QueuedConnection);
+    connect(m_poseSourceMonitor, &PoseSourceMonitor::poseSourceChanged, this, [](bool exists) {
+        qCDebug(KWIN_XR) << "\t\t\tBreezy - pose source" << (exists ? "(re)created" : "removed");
+    }, Qt::QueuedConnection);
+    m_poseSourceMonitor->start();
 
     m_watchdogTimer = new QTimer(this);
     m_watchdogTimer->setInterval(1000);
     connect(m_watchdogTimer, &QTimer::timeout, this, [this]() {
-        if (!m_enabled) return;
+        if (!m_enabled && !m_scenePrewarmed) return;
         this->updatePoseOrientation();
     });
     m_watchdogTimer->start();
 
+    m_previewTimer = new QTimer(this);
+    m_previewTimer->setSingleShot(true);
+    connect(m_previewTimer, &QTimer::timeout, this, &BreezyDesktopEffect::applyPreviewSettings);
+
     m_cursorUpdateTimer = new QTimer(this);
     connect(m_cursorUpdateTimer, &QTimer::timeout, this, &BreezyDesktopEffect::updateCursorPos);
     m_cursorUpdateTimer->setInterval(16); // ~60Hz
@@ -191,28 +291,37 @@ BreezyDesktopEffect::BreezyDesktopEffect()
     if (!dbusOk) {
         qCWarning(KWIN_XR) << "Failed to register DBus object /com/xronlinux/BreezyDesktop";
     }
+
+    auto *statsAdaptor = new BreezyDesktopStatsDBusAdaptor(this);
+    const bool statsDbusOk = QDBusConnection::sessionBus().registerObject(
+        QStringLiteral("/com/xronlinux/BreezyDesktop/Stats"),
+        statsAdaptor,
+        QDBusConnection::ExportAllSlots);
+    if (!statsDbusOk) {
+        qCWarning(KWIN_XR) << "Failed to register DBus object /com/xronlinux/BreezyDesktop/Stats";
+    }
 }
 
 BreezyDesktopEffect::~BreezyDesktopEffect()
 {
     qCCritical(KWIN_XR) << "\t\t\tBreezy - destructor";
-    if (m_shmFileWatcher) {
-        if (!DataView::SHM_PATH.isEmpty()) {
-            m_shmFileWatcher->removePath(DataView::SHM_PATH);
-        }
-        m_shmFileWatcher->deleteLater();
-        m_shmFileWatcher = nullptr;
-    }
-    if (m_shmDirectoryWatcher) {
-        m_shmDirectoryWatcher->deleteLater();
-        m_shmDirectoryWatcher = nullptr;
+    if (m_poseSourceMonitor) {
+        m_poseSourceMonitor->stop();
+        delete m_poseSourceMonitor;
+        m_poseSourceMonitor = nullptr;
     }
+    unmapPoseData();
     if (m_watchdogTimer) {
         m_watchdogTimer->stop();
         m_watchdogTimer->deleteLater();
         m_watchdogTimer = nullptr;
     }
     deactivate();
+
+    // the timer queries live in the compositor's context
+    if (effects->isOpenGLCompositing() && effects->makeOpenGLContextCurrent()) {
+        m_paintTimer.release();
+    }
 }
 
 void BreezyDesktopEffect::setupGlobalShortcut(const BreezyShortcuts::Shortcut &shortcut, std::function<void()> triggeredFunc) {
@@ -241,17 +350,16 @@ void BreezyDesktopEffect::reconfigure(ReconfigureFlags)
     BreezyDesktopConfig::self()->read();
     setLookAheadOverride(BreezyDesktopConfig::lookAheadOverride());
     setFocusedDisplayDistance(BreezyDesktopConfig::focusedDisplayDistance() / 100.0f);
+    if (m_previewedFocusedDistance) {
+        m_previewedFocusedDistance = false;
+        if (m_smoothFollowEnabled) updateDriverSmoothFollowSettings();
+    }
     setAllDisplaysDistance(BreezyDesktopConfig::allDisplaysDistance() / 100.0f);
     setDisplaySpacing(BreezyDesktopConfig::displaySpacing() / 1000.0f);
     setZoomOnFocusEnabled(BreezyDesktopConfig::zoomOnFocusEnabled());
     setSmoothFollowThreshold(BreezyDesktopConfig::smoothFollowThreshold());
 
-    qreal horiz = BreezyDesktopConfig::displayHorizontalOffset() / 100.0f;
-    qreal vert = BreezyDesktopConfig::displayVerticalOffset() / 100.0f;
-    bool offsetchanged = false;
-    if (!qFuzzyCompare(m_displayHorizontalOffset, horiz)) { m_displayHorizontalOffset = horiz; offsetchanged = true; }
-    if (!qFuzzyCompare(m_displayVerticalOffset, vert)) { m_displayVerticalOffset = vert; offsetchanged = true; }
-    if (offsetchanged) Q_EMIT displayOffsetChanged();
+    setDisplayOffset(BreezyDesktopConfig::displayHorizontalOffset() / 100.0f, BreezyDesktopConfig::displayVerticalOffset() / 100.0f);
 
     int wrap = BreezyDesktopConfig::displayWrappingScheme();
     int aaQuality = BreezyDesktopConfig::antialiasingQuality();
@@ -265,6 +373,9 @@ void BreezyDesktopEffect::reconfigure(ReconfigureFlags)
     bool curved = BreezyDesktopConfig::curvedDisplay() && m_curvedDisplaySupported;
     if (m_curvedDisplay != curved) { m_curvedDisplay = curved; Q_EMIT curvedDisplayChanged(); }
 
+    int textureBudget = BreezyDesktopConfig::textureMemoryBudget();
+    if (m_textureMemoryBudgetMB != textureBudget) { m_textureMemoryBudgetMB = textureBudget; Q_EMIT textureMemoryBudgetChanged(); }
+
     // this one doesn't have a signal, just always assign it
     m_allDisplaysFollowMode = BreezyDesktopConfig::allDisplaysFollowMode();
 }
@@ -297,8 +408,16 @@ void BreezyDesktopEffect::activate()
 {
     qCCritical(KWIN_XR) << "\t\t\tBreezy - activate";
 
+    m_activatedAt = std::chrono::steady_clock::now();
+    m_awaitingFirstFrame = true;
     if (!isRunning()) setRunning(true);
 
+    // a pre-warmed scene is already built; painting it is all that's left
+    if (m_scenePrewarmed) {
+        setScenePrewarmed(false);
+        effects->addRepaintFull();
+    }
+
     connect(effects, &EffectsHandler::cursorShapeChanged, this, &BreezyDesktopEffect::updateCursorImage);
     m_cursorUpdateTimer->start();
 
@@ -312,8 +431,54 @@ void BreezyDesktopEffect::deactivate()
 {
     qCCritical(KWIN_XR) << "\t\t\tBreezy - deactivate";
 
+    hideScene();
+    setScenePrewarmed(false);
+    setRunning(false);
+}
+
+bool BreezyDesktopEffect::isActive() const
+{
+    return QuickSceneEffect::isActive() && !m_scenePrewarmed;
+}
+
+void BreezyDesktopEffect::paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, Output *screen)
+{
+    // only the glasses' screen counts; virtual and mirrored screens paint on their own schedules
+    if (!m_enabled || effects->screens().indexOf(screen) != m_effectTargetScreenIndex) {
+        QuickSceneEffect::paintScreen(renderTarget, viewport, mask, region, screen);
+        return;
+    }
+
+    BreezyAllocScope allocScope("render_frame");
+    m_performanceStats.recordPaint(std::chrono::steady_clock::now(), poseAgeMs());
+
+    bool timed = false;
+    if (effects->isOpenGLCompositing()) {
+        const qreal gpuTimeMs = m_paintTimer.collect();
+        if (gpuTimeMs >= 0) m_performanceStats.recordGpuTime(gpuTimeMs);
+        timed = m_paintTimer.begin();
+    }
+    QuickSceneEffect::paintScreen(renderTarget, viewport, mask, region, screen);
+    if (timed) m_paintTimer.end();
+}
+
+bool BreezyDesktopEffect::scenePrewarmed() const {
+    return m_scenePrewarmed;
+}
+
+void BreezyDesktopEffect::setScenePrewarmed(bool prewarmed) {
+    if (m_scenePrewarmed == prewarmed) return;
+
+    m_scenePrewarmed = prewarmed;
+    Q_EMIT scenePrewarmedChanged();
+}
+
+// Stop presenting the scene: restore the cursor and drop the virtual displays
+void BreezyDesktopEffect::hideScene()
+{
     m_effectTargetScreenIndex = -1;
     invalidateEffectOnScreenGeometryCache();
+    m_performanceStats.interruptPaints();
 
     disconnect(effects, &EffectsHandler::cursorShapeChanged, this, &BreezyDesktopEffect::updateCursorImage);
     m_cursorUpdateTimer->stop();
@@ -326,9 +491,8 @@ void BreezyDesktopEffect::deactivate()
             }
         }
         m_virtualDisplays.clear();
+        Q_EMIT virtualDisplayRefreshRatesChanged();
     }
-
-    setRunning(false);
 }
 
 void BreezyDesktopEffect::enableDriver()
@@ -357,10 +521,33 @@ void BreezyDesktopEffect::disableDriver()
     XRDriverIPC::instance().writeConfig(newConfig);
 }
 
+// Refresh rates chosen in the KCM are kept per display id as "id=Hz", so a display re-created
+// under the same id (ids are reused lowest-first) or after a KWin restart gets its rate back
+static int storedVirtualDisplayRefreshRate(const QString &id) {
+    const QString prefix = id + QLatin1Char('=');
+    for (const QString &entry : BreezyDesktopConfig::virtualDisplayRefreshRates()) {
+        if (entry.startsWith(prefix)) return std::max(entry.mid(prefix.size()).toInt(), 0);
+    }
+    return 0;
+}
+
+static void storeVirtualDisplayRefreshRate(const QString &id, int refreshRate) {
+    const QString prefix = id + QLatin1Char('=');
+    QStringList entries = BreezyDesktopConfig::virtualDisplayRefreshRates();
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&prefix](const QString &entry) { return entry.startsWith(prefix); }),
+                  entries.end());
+    if (refreshRate > 0) entries.append(prefix + QString::number(refreshRate));
+    BreezyDesktopConfig::setVirtualDisplayRefreshRates(entries);
+    BreezyDesktopConfig::self()->save();
+}
+
 void BreezyDesktopEffect::addVirtualDisplay(QSize size)
 {
-    static int virtualDisplayCount = 0;
-    ++virtualDisplayCount;
+    int virtualDisplayCount = 1;
+    while (m_virtualDisplays.contains(QStringLiteral("BreezyDesktop_%1").arg(virtualDisplayCount))) {
+        ++virtualDisplayCount;
+    }
     QString name = QStringLiteral("BreezyDesktop_%1").arg(virtualDisplayCount);
     #if defined(KWIN_VERSION_ENCODED) && KWIN_VERSION_ENCODED >= 60290
         QString description = QStringLiteral("Breezy Display %1x%2 (%3)").arg(size.width()).arg(size.height()).arg(virtualDisplayCount);
@@ -373,7 +560,11 @@ void BreezyDesktopEffect::addVirtualDisplay(QSize size)
         info.output = output;
         info.id = name;
         info.size = size;
+        info.nativeRefreshRate = output->refreshRate();
+        info.refreshRate = storedVirtualDisplayRefreshRate(name);
+        applyVirtualDisplayRefreshRate(info);
         m_virtualDisplays.insert(info.id, info);
+        if (info.refreshRate > 0) Q_EMIT virtualDisplayRefreshRatesChanged();
     }
 }
 
@@ -387,11 +578,44 @@ QVariantList BreezyDesktopEffect::listVirtualDisplays() const {
         entry.insert(QStringLiteral("id"), info.id);
         entry.insert(QStringLiteral("width"), info.size.width());
         entry.insert(QStringLiteral("height"), info.size.height());
+        entry.insert(QStringLiteral("refreshRate"), info.refreshRate);
         list.push_back(entry);
     }
     return list;
 }
 
+QVariantMap BreezyDesktopEffect::virtualDisplayRefreshRates() const {
+    QVariantMap rates;
+    for (const auto &info : m_virtualDisplays) {
+        if (info.output && info.refreshRate > 0) rates.insert(info.output->name(), info.refreshRate);
+    }
+    return rates;
+}
+
+// A virtual output is only composited on damage, at most at its render loop's rate. Lowering
+// that rate caps the cost of a busy but unimportant display (video, terminal output), and the
+// scene resamples the display's desktop at the same rate (DesktopAtlas).
+bool BreezyDesktopEffect::setVirtualDisplayRefreshRate(const QString &id, int refreshRate) {
+    auto it = m_virtualDisplays.find(id);
+    if (it == m_virtualDisplays.end() || !it->output) return false;
+
+    refreshRate = std::max(refreshRate, 0);
+    if (it->refreshRate == refreshRate) return true;
+
+    it->refreshRate = refreshRate;
+    applyVirtualDisplayRefreshRate(*it);
+    storeVirtualDisplayRefreshRate(id, refreshRate);
+    Q_EMIT virtualDisplayRefreshRatesChanged();
+    return true;
+}
+
+void BreezyDesktopEffect::applyVirtualDisplayRefreshRate(const VirtualOutputInfo &info) {
+    const int refreshRateMhz = info.refreshRate > 0 ? std::min(info.refreshRate * 1000, info.nativeRefreshRate) : info.nativeRefreshRate;
+    if (RenderLoop *renderLoop = info.output->renderLoop()) {
+        renderLoop->setRefreshRate(refreshRateMhz);
+    }
+}
+
 bool BreezyDesktopEffect::removeVirtualDisplay(const QString &id) {
     auto it = m_virtualDisplays.find(id);
     if (it != m_virtualDisplays.end()) {
@@ -399,7 +623,9 @@ bool BreezyDesktopEffect::removeVirtualDisplay(const QString &id) {
         if (output) {
             KWin::kwinApp()->outputBackend()->removeVirtualOutput(output);
         }
+        const bool hadRefreshRate = it->refreshRate > 0;
         m_virtualDisplays.erase(it);
+        if (hadRefreshRate) Q_EMIT virtualDisplayRefreshRatesChanged();
         return true;
     }
     return false;
@@ -452,7 +678,7 @@ QVector3D BreezyDesktopEffect::posePosition() const {
     return m_posePosition;
 }
 
-quint32 BreezyDesktopEffect::poseTimeElapsedMs() const {
+qreal BreezyDesktopEffect::poseTimeElapsedMs() const {
     return m_poseTimeElapsedMs;
 }
 
@@ -460,6 +686,17 @@ quint64 BreezyDesktopEffect::poseTimestamp() const {
     return m_poseTimestamp;
 }
 
+qreal BreezyDesktopEffect::poseAgeMs() const {
+    if (m_poseSampleTimeNs != 0) {
+        const qint64 nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return std::max<qreal>(0.0, static_cast<qreal>(nowNs - static_cast<qint64>(m_poseSampleTimeNs)) / 1e6);
+    }
+
+    // old drivers: millisecond wall-clock epoch
+    return static_cast<qreal>(QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(m_poseTimestamp));
+}
+
 QList<qreal> BreezyDesktopEffect::lookAheadConfig() const {
     return m_lookAheadConfig;
 }
@@ -483,12 +720,12 @@ qreal BreezyDesktopEffect::focusedDisplayDistance() const {
     return m_focusedDisplayDistance;
 }
 
-void BreezyDesktopEffect::setFocusedDisplayDistance(qreal distance) {
+void BreezyDesktopEffect::setFocusedDisplayDistance(qreal distance, bool updateDriver) {
     if (distance != m_focusedDisplayDistance) {
         m_focusedDisplayDistance = std::clamp(distance, 0.2, m_allDisplaysDistance);
         Q_EMIT focusedDisplayDistanceChanged();
 
-        if (m_smoothFollowEnabled) updateDriverSmoothFollowSettings();
+        if (updateDriver && m_smoothFollowEnabled) updateDriverSmoothFollowSettings();
     }
 }
 
@@ -515,6 +752,51 @@ void BreezyDesktopEffect::setDisplaySpacing(qreal spacing) {
     }
 }
 
+void BreezyDesktopEffect::setDisplayOffset(qreal horizontal, qreal vertical) {
+    bool offsetchanged = false;
+    if (!qFuzzyCompare(m_displayHorizontalOffset, horizontal)) { m_displayHorizontalOffset = horizontal; offsetchanged = true; }
+    if (!qFuzzyCompare(m_displayVerticalOffset, vertical)) { m_displayVerticalOffset = vertical; offsetchanged = true; }
+    if (offsetchanged) Q_EMIT displayOffsetChanged();
+}
+
+void BreezyDesktopEffect::previewSetting(const QString &name, int value) {
+    m_pendingPreview.insert(name, value);
+    if (m_previewTimer->isActive()) return;
+
+    // one frame of the glasses' output, so a drag updates the scene at most once per frame
+    int refreshRateMhz = 60000;
+    const QList<Output *> screens = effects->screens();
+    if (m_effectTargetScreenIndex >= 0 && m_effectTargetScreenIndex < screens.size()) {
+        refreshRateMhz = std::max(screens[m_effectTargetScreenIndex]->refreshRate(), 1000);
+    }
+    m_previewTimer->start(std::max(1, 1000000 / refreshRateMhz));
+}
+
+void BreezyDesktopEffect::applyPreviewSettings() {
+    for (auto it = m_pendingPreview.cbegin(); it != m_pendingPreview.cend(); ++it) {
+        const QString &name = it.key();
+        const int value = it.value();
+        if (name == QLatin1String("FocusedDisplayDistance")) {
+            // the driver's smooth follow settings are updated once the KCM saves
+            setFocusedDisplayDistance(value / 100.0f, false);
+            m_previewedFocusedDistance = true;
+        } else if (name == QLatin1String("AllDisplaysDistance")) {
+            setAllDisplaysDistance(value / 100.0f);
+        } else if (name == QLatin1String("DisplaySpacing")) {
+            setDisplaySpacing(value / 1000.0f);
+        } else if (name == QLatin1String("DisplayHorizontalOffset")) {
+            setDisplayOffset(value / 100.0f, m_displayVerticalOffset);
+        } else if (name == QLatin1String("DisplayVerticalOffset")) {
+            setDisplayOffset(m_displayHorizontalOffset, value / 100.0f);
+        } else if (name == QLatin1String("LookAheadOverride")) {
+            setLookAheadOverride(value);
+        } else {
+            qCWarning(KWIN_XR) << "Breezy - no live preview for setting" << name;
+        }
+    }
+    m_pendingPreview.clear();
+}
+
 qreal BreezyDesktopEffect::displayHorizontalOffset() const {
     return m_displayHorizontalOffset;
 }
@@ -576,6 +858,55 @@ void BreezyDesktopEffect::setCurvedDisplaySupported(bool supported) {
     }
 }
 
+int BreezyDesktopEffect::textureMemoryBudgetMB() const {
+    return m_textureMemoryBudgetMB;
+}
+
+QVariantMap BreezyDesktopEffect::textureMemoryStats() const {
+    return QVariantMap{
+        {QStringLiteral("usedBytes"), m_textureMemoryBytes},
+        {QStringLiteral("budgetBytes"), qint64(m_textureMemoryBudgetMB) * 1024 * 1024},
+        {QStringLiteral("downscaledDisplays"), m_downscaledDisplays},
+        {QStringLiteral("evictions"), m_textureEvictions}
+    };
+}
+
+void BreezyDesktopEffect::reportTextureMemory(qint64 usedBytes, int downscaledDisplays) {
+    m_textureMemoryBytes = usedBytes;
+    m_downscaledDisplays = downscaledDisplays;
+}
+
+void BreezyDesktopEffect::reportSceneFirstFrame() {
+    if (!m_awaitingFirstFrame) return;
+
+    m_awaitingFirstFrame = false;
+    m_activationToFirstFrameMs = std::chrono::duration<qreal, std::milli>(std::chrono::steady_clock::now() - m_activatedAt).count();
+    qCInfo(KWIN_XR) << "\t\t\tBreezy - activation to first frame:" << m_activationToFirstFrameMs << "ms";
+}
+
+qreal BreezyDesktopEffect::activationToFirstFrameMs() const {
+    return m_activationToFirstFrameMs;
+}
+
+QVariantMap BreezyDesktopEffect::performanceStats() const {
+    QVariantMap stats = m_performanceStats.snapshot();
+    stats.insert(QStringLiteral("textureMemory"), textureMemoryStats());
+    stats.insert(QStringLiteral("activationToFirstFrameMs"), m_activationToFirstFrameMs);
+    return stats;
+}
+
+void BreezyDesktopEffect::resetPerformanceStats() {
+    m_performanceStats.reset();
+    m_textureEvictions = 0;
+    qCInfo(KWIN_XR) << "\t\t\tBreezy - performance stats reset";
+}
+
+void BreezyDesktopEffect::recordTextureEvictions(int displays) {
+    m_textureEvictions += displays;
+    qCDebug(KWIN_XR) << "\t\t\tBreezy - downscaled" << displays << "display texture(s) to fit"
+                     << m_textureMemoryBudgetMB << "MB, atlas now" << m_textureMemoryBytes / (1024 * 1024) << "MB";
+}
+
 QList<QQuaternion> BreezyDesktopEffect::smoothFollowOrigin() const {
     return m_smoothFollowOrigin;
 }
@@ -602,6 +933,79 @@ bool BreezyDesktopEffect::checkParityByte(const char* data) {
     return parityByte == parity;
 }
 
+// v6 blocks: sequence counter must be even (no write in progress) and the checksum must
+// match the copy we read, otherwise the read raced the driver and is dropped
+static bool checkSeqlockBlock(const char* data, size_t blockStart, size_t blockEnd) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    uint32_t sequence;
+    uint32_t checksum;
+    memcpy(&sequence, bytes + blockStart, sizeof(sequence));
+    memcpy(&checksum, bytes + blockStart + 4, sizeof(checksum));
+    if (qFromLittleEndian(sequence) & 1) return false;
+
+    return breezy_shm_checksum(bytes, blockStart + 8, blockEnd) == qFromLittleEndian(checksum);
+}
+
+bool BreezyDesktopEffect::checkBlockChecksums(const char* data) {
+    return checkSeqlockBlock(data, BREEZY_SHM_V6_POSE_BLOCK, BREEZY_SHM_V6_POSE_BLOCK_END) &&
+           checkSeqlockBlock(data, BREEZY_SHM_V6_CONFIG_BLOCK, BREEZY_SHM_V6_CONFIG_BLOCK_END);
+}
+
+// Maps the driver's pose file, returning its size or 0 if there's none. One stat per call:
+// the driver replacing the file (new inode) or a different layout (new size) remaps.
+qsizetype BreezyDesktopEffect::mapPoseData() {
+    struct stat fileStat;
+    if (stat(DataView::SHM_PATH, &fileStat) != 0 || fileStat.st_size <= 0) {
+        unmapPoseData();
+        return 0;
+    }
+    if (m_poseMapping && static_cast<quint64>(fileStat.st_ino) == m_poseMappingInode &&
+        fileStat.st_size == m_poseMappingSize) {
+        return m_poseMappingSize;
+    }
+
+    unmapPoseData();
+    const int fd = open(DataView::SHM_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    void *mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return 0;
+
+    m_poseMapping = static_cast<const char *>(mapping);
+    m_poseMappingSize = fileStat.st_size;
+    m_poseMappingInode = fileStat.st_ino;
+    return m_poseMappingSize;
+}
+
+void BreezyDesktopEffect::unmapPoseData() {
+    if (!m_poseMapping) return;
+
+    munmap(const_cast<char *>(m_poseMapping), m_poseMappingSize);
+    m_poseMapping = nullptr;
+    m_poseMappingSize = 0;
+    m_poseMappingInode = 0;
+}
+
+// Overwrites the list in place and reports whether it changed; an unchanged value neither
+// detaches a list QML holds a copy of nor needs a notification
+template<typename T, typename V>
+static bool assignInPlace(QList<T> &list, const V *values, qsizetype count) {
+    bool changed = list.size() != count;
+    if (changed) list.resize(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        const T value = static_cast<T>(values[i]);
+        if (list.at(i) != value) {
+            list[i] = value;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
 static qint64 lastConfigUpdate = 0;
 static qint64 activatedAt = 0;
 void BreezyDesktopEffect::updatePoseOrientation() {    
@@ -613,57 +1017,73 @@ void BreezyDesktopEffect::updatePoseOrientation() {
 
     // destructor called on function exit, triggers reset of the flag
     struct ResetFlag { std::atomic<bool>* f; ~ResetFlag(){ f->store(false); } } reset{&m_poseUpdateInProgress};
+    BreezyAllocScope allocScope("pose_update");
 
-    const QString shmPath = QStringLiteral("/dev/shm/breezy_desktop_imu");
-    QFile shmFile(shmPath);
-    if (!shmFile.open(QIODevice::ReadOnly)) {
+    const qsizetype size = mapPoseData();
+    if (size == 0) {
+        // the driver is gone, don't hold a pre-warmed scene for it
+        if (m_scenePrewarmed) deactivate();
         return;
     }
-    QByteArray buffer = shmFile.readAll();
-    shmFile.close();
-    if (buffer.size() != DataView::LENGTH) return;
-
-    const char* data = buffer.constData();
-    if (!checkParityByte(data)) return;
 
+    // the checks and reads below all use this one copy, so a read that raced a driver write is rejected whole
+    char* data = m_poseSnapshot.data();
+    memcpy(data, m_poseMapping, std::min(size, m_poseSnapshot.size()));
     uint8_t version = static_cast<uint8_t>(data[DataView::VERSION[DataView::OFFSET_INDEX]]);
+    const DataView::Offsets* offsets = nullptr;
+    if (version == BREEZY_SHM_V6_VERSION && size >= BREEZY_SHM_V6_LENGTH) {
+        if (!checkBlockChecksums(data)) {
+            m_performanceStats.recordRejectedPoseRead();
+            return;
+        }
+        offsets = &DataView::V6_OFFSETS;
+    } else if (size == DataView::LENGTH) {
+        if (!checkParityByte(data)) {
+            m_performanceStats.recordRejectedPoseRead();
+            return;
+        }
+        offsets = &DataView::V5_OFFSETS;
+    } else {
+        return;
+    }
+
     uint8_t enabledFlag = static_cast<uint8_t>(data[DataView::ENABLED[DataView::OFFSET_INDEX]]);
     uint64_t poseDateMs;
-    memcpy(&poseDateMs, data + DataView::POSE_DATE_MS[DataView::OFFSET_INDEX], sizeof(poseDateMs));
+    memcpy(&poseDateMs, data + offsets->poseDateMs, sizeof(poseDateMs));
     poseDateMs = qFromLittleEndian(poseDateMs);
 
     const qint64 currentTimeMs = QDateTime::currentMSecsSinceEpoch();
     const bool updateConfig = lastConfigUpdate == 0 || currentTimeMs - lastConfigUpdate > 1000;
 
+    // only notify when something changed, QML re-reads every device property on it
+    bool configChanged = lastConfigUpdate == 0;
     if (updateConfig) {
         float lookAheadConfig[4];
-        memcpy(&lookAheadConfig[0], data + DataView::LOOK_AHEAD_CFG[DataView::OFFSET_INDEX], sizeof(lookAheadConfig));
-        m_lookAheadConfig.clear();
-        m_lookAheadConfig.append(lookAheadConfig[0]);
-        m_lookAheadConfig.append(lookAheadConfig[1]);
-        m_lookAheadConfig.append(lookAheadConfig[2]);
-        m_lookAheadConfig.append(lookAheadConfig[3]);
+        memcpy(&lookAheadConfig[0], data + offsets->lookAheadCfg, sizeof(lookAheadConfig));
+        configChanged |= assignInPlace(m_lookAheadConfig, lookAheadConfig, 4);
 
         uint32_t displayResolution[2];
-        memcpy(&displayResolution[0], data + DataView::DISPLAY_RES[DataView::OFFSET_INDEX], sizeof(displayResolution));
-        m_displayResolution.clear();
-        m_displayResolution.append(displayResolution[0]);
-        m_displayResolution.append(displayResolution[1]);
+        memcpy(&displayResolution[0], data + offsets->displayRes, sizeof(displayResolution));
+        configChanged |= assignInPlace(m_displayResolution, displayResolution, 2);
 
         float displayFov = 0.0f;
-        memcpy(&displayFov, data + DataView::DISPLAY_FOV[DataView::OFFSET_INDEX], sizeof(displayFov));
+        memcpy(&displayFov, data + offsets->displayFov, sizeof(displayFov));
+        configChanged |= m_diagonalFOV != displayFov;
         m_diagonalFOV = displayFov;
 
         float lensDistanceRatio = 0.0f;
-        memcpy(&lensDistanceRatio, data + DataView::LENS_DISTANCE_RATIO[DataView::OFFSET_INDEX], sizeof(lensDistanceRatio));
+        memcpy(&lensDistanceRatio, data + offsets->lensDistanceRatio, sizeof(lensDistanceRatio));
+        configChanged |= m_lensDistanceRatio != lensDistanceRatio;
         m_lensDistanceRatio = lensDistanceRatio;
 
         uint8_t sbsEnabled = false;
-        memcpy(&sbsEnabled, data + DataView::SBS_ENABLED[DataView::OFFSET_INDEX], sizeof(sbsEnabled));
+        memcpy(&sbsEnabled, data + offsets->sbsEnabled, sizeof(sbsEnabled));
+        configChanged |= m_sbsEnabled != (sbsEnabled != 0);
         m_sbsEnabled = (sbsEnabled != 0);
 
         uint8_t customBannerEnabled = false;
-        memcpy(&customBannerEnabled, data + DataView::CUSTOM_BANNER_ENABLED[DataView::OFFSET_INDEX], sizeof(customBannerEnabled));
+        memcpy(&customBannerEnabled, data + offsets->customBannerEnabled, sizeof(customBannerEnabled));
+        configChanged |= m_customBannerEnabled != (customBannerEnabled != 0);
         m_customBannerEnabled = (customBannerEnabled != 0);
         
         lastConfigUpdate = currentTimeMs;
@@ -671,11 +1091,13 @@ void BreezyDesktopEffect::updatePoseOrientation() {
 
     const bool validKeepAlive = (currentTimeMs - poseDateMs) < 5000;
     const bool validData = validKeepAlive && m_diagonalFOV != 0.0f;
-    const uint8_t expectedVersion = 5;
     bool enabledFlagSet = (enabledFlag != 0);
-    bool validVersion = (version == expectedVersion);
+    bool validVersion = (version == BREEZY_SHM_V5_VERSION || version == BREEZY_SHM_V6_VERSION);
     const bool wasEnabled = m_enabled;
     const bool enabled = enabledFlagSet && validVersion && validData;
+
+    // driver running and glasses connected, but the effect is disabled
+    const bool prewarm = BreezyDesktopConfig::prewarmScene() && !enabledFlagSet && validVersion && validData;
     if (!enabled) {
         // give a grace period after enabling the effect
         if (wasEnabled && (currentTimeMs - activatedAt > 1000)) {
@@ -684,33 +1106,53 @@ void BreezyDesktopEffect::updatePoseOrientation() {
                                 << "enabledFlag:" << enabledFlag
                                 << "version:" << version
                                 << "diagonalFOV:" << m_diagonalFOV;
-            deactivate();
+            if (prewarm) {
+                // keep the scene built for the next enable
+                hideScene();
+                setScenePrewarmed(true);
+                effects->addRepaintFull();
+            } else {
+                deactivate();
+            }
             m_enabled = false;
             Q_EMIT enabledStateChanged();
             return;
         }
+
+        if (!wasEnabled && prewarm && !isRunning()) {
+            qCInfo(KWIN_XR) << "\t\t\tBreezy - pre-warming scene";
+            setScenePrewarmed(true);
+            setRunning(true);
+            effects->ungrabKeyboard();
+            effects->stopMouseInterception(this);
+        } else if (!wasEnabled && !prewarm && m_scenePrewarmed) {
+            qCInfo(KWIN_XR) << "\t\t\tBreezy - releasing pre-warmed scene";
+            deactivate();
+        }
     } else if (!wasEnabled) {
         qCCritical(KWIN_XR) << "\t\t\tBreezy - enabling effect; currentTimeMs:" << currentTimeMs
                                 << "poseDateMs:" << poseDateMs
                                 << "enabledFlag:" << enabledFlag
                                 << "version:" << version
                                 << "diagonalFOV:" << m_diagonalFOV;
-        activate();
+        // enabled before activate() clears scenePrewarmed, so the scene never looks unwanted
+        // in between and a pre-warmed one is kept rather than unloaded and rebuilt
         m_enabled = true;
         Q_EMIT enabledStateChanged();
+        activate();
         activatedAt = currentTimeMs;
     }
     
-    if (updateConfig) Q_EMIT devicePropertiesChanged();
+    if (updateConfig && configChanged) Q_EMIT devicePropertiesChanged();
 
     float posePositionData[3];
-    memcpy(posePositionData, data + DataView::POSE_POSITION_DATA[DataView::OFFSET_INDEX], sizeof(posePositionData));
+    memcpy(posePositionData, data + offsets->posePosition, sizeof(posePositionData));
 
     // convert NWU to EUS by passing position values: -y, z, -x
     m_posePosition = QVector3D(-posePositionData[1], posePositionData[2], -posePositionData[0]);
 
     float poseOrientationData[4 * DataView::POSE_ORIENTATION_ENTRIES]; // 4 quaternion-sized rows
-    memcpy(poseOrientationData, data + DataView::POSE_ORIENTATION_DATA[DataView::OFFSET_INDEX], sizeof(poseOrientationData));
+    memcpy(poseOrientationData, data + offsets->poseOrientation, sizeof(poseOrientationData));
     bool wasPoseResetState = m_poseResetState;
     m_poseResetState = (poseOrientationData[0] == 0.0f && poseOrientationData[1] == 0.0f && poseOrientationData[2] == 0.0f && poseOrientationData[3] == 1.0f);
     if (m_poseResetState != wasPoseResetState) {
@@ -730,18 +1172,35 @@ void BreezyDesktopEffect::updatePoseOrientation() {
     orientationDataOffset += DataView::POSE_ORIENTATION_ENTRIES;
 
     // set poseOrientations to the last two rotations, leave out the elapsed time
-    m_poseOrientations.clear();
-    m_poseOrientations.append(quatT0);
-    m_poseOrientations.append(quatT1);
+    const QQuaternion poseOrientations[2] = {quatT0, quatT1};
+    assignInPlace(m_poseOrientations, poseOrientations, 2);
 
     // 4th row isn't actually a quaternion, it contains the timestamps for each of the 3 quaternions
     // elapsed time between T0 and T1 is: poseOrientationData[0] - poseOrientationData[1]
-    m_poseTimeElapsedMs = static_cast<quint32>(poseOrientationData[orientationDataOffset + 0] - poseOrientationData[orientationDataOffset + 1]);
+    m_poseTimeElapsedMs = poseOrientationData[orientationDataOffset + 0] - poseOrientationData[orientationDataOffset + 1];
 
     m_poseTimestamp = poseDateMs;
+
+    // prefer the driver's monotonic sample times: nanosecond deltas and an age that survives wall-clock steps
+    m_poseSampleTimeNs = 0;
+    const uint8_t flags = static_cast<uint8_t>(data[BREEZY_SHM_V6_OFFSET_FLAGS]);
+    if (offsets->sampleTimeNs >= 0 && (flags & BREEZY_SHM_V6_FLAG_MONOTONIC_TIME)) {
+        uint64_t sampleTimeNs[2];
+        memcpy(sampleTimeNs, data + offsets->sampleTimeNs, sizeof(sampleTimeNs));
+        const uint64_t t0 = qFromLittleEndian(sampleTimeNs[0]);
+        const uint64_t t1 = qFromLittleEndian(sampleTimeNs[1]);
+        if (t1 != 0 && t0 >= t1) {
+            m_poseTimeElapsedMs = static_cast<qreal>(t0 - t1) / 1e6;
+            m_poseSampleTimeNs = t0;
+        }
+    }
+    if (m_enabled) {
+        const qreal sampleTimeMs = m_poseSampleTimeNs != 0 ? static_cast<qreal>(m_poseSampleTimeNs) / 1e6 : static_cast<qreal>(m_poseTimestamp);
+        m_performanceStats.recordPose(sampleTimeMs, m_poseTimeElapsedMs);
+    }
     
     float originData[4 * DataView::POSE_ORIENTATION_ENTRIES]; // 4 quaternion-sized rows
-    memcpy(originData, data + DataView::SMOOTH_FOLLOW_ORIGIN_DATA[DataView::OFFSET_INDEX], sizeof(originData));
+    memcpy(originData, data + offsets->smoothFollowOrigin, sizeof(originData));
 
     // convert NWU to EUS by passing root.rotation values: -y, z, -x
     QQuaternion sfQuatT0(originData[3], -originData[1], originData[2], -originData[0]);
@@ -755,12 +1214,11 @@ void BreezyDesktopEffect::updatePoseOrientation() {
     originDataOffset += DataView::POSE_ORIENTATION_ENTRIES;
 
     // set smoothFollowOrigin to the last two rotations, leave out the elapsed time
-    m_smoothFollowOrigin.clear();
-    m_smoothFollowOrigin.append(sfQuatT0);
-    m_smoothFollowOrigin.append(sfQuatT1);
+    const QQuaternion smoothFollowOrigin[2] = {sfQuatT0, sfQuatT1};
+    assignInPlace(m_smoothFollowOrigin, smoothFollowOrigin, 2);
 
     uint8_t smoothFollowEnabled = false;
-    memcpy(&smoothFollowEnabled, data + DataView::SMOOTH_FOLLOW_ENABLED[DataView::OFFSET_INDEX], sizeof(smoothFollowEnabled));
+    memcpy(&smoothFollowEnabled, data + offsets->smoothFollowEnabled, sizeof(smoothFollowEnabled));
     bool nextSmoothFollowEnabled = (smoothFollowEnabled != 0);
     bool focusedSmoothFollowEnabled = nextSmoothFollowEnabled && !m_allDisplaysFollowMode;
     if (m_smoothFollowEnabled != nextSmoothFollowEnabled || m_focusedSmoothFollowEnabled != focusedSmoothFollowEnabled) {
@@ -1,10 +1,11 @@
 #pragma once
 
 #include "kcm/shortcuts.h"
+#include "performancestats.h"
 #include <effect/quickeffect.h>
 
 #include <QAction>
-#include <QFileSystemWatcher>
+#include <QByteArray>
 #include <QImage>
 #include <QKeySequence>
 #include <QQuaternion>
@@ -13,10 +14,13 @@
 #include <QHash>
 #include <QRect>
 #include <atomic>
+#include <chrono>
 class QTimer;
 
 namespace KWin
 {
+    class PoseSourceMonitor;
+
     class BreezyDesktopEffect : public QuickSceneEffect
     {
         Q_OBJECT
@@ -27,8 +31,9 @@ namespace KWin
         Q_PROPERTY(bool poseResetState READ poseResetState NOTIFY poseResetStateChanged)
         Q_PROPERTY(QList<QQuaternion> poseOrientations READ poseOrientations)
         Q_PROPERTY(QVector3D posePosition READ posePosition)
-        Q_PROPERTY(quint32 poseTimeElapsedMs READ poseTimeElapsedMs)
+        Q_PROPERTY(qreal poseTimeElapsedMs READ poseTimeElapsedMs)
         Q_PROPERTY(quint64 poseTimestamp READ poseTimestamp)
+        Q_PROPERTY(qreal poseAgeMs READ poseAgeMs)
         Q_PROPERTY(QString cursorImageSource READ cursorImageSource NOTIFY cursorImageSourceChanged)
         Q_PROPERTY(QSize cursorImageSize READ cursorImageSize NOTIFY cursorImageSourceChanged)
         Q_PROPERTY(QPointF cursorPos READ cursorPos NOTIFY cursorPosChanged)
@@ -52,6 +57,9 @@ namespace KWin
         Q_PROPERTY(bool mirrorPhysicalDisplays READ mirrorPhysicalDisplays NOTIFY mirrorPhysicalDisplaysChanged)
         Q_PROPERTY(bool curvedDisplay READ curvedDisplay NOTIFY curvedDisplayChanged)
         Q_PROPERTY(bool curvedDisplaySupported READ curvedDisplaySupported WRITE setCurvedDisplaySupported NOTIFY curvedDisplaySupportedChanged)
+        Q_PROPERTY(int textureMemoryBudgetMB READ textureMemoryBudgetMB NOTIFY textureMemoryBudgetChanged)
+        Q_PROPERTY(bool scenePrewarmed READ scenePrewarmed NOTIFY scenePrewarmedChanged)
+        Q_PROPERTY(QVariantMap virtualDisplayRefreshRates READ virtualDisplayRefreshRates NOTIFY virtualDisplayRefreshRatesChanged)
 
 
     public:
@@ -60,6 +68,8 @@ namespace KWin
         ~BreezyDesktopEffect() override;
 
         void reconfigure(ReconfigureFlags) override;
+        bool isActive() const override;
+        void paintScreen(const RenderTarget &renderTarget, const RenderViewport &viewport, int mask, const QRegion &region, Output *screen) override;
 
         int requestedEffectChainPosition() const override;
 
@@ -76,21 +86,23 @@ namespace KWin
         void setLookingAtScreenIndex(int index);
         QList<QQuaternion> poseOrientations() const;
         QVector3D posePosition() const;
-        quint32 poseTimeElapsedMs() const;
+        qreal poseTimeElapsedMs() const;
         quint64 poseTimestamp() const;
+        qreal poseAgeMs() const;
         bool poseResetState() const;
         QList<qreal> lookAheadConfig() const;
         qreal lookAheadOverride() const;
         void setLookAheadOverride(qreal override);
         QList<quint32> displayResolution() const;
         qreal focusedDisplayDistance() const;
-        void setFocusedDisplayDistance(qreal distance);
+        void setFocusedDisplayDistance(qreal distance, bool updateDriver = true);
         qreal allDisplaysDistance() const;
         void setAllDisplaysDistance(qreal distance);
         qreal displaySpacing() const;
         void setDisplaySpacing(qreal spacing);
         qreal displayHorizontalOffset() const;
         qreal displayVerticalOffset() const;
+        void setDisplayOffset(qreal horizontal, qreal vertical);
         int displayWrappingScheme() const;
         qreal diagonalFOV() const;
         qreal lensDistanceRatio() const;
@@ -103,6 +115,26 @@ namespace KWin
         bool mirrorPhysicalDisplays() const;
         bool curvedDisplay() const;
         void setCurvedDisplaySupported(bool supported);
+        bool scenePrewarmed() const;
+        QVariantMap virtualDisplayRefreshRates() const;
+        int textureMemoryBudgetMB() const;
+        QVariantMap textureMemoryStats() const;
+
+        // called from QML as the desktop atlas is resized to fit the texture memory budget
+        Q_INVOKABLE void reportTextureMemory(qint64 usedBytes, int downscaledDisplays);
+        Q_INVOKABLE void recordTextureEvictions(int displays);
+
+        // KCM live preview while a slider is dragged: a kcfg entry name and its value in the
+        // config's units. Nothing is persisted; values are applied at most once per frame.
+        void previewSetting(const QString &name, int value);
+
+        // called from QML when the 3D scene renders its first frame after activation
+        Q_INVOKABLE void reportSceneFirstFrame();
+        qreal activationToFirstFrameMs() const;
+
+        // the Stats D-Bus interface: paint, pose and texture memory counters since the last reset
+        QVariantMap performanceStats() const;
+        void resetPerformanceStats();
 
         void showCursor();
         void hideCursor();
@@ -119,6 +151,7 @@ namespace KWin
         void updateCursorPos();
         QVariantList listVirtualDisplays() const;
         bool removeVirtualDisplay(const QString &id);
+        bool setVirtualDisplayRefreshRate(const QString &id, int refreshRate);
         void moveCursorToFocusedDisplay();
         bool curvedDisplaySupported() const;
 
@@ -140,6 +173,9 @@ namespace KWin
         void mirrorPhysicalDisplaysChanged();
         void curvedDisplayChanged();
         void curvedDisplaySupportedChanged();
+        void textureMemoryBudgetChanged();
+        void scenePrewarmedChanged();
+        void virtualDisplayRefreshRatesChanged();
         void cursorImageSourceChanged();
         void cursorPosChanged();
 
@@ -148,7 +184,13 @@ namespace KWin
 
     private:
         void teardown();
+        void hideScene();
+        void applyPreviewSettings();
+        void setScenePrewarmed(bool prewarmed);
         bool checkParityByte(const char* data);
+        bool checkBlockChecksums(const char* data);
+        qsizetype mapPoseData();
+        void unmapPoseData();
         void setupGlobalShortcut(const BreezyShortcuts::Shortcut &shortcut, 
                                  std::function<void()> triggeredFunc);
         void recenter();
@@ -170,24 +212,33 @@ namespace KWin
         bool m_poseResetState;
         QList<QQuaternion> m_poseOrientations;
         QVector3D m_posePosition;
-        quint32 m_poseTimeElapsedMs;
+        qreal m_poseTimeElapsedMs = 0.0;
         quint64 m_poseTimestamp = 0;
+        quint64 m_poseSampleTimeNs = 0; // CLOCK_MONOTONIC, 0 if the driver doesn't publish it
         QList<qreal> m_lookAheadConfig;
         qreal m_lookAheadOverride = -1.0; // -1 = use device default
         QList<quint32> m_displayResolution;
-        qreal m_diagonalFOV;
-        qreal m_lensDistanceRatio;
-        bool m_sbsEnabled;
+        qreal m_diagonalFOV = 0.0;
+        qreal m_lensDistanceRatio = 0.0;
+        bool m_sbsEnabled = false;
         bool m_smoothFollowEnabled;
         QList<QQuaternion> m_smoothFollowOrigin;
-        bool m_customBannerEnabled;
-        QFileSystemWatcher *m_shmFileWatcher = nullptr;
-        QFileSystemWatcher *m_shmDirectoryWatcher = nullptr;
+        bool m_customBannerEnabled = false;
+        PoseSourceMonitor *m_poseSourceMonitor = nullptr;
         bool m_cursorHidden = false;
         QPointF m_cursorPos;
         QTimer *m_cursorUpdateTimer = nullptr;
         QTimer *m_watchdogTimer = nullptr;
+        QTimer *m_previewTimer = nullptr;
+        QHash<QString, int> m_pendingPreview;
+        bool m_previewedFocusedDistance = false; // driver not told yet, see applyPreviewSettings
         std::atomic<bool> m_poseUpdateInProgress{false};
+        // The driver's pose file, mapped once and remapped if it's replaced or resized. Each update
+        // copies it into m_poseSnapshot (sized once) and checks the copy, so nothing is allocated.
+        const char *m_poseMapping = nullptr;
+        qsizetype m_poseMappingSize = 0;
+        quint64 m_poseMappingInode = 0;
+        QByteArray m_poseSnapshot;
         qreal m_focusedDisplayDistance = 0.85;
         qreal m_allDisplaysDistance = 1.05;
         qreal m_displaySpacing = 0.0;
@@ -199,6 +250,16 @@ namespace KWin
         bool m_mirrorPhysicalDisplays = false;
         bool m_curvedDisplay = false;
         bool m_curvedDisplaySupported = false;
+        bool m_scenePrewarmed = false; // running (scene built) but not painted, see PrewarmScene
+        int m_textureMemoryBudgetMB = 256;
+        qint64 m_textureMemoryBytes = 0;
+        int m_downscaledDisplays = 0;
+        quint64 m_textureEvictions = 0;
+        std::chrono::steady_clock::time_point m_activatedAt;
+        bool m_awaitingFirstFrame = false;
+        qreal m_activationToFirstFrameMs = -1.0; // -1 until the first activation has rendered
+        PerformanceStats m_performanceStats;
+        GpuSpanTimer m_paintTimer; // GPU time of paintScreen on the glasses' screen
         float m_smoothFollowThreshold = 1.0f;
         bool m_allDisplaysFollowMode = false;
         bool m_focusedSmoothFollowEnabled = false;
@@ -211,8 +272,11 @@ namespace KWin
             Output *output = nullptr;
             QString id;
             QSize size;
+            int refreshRate = 0; // Hz, 0 = the output's native rate
+            int nativeRefreshRate = 0; // mHz, as created
         };
         QHash<QString, VirtualOutputInfo> m_virtualDisplays;
+        void applyVirtualDisplayRefreshRate(const VirtualOutputInfo &info);
     };
 
 } // namespace KWin
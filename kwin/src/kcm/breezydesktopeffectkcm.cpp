@@ -28,6 +28,7 @@
 #include <QProcess>
 #include <QComboBox>
 #include <QDBusInterface>
+#include <QDBusMessage>
 #include <QDBusConnection>
 #include <QDBusReply>
 #include <QDBusVariant>
@@ -328,16 +329,17 @@ BreezyDesktopEffectConfig::BreezyDesktopEffectConfig(QObject *parent, const KPlu
     connect(ui.EffectEnabled, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::updateDriverEnabled);
     connect(ui.SmoothFollowEnabled, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::updateSmoothFollowEnabled);
     connect(ui.kcfg_ZoomOnFocusEnabled, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_FocusedDisplayDistance, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_AllDisplaysDistance, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_DisplaySpacing, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_SmoothFollowThreshold, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_DisplayHorizontalOffset, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_DisplayVerticalOffset, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
-    connect(ui.kcfg_LookAheadOverride, &QSlider::valueChanged, this, &BreezyDesktopEffectConfig::save);
+    connectPreviewSlider(ui.kcfg_FocusedDisplayDistance, QStringLiteral("FocusedDisplayDistance"));
+    connectPreviewSlider(ui.kcfg_AllDisplaysDistance, QStringLiteral("AllDisplaysDistance"));
+    connectPreviewSlider(ui.kcfg_DisplaySpacing, QStringLiteral("DisplaySpacing"));
+    connectPreviewSlider(ui.kcfg_SmoothFollowThreshold, QString()); // driver-side, nothing to preview
+    connectPreviewSlider(ui.kcfg_DisplayHorizontalOffset, QStringLiteral("DisplayHorizontalOffset"));
+    connectPreviewSlider(ui.kcfg_DisplayVerticalOffset, QStringLiteral("DisplayVerticalOffset"));
+    connectPreviewSlider(ui.kcfg_LookAheadOverride, QStringLiteral("LookAheadOverride"));
     connect(ui.kcfg_DisplayWrappingScheme, qOverload<int>(&QComboBox::currentIndexChanged), this, &BreezyDesktopEffectConfig::save);
     connect(ui.kcfg_AntialiasingQuality, qOverload<int>(&QComboBox::currentIndexChanged), this, &BreezyDesktopEffectConfig::save);
     connect(ui.kcfg_MirrorPhysicalDisplays, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::save);
+    connect(ui.kcfg_PrewarmScene, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::save);
     connect(ui.kcfg_RemoveVirtualDisplaysOnDisable, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::save);
     connect(ui.kcfg_AllDisplaysFollowMode, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::save);
     connect(ui.kcfg_CurvedDisplay, &QCheckBox::toggled, this, &BreezyDesktopEffectConfig::save);
@@ -458,6 +460,7 @@ void BreezyDesktopEffectConfig::updateUiFromConfig()
     ui.kcfg_DisplayWrappingScheme->setCurrentIndex(BreezyDesktopConfig::self()->displayWrappingScheme());
     ui.kcfg_AntialiasingQuality->setCurrentIndex(BreezyDesktopConfig::self()->antialiasingQuality());
     ui.kcfg_MirrorPhysicalDisplays->setChecked(BreezyDesktopConfig::self()->mirrorPhysicalDisplays());
+    ui.kcfg_PrewarmScene->setChecked(BreezyDesktopConfig::self()->prewarmScene());
     ui.kcfg_CurvedDisplay->setChecked(BreezyDesktopConfig::self()->curvedDisplay());
     ui.kcfg_RemoveVirtualDisplaysOnDisable->setChecked(BreezyDesktopConfig::self()->removeVirtualDisplaysOnDisable());
     ui.kcfg_AllDisplaysFollowMode->setChecked(BreezyDesktopConfig::self()->allDisplaysFollowMode());
@@ -493,6 +496,31 @@ void BreezyDesktopEffectConfig::checkEffectLoaded() {
     }
 }
 
+// While a slider is dragged its values go to the effect as live previews; the config is only
+// written (and the effect reconfigured) when it's released. Keyboard and wheel steps save directly.
+void BreezyDesktopEffectConfig::connectPreviewSlider(QSlider *slider, const QString &setting)
+{
+    connect(slider, &QSlider::valueChanged, this, [this, slider, setting](int value) {
+        if (!slider->isSliderDown()) {
+            save();
+        } else if (!setting.isEmpty()) {
+            dbusPreviewSetting(setting, value);
+        }
+    });
+    connect(slider, &QSlider::sliderReleased, this, &BreezyDesktopEffectConfig::save);
+}
+
+void BreezyDesktopEffectConfig::dbusPreviewSetting(const QString &setting, int value) const {
+    // fire and forget: the effect coalesces previews per frame, and the drag must never block on KWin
+    QDBusMessage message = QDBusMessage::createMethodCall(
+        QStringLiteral("org.kde.KWin"),
+        QStringLiteral("/com/xronlinux/BreezyDesktop"),
+        QStringLiteral("com.xronlinux.BreezyDesktop"),
+        QStringLiteral("PreviewSetting"));
+    message << setting << value;
+    QDBusConnection::sessionBus().send(message);
+}
+
 static QDBusInterface makeVDInterface() {
     return QDBusInterface(
         QStringLiteral("org.kde.KWin"),
@@ -526,6 +554,20 @@ QVariantList BreezyDesktopEffectConfig::dbusRemoveVirtualDisplay(const QString &
     return list.isValid() ? list.value() : QVariantList{};
 }
 
+bool BreezyDesktopEffectConfig::dbusSetVirtualDisplayRefreshRate(const QString &id, int refreshRate, QString *error) const {
+    QDBusInterface iface = makeVDInterface();
+    if (!iface.isValid()) {
+        *error = tr("The Breezy Desktop effect isn't running");
+        return false;
+    }
+    QDBusReply<QVariantList> reply = iface.call(QStringLiteral("SetVirtualDisplayRefreshRate"), id, refreshRate);
+    if (!reply.isValid()) {
+        *error = reply.error().message();
+        return false;
+    }
+    return true;
+}
+
 bool BreezyDesktopEffectConfig::dbusCurvedDisplaySupported() const {
     QDBusInterface iface = makeVDInterface();
     if (!iface.isValid()) return false;
@@ -588,13 +630,22 @@ void BreezyDesktopEffectConfig::renderVirtualDisplays(const QVariantList &rows)
         const QString id = unwrapValue(row.value(QStringLiteral("id"))).toString();
         const int w = unwrapValue(row.value(QStringLiteral("width"))).toInt();
         const int h = unwrapValue(row.value(QStringLiteral("height"))).toInt();
+        const int refreshRate = unwrapValue(row.value(QStringLiteral("refreshRate"))).toInt();
 
         auto *rowWidget = new VirtualDisplayRow(listContainer);
-        rowWidget->setInfo(id, w, h);
+        rowWidget->setInfo(id, w, h, refreshRate);
         connect(rowWidget, &VirtualDisplayRow::removeRequested, this, [this](const QString &vid) {
             auto list = dbusRemoveVirtualDisplay(vid);
             renderVirtualDisplays(list);
         });
+        connect(rowWidget, &VirtualDisplayRow::refreshRateChangeRequested, this, [this, rowWidget](const QString &vid, int hz) {
+            QString error;
+            if (dbusSetVirtualDisplayRefreshRate(vid, hz, &error)) {
+                rowWidget->setRefreshRate(hz);
+            } else {
+                rowWidget->showRefreshRateError(error);
+            }
+        });
         listLayout->addWidget(rowWidget);
     }
 }
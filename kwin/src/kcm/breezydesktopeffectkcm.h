@@ -58,10 +58,16 @@ private:
     QVariantList dbusListVirtualDisplays() const;
     QVariantList dbusAddVirtualDisplay(int w, int h) const;
     QVariantList dbusRemoveVirtualDisplay(const QString &id) const;
+    // false with *error set if the effect rejected it or couldn't be reached
+    bool dbusSetVirtualDisplayRefreshRate(const QString &id, int refreshRate, QString *error) const;
     void renderVirtualDisplays(const QVariantList &rows);
 
     bool dbusCurvedDisplaySupported() const;
 
+    // Live preview while dragging sliders
+    void connectPreviewSlider(QSlider *slider, const QString &setting);
+    void dbusPreviewSetting(const QString &setting, int value) const;
+
     ::Ui::BreezyDesktopEffectConfig ui;
 
     KConfigWatcher::Ptr m_configWatcher;
@@ -1,6 +1,7 @@
 #include "virtualdisplayrow.h"
 #include "ui_virtualdisplayrow.h"
 
+#include <QComboBox>
 #include <QIcon>
 
 VirtualDisplayRow::VirtualDisplayRow(QWidget *parent)
@@ -14,14 +15,40 @@ VirtualDisplayRow::VirtualDisplayRow(QWidget *parent)
     connect(ui->buttonRemove, &QPushButton::clicked, this, [this]() {
         Q_EMIT removeRequested(m_id);
     });
+
+    // Idle-looking displays (reference docs, chat) don't need to be recomposited at full rate
+    ui->comboRefreshRate->addItem(tr("Native refresh"), 0);
+    for (int hz : {30, 15, 5, 1}) {
+        ui->comboRefreshRate->addItem(tr("%1 Hz").arg(hz), hz);
+    }
+    connect(ui->comboRefreshRate, &QComboBox::activated, this, [this](int index) {
+        Q_EMIT refreshRateChangeRequested(m_id, ui->comboRefreshRate->itemData(index).toInt());
+    });
 }
 
 VirtualDisplayRow::~VirtualDisplayRow() {
     delete ui;
 }
 
-void VirtualDisplayRow::setInfo(const QString &id, int w, int h) {
+void VirtualDisplayRow::setInfo(const QString &id, int w, int h, int refreshRate) {
     m_id = id;
     ui->labelId->setText(id);
     ui->labelRes->setText(QStringLiteral("%1x%2").arg(w).arg(h));
+    setRefreshRate(refreshRate);
+}
+
+void VirtualDisplayRow::setRefreshRate(int refreshRate) {
+    m_refreshRate = refreshRate;
+    int index = ui->comboRefreshRate->findData(refreshRate);
+    if (index < 0) {
+        ui->comboRefreshRate->addItem(tr("%1 Hz").arg(refreshRate), refreshRate);
+        index = ui->comboRefreshRate->count() - 1;
+    }
+    ui->comboRefreshRate->setCurrentIndex(index);
+    ui->comboRefreshRate->setToolTip(QString());
+}
+
+void VirtualDisplayRow::showRefreshRateError(const QString &error) {
+    setRefreshRate(m_refreshRate);
+    ui->comboRefreshRate->setToolTip(tr("Couldn't change the refresh rate: %1").arg(error));
 }
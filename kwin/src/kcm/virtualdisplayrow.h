@@ -10,12 +10,18 @@ public:
     explicit VirtualDisplayRow(QWidget *parent = nullptr);
     ~VirtualDisplayRow() override;
 
-    void setInfo(const QString &id, int w, int h);
+    void setInfo(const QString &id, int w, int h, int refreshRate = 0);
+    // Confirm an applied rate, or put back the previous one and show why the change failed
+    void setRefreshRate(int refreshRate);
+    void showRefreshRateError(const QString &error);
 
 Q_SIGNALS:
     void removeRequested(const QString &id);
+    // refreshRate in Hz, 0 for the output's native rate
+    void refreshRateChangeRequested(const QString &id, int refreshRate);
 
 private:
     Ui::VirtualDisplayRow *ui;
     QString m_id;
+    int m_refreshRate = 0;
 };
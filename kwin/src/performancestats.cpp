@@ -0,0 +1,204 @@
+#include "performancestats.h"
+
+#include <epoxy/gl.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace KWin
+{
+
+// a gap this long is a pause (driver restart, effect disabled), not missed samples
+static constexpr qreal POSE_GAP_RESET_MS = 1000.0;
+
+// paints further apart than this weren't a frame interval (effect hidden, screen off)
+static constexpr auto PAINT_GAP_RESET = std::chrono::milliseconds(500);
+
+void PerformanceStats::Series::record(qreal value)
+{
+    m_window[m_count % WINDOW] = value;
+    m_min = m_count == 0 ? value : std::min(m_min, value);
+    m_max = m_count == 0 ? value : std::max(m_max, value);
+    m_sum += value;
+    ++m_count;
+}
+
+void PerformanceStats::Series::reset()
+{
+    m_count = 0;
+    m_sum = 0.0;
+    m_min = 0.0;
+    m_max = 0.0;
+}
+
+qreal PerformanceStats::Series::recentMean() const
+{
+    const int samples = static_cast<int>(std::min<quint64>(m_count, WINDOW));
+    if (samples == 0) return 0.0;
+
+    qreal sum = 0.0;
+    for (int i = 0; i < samples; ++i) sum += m_window[i];
+    return sum / samples;
+}
+
+QVariantMap PerformanceStats::Series::summary() const
+{
+    const int samples = static_cast<int>(std::min<quint64>(m_count, WINDOW));
+    std::array<qreal, WINDOW> sorted;
+    std::copy(m_window.begin(), m_window.begin() + samples, sorted.begin());
+    std::sort(sorted.begin(), sorted.begin() + samples);
+    auto percentile = [&](qreal p) {
+        return samples == 0 ? 0.0 : sorted[std::min(samples - 1, static_cast<int>(p * samples))];
+    };
+
+    return QVariantMap{
+        {QStringLiteral("count"), m_count},
+        {QStringLiteral("mean"), m_count ? m_sum / m_count : 0.0},
+        {QStringLiteral("min"), m_min},
+        {QStringLiteral("max"), m_max},
+        {QStringLiteral("p50"), percentile(0.5)},
+        {QStringLiteral("p99"), percentile(0.99)}
+    };
+}
+
+void PerformanceStats::recordPaint(std::chrono::steady_clock::time_point time, qreal poseAgeMs)
+{
+    if (m_lastPaint.time_since_epoch().count() != 0 && time - m_lastPaint < PAINT_GAP_RESET) {
+        m_frameTimeMs.record(std::chrono::duration<qreal, std::milli>(time - m_lastPaint).count());
+    }
+    m_lastPaint = time;
+    m_poseAgeAtPaintMs.record(poseAgeMs);
+}
+
+void PerformanceStats::interruptPaints()
+{
+    m_lastPaint = {};
+}
+
+void PerformanceStats::recordGpuTime(qreal ms)
+{
+    m_gpuTimeMs.record(ms);
+}
+
+void PerformanceStats::recordPose(qreal sampleTimeMs, qreal sampleIntervalMs)
+{
+    // the watchdog re-reads the file without a new sample
+    if (sampleTimeMs == m_lastSampleTimeMs) return;
+
+    const qreal gapMs = sampleTimeMs - m_lastSampleTimeMs;
+    if (m_lastSampleTimeMs >= 0 && gapMs > 0 && gapMs < POSE_GAP_RESET_MS) {
+        m_poseIntervalMs.record(gapMs);
+        if (sampleIntervalMs > 0) {
+            m_missedPoseUpdates += static_cast<quint64>(std::max(0.0, std::round(gapMs / sampleIntervalMs) - 1.0));
+        }
+    }
+    m_lastSampleTimeMs = sampleTimeMs;
+    ++m_poseUpdates;
+}
+
+void PerformanceStats::recordRejectedPoseRead()
+{
+    ++m_rejectedPoseReads;
+}
+
+void PerformanceStats::reset()
+{
+    m_frameTimeMs.reset();
+    m_poseAgeAtPaintMs.reset();
+    m_poseIntervalMs.reset();
+    m_gpuTimeMs.reset();
+    m_poseUpdates = 0;
+    m_missedPoseUpdates = 0;
+    m_rejectedPoseReads = 0;
+    m_resetAt = std::chrono::steady_clock::now();
+}
+
+QVariantMap PerformanceStats::snapshot() const
+{
+    const qreal poseIntervalMs = m_poseIntervalMs.recentMean();
+    return QVariantMap{
+        {QStringLiteral("secondsSinceReset"), std::chrono::duration<qreal>(std::chrono::steady_clock::now() - m_resetAt).count()},
+        {QStringLiteral("frameTimeMs"), m_frameTimeMs.summary()},
+        {QStringLiteral("gpuTimeMs"), m_gpuTimeMs.summary()},
+        {QStringLiteral("poseAgeAtPaintMs"), m_poseAgeAtPaintMs.summary()},
+        {QStringLiteral("poseIntervalMs"), m_poseIntervalMs.summary()},
+        {QStringLiteral("poseUpdateRateHz"), poseIntervalMs > 0 ? 1000.0 / poseIntervalMs : 0.0},
+        {QStringLiteral("poseUpdates"), m_poseUpdates},
+        {QStringLiteral("missedPoseUpdates"), m_missedPoseUpdates},
+        {QStringLiteral("rejectedPoseReads"), m_rejectedPoseReads}
+    };
+}
+
+bool GpuSpanTimer::begin()
+{
+    if (m_supported < 0) {
+        m_supported = epoxy_is_desktop_gl()
+            ? (epoxy_gl_version() >= 33 || epoxy_has_gl_extension("GL_ARB_timer_query"))
+            : epoxy_has_gl_extension("GL_EXT_disjoint_timer_query");
+        if (m_supported) {
+            for (Span &span : m_spans) glGenQueries(2, span.queries);
+        }
+    }
+    if (!m_supported) return false;
+
+    // all spans in flight: skip this one rather than wait
+    Span &span = m_spans[m_next];
+    if (span.pending) return false;
+
+    glQueryCounter(span.queries[0], GL_TIMESTAMP);
+    m_open = true;
+    return true;
+}
+
+void GpuSpanTimer::end()
+{
+    if (!m_open) return;
+
+    Span &span = m_spans[m_next];
+    glQueryCounter(span.queries[1], GL_TIMESTAMP);
+    span.pending = true;
+    m_next = (m_next + 1) % DEPTH;
+    m_open = false;
+}
+
+qreal GpuSpanTimer::collect()
+{
+    if (m_supported <= 0) return -1;
+
+    Span &span = m_spans[m_oldest];
+    if (!span.pending) return -1;
+
+    GLint available = 0;
+    glGetQueryObjectiv(span.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return -1;
+
+    // a disjoint operation (GPU reset, frequency change) invalidates the timestamps
+    GLint disjoint = 0;
+    if (!epoxy_is_desktop_gl()) glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    GLuint64 start = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(span.queries[0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(span.queries[1], GL_QUERY_RESULT, &end);
+    span.pending = false;
+    m_oldest = (m_oldest + 1) % DEPTH;
+
+    if (disjoint || end < start) return -1;
+    return static_cast<qreal>(end - start) / 1e6;
+}
+
+void GpuSpanTimer::release()
+{
+    if (m_supported > 0) {
+        for (Span &span : m_spans) {
+            glDeleteQueries(2, span.queries);
+            span = Span();
+        }
+    }
+    m_supported = -1;
+    m_next = 0;
+    m_oldest = 0;
+    m_open = false;
+}
+
+}
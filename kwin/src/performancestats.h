@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QVariantMap>
+#include <array>
+#include <chrono>
+
+namespace KWin
+{
+    // Always-on counters behind the com.xronlinux.BreezyDesktop.Stats D-Bus interface.
+    //
+    // Recording is O(1) and never allocates, so it can stay in the paint and pose paths:
+    // each series keeps its count, mean, min and max since the last reset plus a window of
+    // recent samples, which is only sorted (for p50/p99) when a snapshot is taken.
+    class PerformanceStats
+    {
+    public:
+        class Series
+        {
+        public:
+            void record(qreal value);
+            void reset();
+
+            // count, mean, min, max since the reset; p50, p99 over the recent window
+            QVariantMap summary() const;
+            qreal recentMean() const;
+
+        private:
+            static constexpr int WINDOW = 512;
+            std::array<qreal, WINDOW> m_window{};
+            quint64 m_count = 0;
+            qreal m_sum = 0.0;
+            qreal m_min = 0.0;
+            qreal m_max = 0.0;
+        };
+
+        // a paint of the effect's target screen, and the pose age it painted with
+        void recordPaint(std::chrono::steady_clock::time_point time, qreal poseAgeMs);
+        void recordGpuTime(qreal ms);
+
+        // a pose read from the driver: its sample time and the driver's interval between the
+        // last two samples. Samples the effect never saw are counted as missed.
+        void recordPose(qreal sampleTimeMs, qreal sampleIntervalMs);
+
+        // a pose read that raced the driver (checksum or parity mismatch) and was dropped
+        void recordRejectedPoseRead();
+
+        // stops the frame time series from spanning a pause in painting
+        void interruptPaints();
+
+        void reset();
+        QVariantMap snapshot() const;
+
+    private:
+        Series m_frameTimeMs;
+        Series m_poseAgeAtPaintMs;
+        Series m_poseIntervalMs;
+        Series m_gpuTimeMs;
+        quint64 m_poseUpdates = 0;
+        quint64 m_missedPoseUpdates = 0;
+        quint64 m_rejectedPoseReads = 0;
+        std::chrono::steady_clock::time_point m_lastPaint;
+        qreal m_lastSampleTimeMs = -1.0;
+        std::chrono::steady_clock::time_point m_resetAt = std::chrono::steady_clock::now();
+    };
+
+    // GPU time of a span of GL commands from a pair of GL_TIMESTAMP queries. Results are
+    // collected without stalling: each pair is read a few frames later, once available.
+    class GpuSpanTimer
+    {
+    public:
+        // needs a current context; false if the driver has no timer queries
+        bool begin();
+        void end();
+
+        // the oldest finished span in ms, or -1 if none is ready
+        qreal collect();
+
+        // the queries belong to the compositor's context, which must be current
+        void release();
+
+    private:
+        static constexpr int DEPTH = 4;
+        struct Span {
+            unsigned int queries[2] = {0, 0}; // GLuint
+            bool pending = false;
+        };
+        std::array<Span, DEPTH> m_spans;
+        int m_next = 0;
+        int m_oldest = 0;
+        int m_supported = -1; // -1 until checked with a current context
+        bool m_open = false;
+    };
+}
@@ -0,0 +1,148 @@
+#include "posesourcemonitor.h"
+
+#include <QLoggingCategory>
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+Q_DECLARE_LOGGING_CATEGORY(KWIN_XR)
+
+namespace KWin
+{
+
+static constexpr uint32_t FILE_EVENTS = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+static constexpr uint32_t DIRECTORY_EVENTS = IN_CREATE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM;
+
+PoseSourceMonitor::PoseSourceMonitor(const QString &directory, const QString &fileName, QObject *parent)
+    : QThread(parent)
+    , m_directory(directory)
+    , m_fileName(fileName)
+    , m_filePath((directory + QLatin1Char('/') + fileName).toLocal8Bit())
+{
+    setObjectName(QStringLiteral("BreezyPoseMonitor"));
+    m_stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+PoseSourceMonitor::~PoseSourceMonitor()
+{
+    stop();
+    if (m_stopFd >= 0) {
+        close(m_stopFd);
+    }
+}
+
+void PoseSourceMonitor::stop()
+{
+    if (!isRunning()) return;
+
+    requestInterruption();
+    if (m_stopFd >= 0) {
+        const uint64_t one = 1;
+        if (write(m_stopFd, &one, sizeof(one)) != sizeof(one)) {
+            qCWarning(KWIN_XR) << "Breezy - pose monitor: failed to signal stop:" << strerror(errno);
+        }
+    }
+    wait();
+}
+
+void PoseSourceMonitor::acknowledgePoseData()
+{
+    m_poseDataPending.store(false, std::memory_order_release);
+}
+
+void PoseSourceMonitor::notifyPoseData()
+{
+    // the driver writes at IMU rate; don't queue more than one update for the main thread
+    if (!m_poseDataPending.exchange(true, std::memory_order_acq_rel)) {
+        Q_EMIT poseDataChanged();
+    }
+}
+
+bool PoseSourceMonitor::watchFile(int inotifyFd)
+{
+    if (m_fileWatch >= 0) {
+        inotify_rm_watch(inotifyFd, m_fileWatch);
+    }
+    m_fileWatch = inotify_add_watch(inotifyFd, m_filePath.constData(), FILE_EVENTS);
+    return m_fileWatch >= 0;
+}
+
+void PoseSourceMonitor::run()
+{
+    const int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        qCWarning(KWIN_XR) << "Breezy - pose monitor: inotify_init1 failed:" << strerror(errno);
+        return;
+    }
+
+    const QByteArray directory = m_directory.toLocal8Bit();
+    const QByteArray fileName = m_fileName.toLocal8Bit();
+    const int directoryWatch = inotify_add_watch(inotifyFd, directory.constData(), DIRECTORY_EVENTS);
+    if (directoryWatch < 0) {
+        qCWarning(KWIN_XR) << "Breezy - pose monitor: can't watch" << m_directory << strerror(errno);
+    }
+
+    if (watchFile(inotifyFd)) {
+        Q_EMIT poseSourceChanged(true);
+    }
+
+    pollfd fds[2] = {
+        {inotifyFd, POLLIN, 0},
+        {m_stopFd, POLLIN, 0},
+    };
+    const nfds_t nfds = m_stopFd >= 0 ? 2 : 1;
+
+    alignas(inotify_event) char buffer[4096];
+    while (!isInterruptionRequested()) {
+        // without a stop eventfd, fall back to checking for interruption once a second
+        if (poll(fds, nfds, m_stopFd >= 0 ? -1 : 1000) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (nfds > 1 && (fds[1].revents & POLLIN)) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        bool dataChanged = false;
+        bool sourceChanged = false;
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + length; ) {
+                const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                if (event->wd == directoryWatch) {
+                    // most /dev/shm traffic is other applications' files; drop it here
+                    if (event->len == 0 || fileName != event->name) continue;
+
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        watchFile(inotifyFd);
+                    }
+                    sourceChanged = true;
+                } else if (event->wd == m_fileWatch) {
+                    if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                        m_fileWatch = -1;
+                        sourceChanged = true;
+                    } else {
+                        dataChanged = true;
+                    }
+                }
+            }
+        }
+
+        if (sourceChanged) {
+            Q_EMIT poseSourceChanged(access(m_filePath.constData(), F_OK) == 0);
+        }
+        if (dataChanged || sourceChanged) {
+            notifyPoseData();
+        }
+    }
+
+    close(inotifyFd);
+    m_fileWatch = -1;
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QString>
+#include <QThread>
+#include <atomic>
+
+namespace KWin
+{
+    // Watches the driver's pose shm file with inotify on a worker thread.
+    //
+    // Only events for the exact file name are acted on, so unrelated /dev/shm churn
+    // (browsers, Electron) never reaches the compositor's main thread. Re-creation
+    // (IN_CREATE/IN_MOVED_TO in the directory, IN_DELETE_SELF on the file) moves the
+    // file watch to the new inode. Data notifications are coalesced: at most one
+    // poseDataChanged is queued until the receiver calls acknowledgePoseData().
+    class PoseSourceMonitor : public QThread
+    {
+        Q_OBJECT
+
+    public:
+        PoseSourceMonitor(const QString &directory, const QString &fileName, QObject *parent = nullptr);
+        ~PoseSourceMonitor() override;
+
+        void stop();
+        void acknowledgePoseData();
+
+    Q_SIGNALS:
+        // the file was written
+        void poseDataChanged();
+
+        // the file appeared, was replaced or went away
+        void poseSourceChanged(bool exists);
+
+    protected:
+        void run() override;
+
+    private:
+        bool watchFile(int inotifyFd);
+        void notifyPoseData();
+
+        const QString m_directory;
+        const QString m_fileName;
+        const QByteArray m_filePath;
+        int m_stopFd = -1;
+        int m_fileWatch = -1;
+        std::atomic<bool> m_poseDataPending{false};
+    };
+}
@@ -18,6 +18,89 @@ Node {
         id: displays
     }
 
+    // All displays are drawn from one desktop texture, one instanced draw call per mesh group
+    property var screenSizes: screens.map(screen => ({ width: screen.geometry.width, height: screen.geometry.height }))
+    property var atlasLayout: displays.atlasLayout(screenSizes.map((size, index) => displays.scaledSize(size, textureScales[index] ?? 1.0)))
+
+    // Per-display desktop texture scale, lowered for the longest-unfocused displays when the
+    // atlas would exceed effect.textureMemoryBudgetMB (see updateTextureBudget)
+    property var textureScales: screens.map(() => 1.0)
+    property var lastLookedAtMs: []
+    property var meshGroups: displays.meshGroups(screenSizes)
+
+    // bumped as display nodes come and go, so the instance lists pick up their entries
+    property int displaysRevision: 0
+
+    property point cursorPos: effect.cursorPos
+    property int cursorScreenIndex: screens.findIndex(screen => {
+        const geometry = screen.geometry;
+        return cursorPos.x >= geometry.x && cursorPos.x < geometry.x + geometry.width &&
+               cursorPos.y >= geometry.y && cursorPos.y < geometry.y + geometry.height;
+    })
+
+    property CustomMaterial displayMaterial: CustomMaterial {
+        depthDrawMode: CustomMaterial.AlwaysDepthDraw
+        shadingMode: CustomMaterial.Unshaded
+
+        property real atlasWidth: breezyDesktop.atlasLayout.width
+        property real atlasHeight: breezyDesktop.atlasLayout.height
+        property bool showCursor: breezyDesktop.cursorScreenIndex !== -1
+        property real cursorScale: showCursor ? (breezyDesktop.textureScales[breezyDesktop.cursorScreenIndex] ?? 1.0) : 1.0
+        property real cursorX: {
+            if (!showCursor) return 0;
+            const geometry = breezyDesktop.screens[breezyDesktop.cursorScreenIndex].geometry;
+            return breezyDesktop.atlasLayout.rects[breezyDesktop.cursorScreenIndex].x + (breezyDesktop.cursorPos.x - geometry.x) * cursorScale;
+        }
+        property real cursorY: {
+            if (!showCursor) return 0;
+            const geometry = breezyDesktop.screens[breezyDesktop.cursorScreenIndex].geometry;
+            return breezyDesktop.atlasLayout.rects[breezyDesktop.cursorScreenIndex].y + (breezyDesktop.cursorPos.y - geometry.y) * cursorScale;
+        }
+        property real cursorW: effect.cursorImageSize.width * cursorScale
+        property real cursorH: effect.cursorImageSize.height * cursorScale
+
+        property TextureInput desktopTex: TextureInput {
+            texture: Texture {
+                sourceItem: DesktopAtlas {
+                    screens: breezyDesktop.screens
+                    layout: breezyDesktop.atlasLayout
+                    scales: breezyDesktop.textureScales
+                }
+            }
+        }
+        property TextureInput cursorTex: TextureInput {
+            texture: Texture {
+                sourceItem: Image {
+                    source: effect.cursorImageSource
+                    width: effect.cursorImageSize.width
+                    height: effect.cursorImageSize.height
+                }
+            }
+        }
+
+        fragmentShader: "cursorOverlay.frag"
+        vertexShader: "cursorOverlay.vert"
+    }
+
+    onAtlasLayoutChanged: {
+        effect.reportTextureMemory(displays.atlasBytes(atlasLayout), textureScales.filter(scale => scale < 1.0).length);
+    }
+
+    // Most recently looked-at displays keep full resolution; the rest are downscaled as needed
+    // to fit the budget, and restored as soon as they're looked at again.
+    function updateTextureBudget() {
+        if (lookingAtMonitorIndex !== -1) lastLookedAtMs[lookingAtMonitorIndex] = Date.now();
+
+        const priority = screens.map((screen, index) => index)
+                                .sort((a, b) => (lastLookedAtMs[b] ?? 0) - (lastLookedAtMs[a] ?? 0));
+        const scales = displays.textureScales(screenSizes, priority, effect.textureMemoryBudgetMB * 1024 * 1024);
+        if (scales.every((scale, index) => scale === textureScales[index])) return;
+
+        const evictions = scales.filter((scale, index) => scale < (textureScales[index] ?? 1.0)).length;
+        textureScales = scales;
+        if (evictions > 0) effect.recordTextureEvictions(evictions);
+    }
+
     function displayAtIndex(index) {
         if (index < 0 || index >= screens.length) {
             return null;
@@ -108,6 +191,8 @@ Node {
 
             if (startSmoothFollowFocusAnimation) smoothFollowFocusedAnimation.restart();
         }
+
+        updateTextureBudget();
     }
 
     function displayRotationVector(display) {
@@ -155,11 +240,21 @@ Node {
 
     Repeater3D {
         id: breezyDesktopDisplays
+        asynchronous: true
         model: breezyDesktop.screens.length
+        onObjectAdded: breezyDesktop.displaysRevision++
+        onObjectRemoved: breezyDesktop.displaysRevision++
         delegate: BreezyDesktopDisplay {
             screen: breezyDesktop.screens[index]
             monitorPlacement: breezyDesktop.monitorPlacements[index]
             fovDetails: breezyDesktop.fovDetails
+            atlasRect: {
+                const atlas = breezyDesktop.atlasLayout;
+                const rect = atlas.rects[index];
+                if (!rect) return Qt.vector4d(0, 0, 1, 1);
+
+                return Qt.vector4d(rect.x / atlas.width, rect.y / atlas.height, rect.width / atlas.width, rect.height / atlas.height);
+            }
             
             property real smoothFollowTransitionProgress: 0.0
             property real monitorDistance: effect.allDisplaysDistance
@@ -192,6 +287,24 @@ Node {
         }
     }
 
+    Repeater3D {
+        asynchronous: true
+        model: breezyDesktop.meshGroups
+        delegate: DisplayInstances {
+            required property var modelData
+
+            group: modelData
+            fovDetails: breezyDesktop.fovDetails
+            materials: [ breezyDesktop.displayMaterial ]
+            entries: {
+                breezyDesktop.displaysRevision;
+                return modelData.indexes.map(index => breezyDesktop.displayAtIndex(index))
+                                        .filter(display => !!display)
+                                        .map(display => display.instanceEntry);
+            }
+        }
+    }
+
     // smoothFollowEnabled gets cleared before the orientation begins slerping back to the origin so we can't just 
     // switch off smooth follow logic based on this flag. Instead, we have to rely on
     // smoothFollowTransitionProgress to determine how much of the orientations to apply.
@@ -262,6 +375,9 @@ Node {
     // release references to displays and stale indexes
     onScreensChanged: {
         breezyDesktop.focusedMonitorIndex = -1;
+        breezyDesktop.lastLookedAtMs = [];
+        breezyDesktop.textureScales = screens.map(() => 1.0);
+        updateTextureBudget();
         zoomOutAnimation.stop();
         zoomInAnimation.stop();
         zoomOnFocusSequence.stop();
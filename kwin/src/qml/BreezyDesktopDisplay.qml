@@ -1,7 +1,9 @@
 import QtQuick
 import QtQuick3D
 
-Model {
+// Placement of one display. Nothing is drawn here: DisplayInstances draws the display as
+// an instance of its size group's mesh, using instanceEntry for the transform.
+Node {
     id: display
 
     required property QtObject screen
@@ -9,76 +11,13 @@ Model {
     required property int index
     required property var fovDetails
 
-    property string cursorImageSource: effect.cursorImageSource
-    property size cursorImageSize: effect.cursorImageSize
-    property point cursorPos: effect.cursorPos
+    // this display's region of the desktop atlas, normalized (x, y, width, height)
+    property vector4d atlasRect: Qt.vector4d(0, 0, 1, 1)
 
-    Displays {
-        id: displays
+    readonly property InstanceListEntry instanceEntry: InstanceListEntry {
+        position: display.position
+        rotation: display.rotation
+        scale: display.scale
+        customData: display.atlasRect
     }
-
-    // Default to simple rectangle source so we work on older Qt6
-    // We'll attempt to dynamically load CurvableDisplayMesh.qml in onCompleted
-    source: "#Rectangle"
-
-    Component.onCompleted: {
-        try {
-            const component = Qt.createComponent(Qt.resolvedUrl("CurvableDisplayMesh.qml"), Component.PreferSynchronous);
-            if (component.status === Component.Ready) {
-                const mesh = component.createObject(display, {
-                    fovDetails: Qt.binding(() => display.fovDetails),
-                    monitorGeometry: Qt.binding(() => display.screen ? display.screen.geometry : null),
-                    fovConversionFns: Qt.binding(() => displays.fovConversionFns)
-                });
-                if (mesh) {
-                    display.source = "";
-                    display.geometry = mesh;
-                    effect.curvedDisplaySupported = true;
-                }
-            } else {
-                console.error("Breezy - CurvableDisplayMesh not available:", component.errorString());
-                effect.curvedDisplaySupported = false;
-            }
-        } catch (e) {
-            console.error("Breezy - CurvableDisplayMesh loading error:", e);
-            effect.curvedDisplaySupported = false;
-        }
-    }
-    materials: [
-        CustomMaterial {
-            id: customMat
-            depthDrawMode: CustomMaterial.AlwaysDepthDraw
-            shadingMode: CustomMaterial.Unshaded
-
-            property real screenWidth: display.screen.geometry.width
-            property real screenHeight: display.screen.geometry.height
-            property real cursorX: display.cursorPos.x - display.screen.geometry.x
-            property real cursorY: display.cursorPos.y - display.screen.geometry.y
-            property real cursorW: display.cursorImageSize.width
-            property real cursorH: display.cursorImageSize.height
-            property bool showCursor: cursorX >= 0 && cursorX < screenWidth && cursorY >= 0 && cursorY < screenHeight
-
-            property TextureInput desktopTex: TextureInput {
-                texture: Texture {
-                    sourceItem: DesktopView {
-                        screen: display.screen
-                        width: display.screen.geometry.width
-                        height: display.screen.geometry.height
-                    }
-                }
-            }
-            property TextureInput cursorTex: TextureInput {
-                texture: Texture {
-                    sourceItem: Image {
-                        source: effect.cursorImageSource
-                        width: effect.cursorImageSize.width
-                        height: effect.cursorImageSize.height
-                    }
-                }
-            }
-
-            fragmentShader: "cursorOverlay.frag"
-            vertexShader: "cursorOverlay.vert"
-        }
-    ]
 }
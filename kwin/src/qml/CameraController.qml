@@ -53,7 +53,7 @@ Item {
         camera.eulerRotation = applyLookAhead(
             rates,
             lookAheadMS(
-                effect.poseTimestamp,
+                effect.poseAgeMs,
                 effect.lookAheadConfig,
                 effect.lookAheadOverride
             )
@@ -62,9 +62,8 @@ Item {
     }
 
     // how far to look ahead is how old the pose data is plus a constant that is either the default for this device or an override
-    function lookAheadMS(poseDateMs, lookAheadConfig, override) {
-        // how stale the pose data is
-        const dataAge = Date.now() - poseDateMs;
+    function lookAheadMS(dataAge, lookAheadConfig, override) {
+        // dataAge is how stale the pose data is, from monotonic sample times when the driver provides them
 
         const lookAheadConstant = lookAheadConfig[0];
         const lookAheadMultiplier = lookAheadConfig[1];
@@ -0,0 +1,63 @@
+import QtQuick
+
+// Every display's desktop in one item, laid out by Displays.atlasLayout, so all display
+// instances sample a single texture. Displays downscaled for the texture memory budget
+// get a proportionally smaller region. Displays with a reduced refresh rate are resampled
+// on a timer instead of on every desktop repaint.
+Item {
+    id: desktopAtlas
+
+    required property var screens
+    required property var layout
+    required property var scales
+
+    width: layout.width
+    height: layout.height
+
+    Repeater {
+        model: desktopAtlas.screens.length
+
+        Item {
+            id: atlasRegion
+
+            required property int index
+            readonly property var rect: desktopAtlas.layout.rects[index]
+            readonly property int refreshRate: effect.virtualDisplayRefreshRates[desktopAtlas.screens[index].name] ?? 0
+
+            x: rect.x
+            y: rect.y
+            width: rect.width
+            height: rect.height
+
+            // windows straddling screens would otherwise bleed into the neighbouring region
+            clip: true
+
+            // laid out at full size, rendered into a region shrunk by the display's texture scale
+            DesktopView {
+                id: desktopView
+                screen: desktopAtlas.screens[index]
+                width: screen.geometry.width
+                height: screen.geometry.height
+                transformOrigin: Item.TopLeft
+                scale: desktopAtlas.scales[index] ?? 1.0
+            }
+
+            ShaderEffectSource {
+                id: throttledView
+                anchors.fill: parent
+                visible: atlasRegion.refreshRate > 0
+                sourceItem: visible ? desktopView : null
+                hideSource: visible
+                live: false
+            }
+
+            Timer {
+                interval: Math.max(1000 / atlasRegion.refreshRate, 1)
+                running: throttledView.visible
+                repeat: true
+                triggeredOnStart: true
+                onTriggered: throttledView.scheduleUpdate()
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+import QtQuick
+import QtQuick3D
+
+// Draws every display of one size with a single mesh and draw call. Each display's
+// transform and desktop atlas region come from its BreezyDesktopDisplay's instance entry.
+Model {
+    id: displayInstances
+
+    required property var group
+    required property var fovDetails
+    required property var entries
+
+    Displays {
+        id: displays
+    }
+
+    instancing: InstanceList {
+        instances: displayInstances.entries
+    }
+
+    // Default to simple rectangle source so we work on older Qt6. CurvableDisplayMesh needs
+    // QtQuick3D.Helpers' ProceduralMesh, so it's incubated asynchronously and swapped in when
+    // ready rather than blocking the scene's creation.
+    source: "#Rectangle"
+
+    function useCurvableMesh(mesh) {
+        if (!mesh) return;
+
+        displayInstances.source = "";
+        displayInstances.geometry = mesh;
+        effect.curvedDisplaySupported = true;
+    }
+
+    function incubateCurvableMesh(component) {
+        if (component.status === Component.Error) {
+            console.error("Breezy - CurvableDisplayMesh not available:", component.errorString());
+            effect.curvedDisplaySupported = false;
+            return;
+        }
+        if (component.status !== Component.Ready) return;
+
+        const incubator = component.incubateObject(displayInstances, {
+            fovDetails: Qt.binding(() => displayInstances.fovDetails),
+            monitorGeometry: Qt.binding(() => displayInstances.group ? { width: displayInstances.group.width, height: displayInstances.group.height } : null),
+            fovConversionFns: Qt.binding(() => displays.fovConversionFns)
+        }, Qt.Asynchronous);
+        if (incubator.status === Component.Ready) {
+            useCurvableMesh(incubator.object);
+        } else {
+            incubator.onStatusChanged = function(status) {
+                if (status === Component.Ready) useCurvableMesh(incubator.object);
+            };
+        }
+    }
+
+    Component.onCompleted: {
+        try {
+            const component = Qt.createComponent(Qt.resolvedUrl("CurvableDisplayMesh.qml"), Component.Asynchronous);
+            if (component.status === Component.Loading) {
+                component.statusChanged.connect(() => incubateCurvableMesh(component));
+            } else {
+                incubateCurvableMesh(component);
+            }
+        } catch (e) {
+            console.error("Breezy - CurvableDisplayMesh loading error:", e);
+            effect.curvedDisplaySupported = false;
+        }
+    }
+}
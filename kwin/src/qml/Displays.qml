@@ -409,6 +409,80 @@ QtObject {
         return -1;
     }
 
+    // Packs display-sized regions into rows of the shared desktop texture, left to right, starting
+    // a new row when the next region would pass maxWidth. The gap keeps linear filtering at one
+    // display's edge from sampling its neighbour.
+    function atlasLayout(sizes, maxWidth = 8192, gap = 2) {
+        const rects = [];
+        let x = 0;
+        let y = 0;
+        let rowHeight = 0;
+        let width = 1;
+        for (const size of sizes) {
+            if (x > 0 && x + size.width > maxWidth) {
+                x = 0;
+                y += rowHeight + gap;
+                rowHeight = 0;
+            }
+            rects.push({ x: x, y: y, width: size.width, height: size.height });
+            width = Math.max(width, x + size.width);
+            rowHeight = Math.max(rowHeight, size.height);
+            x += size.width + gap;
+        }
+
+        return { width: width, height: Math.max(y + rowHeight, 1), rects: rects };
+    }
+
+    // Bytes of the desktop atlas texture's color buffer
+    function atlasBytes(layout) {
+        return layout.width * layout.height * 4;
+    }
+
+    function scaledSize(size, scale) {
+        return { width: Math.max(1, Math.round(size.width * scale)), height: Math.max(1, Math.round(size.height * scale)) };
+    }
+
+    // Halves display texture scales, lowest priority display first, until the atlas fits in
+    // budgetBytes or every display is at minScale. priority lists display indexes, most important
+    // first, so the display being looked at only loses resolution if nothing else can.
+    // Displays share atlas rows, so a halving can save nothing on its own (the row keeps its
+    // height) and only pays off together with a later one. A second pass, most important
+    // display first, then doubles scales back wherever that doesn't grow the atlas past the
+    // budget, which undoes the halvings that bought nothing.
+    function textureScales(sizes, priority, budgetBytes, minScale = 0.125) {
+        const scales = sizes.map(() => 1.0);
+        const bytes = () => atlasBytes(atlasLayout(sizes.map((size, index) => scaledSize(size, scales[index]))));
+        for (let i = priority.length - 1; i >= 0; i--) {
+            const index = priority[i];
+            while (scales[index] > minScale && bytes() > budgetBytes) {
+                scales[index] /= 2;
+            }
+        }
+        for (const index of priority) {
+            while (scales[index] < 1.0) {
+                const limit = Math.max(budgetBytes, bytes());
+                scales[index] *= 2;
+                if (bytes() > limit) {
+                    scales[index] /= 2;
+                    break;
+                }
+            }
+        }
+        return scales;
+    }
+
+    // Groups display indexes by size, since same-sized displays share a mesh and can be drawn
+    // as instances of it
+    function meshGroups(sizes) {
+        const groups = {};
+        sizes.forEach((size, index) => {
+            const key = `${size.width}x${size.height}`;
+            if (!groups[key]) groups[key] = { width: size.width, height: size.height, indexes: [] };
+            groups[key].indexes.push(index);
+        });
+        return Object.values(groups);
+    }
+
     function slerpVector(from, to, progress) {
         const inverseProgress = 1.0 - progress;
         const finalVector = Qt.vector3d(
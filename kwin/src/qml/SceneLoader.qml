@@ -0,0 +1,68 @@
+import QtQuick
+
+// The 3D scene is incubated asynchronously as soon as the glasses are enabled (or while the
+// effect is pre-warmed), behind the desktop view and calibration banner, and only replaces
+// them once it's ready and the pose has left its reset state. Plugging in the glasses then
+// never stalls KWin's main thread on creating the displays.
+Item {
+    id: sceneLoader
+
+    property bool targetScreenSupported: false
+    property bool targetScreenIsVirtual: false
+    property bool isEnabled: false
+    property bool scenePrewarmed: false
+    property bool poseResetState: false
+
+    property alias sceneComponent: view3DLoader.sourceComponent
+    property alias fallbackComponent: viewLoader.sourceComponent
+    readonly property alias sceneItem: view3DLoader.item
+    readonly property alias sceneStatus: view3DLoader.status
+    readonly property bool sceneShown: view3DLoader.visible
+
+    readonly property bool sceneWanted: targetScreenSupported && (isEnabled || scenePrewarmed)
+
+    Loader {
+        id: view3DLoader
+        anchors.fill: parent
+        asynchronous: true
+        active: false
+        visible: false
+        onStatusChanged: sceneLoader.update()
+    }
+
+    Loader {
+        id: viewLoader
+        anchors.fill: parent
+    }
+
+    // Loading starts right away, unloading waits for the event loop: enabling clears
+    // scenePrewarmed and sets isEnabled one after the other, and the scene mustn't be
+    // torn down in between
+    function update() {
+        if (targetScreenIsVirtual) return;
+
+        if (sceneWanted) {
+            view3DLoader.active = true;
+        } else {
+            Qt.callLater(releaseUnwantedScene);
+        }
+
+        const show3DView = view3DLoader.active && isEnabled && !poseResetState && view3DLoader.status === Loader.Ready;
+        view3DLoader.visible = show3DView;
+        viewLoader.active = !show3DView;
+    }
+
+    function releaseUnwantedScene() {
+        if (targetScreenIsVirtual || sceneWanted) return;
+
+        view3DLoader.active = false;
+        view3DLoader.visible = false;
+        viewLoader.active = true;
+    }
+
+    onSceneWantedChanged: update()
+    onIsEnabledChanged: update()
+    onPoseResetStateChanged: update()
+    onTargetScreenIsVirtualChanged: update()
+    Component.onCompleted: update()
+}
@@ -1,18 +1,24 @@
 VARYING vec3 pos;
 VARYING vec2 texcoord;
+VARYING vec4 atlasRect;
 
 void MAIN() {
-    vec2 tex = vec2(texcoord.x, 1.0 - texcoord.y);
+    vec2 tex = atlasRect.xy + vec2(texcoord.x, 1.0 - texcoord.y) * atlasRect.zw;
     vec4 color = texture(desktopTex, tex);
     if (showCursor) {
-        vec2 fragCoord = tex * vec2(screenWidth, screenHeight);
+        vec2 fragCoord = tex * vec2(atlasWidth, atlasHeight);
         vec2 cursorTopLeft = vec2(cursorX, cursorY);
         vec2 cursorBottomRight = cursorTopLeft + vec2(cursorW, cursorH);
-        if (fragCoord.x >= cursorTopLeft.x && fragCoord.x < cursorBottomRight.x && fragCoord.y >= cursorTopLeft.y && fragCoord.y < cursorBottomRight.y) {
+
+        // only the display the cursor is on draws it, so it doesn't spill into a neighbouring region
+        vec2 regionTopLeft = atlasRect.xy * vec2(atlasWidth, atlasHeight);
+        vec2 regionBottomRight = regionTopLeft + atlasRect.zw * vec2(atlasWidth, atlasHeight);
+        bool cursorInRegion = all(greaterThanEqual(cursorTopLeft, regionTopLeft)) && all(lessThan(cursorTopLeft, regionBottomRight));
+        if (cursorInRegion && fragCoord.x >= cursorTopLeft.x && fragCoord.x < cursorBottomRight.x && fragCoord.y >= cursorTopLeft.y && fragCoord.y < cursorBottomRight.y) {
             vec2 rel = (fragCoord - cursorTopLeft) / vec2(cursorW, cursorH);
             vec4 cursorCol = texture(cursorTex, rel);
             color = mix(color, cursorCol, cursorCol.a);
         }
     }
     FRAGCOLOR = color;
-}
\ No newline at end of file
+}
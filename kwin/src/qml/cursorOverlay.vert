@@ -1,10 +1,12 @@
 VARYING vec3 pos;
 VARYING vec2 texcoord;
+VARYING vec4 atlasRect;
 
-// this is a no-op vertex shader, CustomMaterial required one
+// displays are drawn instanced; the instance data is the display's desktop atlas region
 void MAIN()
 {
     pos = VERTEX;
     texcoord = UV0;
-    POSITION = MODELVIEWPROJECTION_MATRIX * vec4(pos, 1.0);
-}
\ No newline at end of file
+    atlasRect = INSTANCE_DATA;
+    POSITION = INSTANCE_MODELVIEWPROJECTION_MATRIX * vec4(pos, 1.0);
+}
@@ -95,6 +95,7 @@ Item {
     property bool targetScreenIsVirtual: targetScreen.name.includes("BreezyDesktop")
     property bool poseResetState: effect.poseResetState
     property bool isEnabled: effect.isEnabled
+    property bool scenePrewarmed: effect.scenePrewarmed
 
     Component {
         id: desktopViewComponent
@@ -107,7 +108,28 @@ Item {
     Component {
         id: view3DComponent
         View3D {
+            id: view3D
             anchors.fill: parent
+
+            // reports activation-to-first-frame time once the scene is shown, once per
+            // activation: the scene can outlive one (pre-warming), so each enable re-arms it
+            FrameAnimation {
+                id: firstFrameReport
+                property bool armed: true
+                running: armed && view3D.visible
+                onTriggered: {
+                    armed = false;
+                    root.effect.reportSceneFirstFrame();
+                }
+            }
+
+            Connections {
+                target: root.effect
+                function onEnabledStateChanged() {
+                    if (root.effect.isEnabled) firstFrameReport.armed = true;
+                }
+            }
+
             environment: SceneEnvironment {
                 antialiasingMode: root.effect.antialiasingQuality === 0 ? SceneEnvironment.NoAA : SceneEnvironment.SSAA
                 antialiasingQuality: root.effect.antialiasingQuality === 0 ? SceneEnvironment.Medium : (
@@ -135,15 +157,21 @@ Item {
         }
     }
 
-    Loader {
-        id: viewLoader
+    SceneLoader {
+        id: sceneLoader
         anchors.fill: parent
+        sceneComponent: view3DComponent
+        fallbackComponent: desktopViewComponent
+        targetScreenSupported: root.targetScreenSupported
+        targetScreenIsVirtual: root.targetScreenIsVirtual
+        isEnabled: root.isEnabled
+        scenePrewarmed: root.scenePrewarmed
+        poseResetState: root.poseResetState
     }
 
     function checkLoadedComponent() {
-        console.log(`Breezy - checking screen ${targetScreen.model}: ${targetScreenSupported} ${targetScreenIsVirtual} ${isEnabled} ${poseResetState}`);
-        const show3DView = targetScreenSupported && isEnabled && !poseResetState;
-        if (!targetScreenIsVirtual) viewLoader.sourceComponent = show3DView ? view3DComponent : desktopViewComponent;
+        console.log(`Breezy - checking screen ${targetScreen.model}: ${targetScreenSupported} ${targetScreenIsVirtual} ${isEnabled} ${poseResetState} ${sceneLoader.sceneStatus}`);
+        sceneLoader.update();
         if (targetScreenSupported) effect.effectTargetScreenIndex = KWinComponents.Workspace.screens.indexOf(targetScreen);
     }
 
@@ -158,6 +186,10 @@ Item {
     onIsEnabledChanged: {
         checkLoadedComponent();
     }
+
+    onScenePrewarmedChanged: {
+        checkLoadedComponent();
+    }
     
     Component.onCompleted: {
         checkLoadedComponent();
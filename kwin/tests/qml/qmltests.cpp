@@ -0,0 +1,22 @@
+/*
+ * Runs the tst_*.qml files in this directory (ctest passes it with -input). The scene's QML
+ * module is linked in as resources, as it is in the plugin, so the tests import it from qrc.
+ */
+
+#include <QQmlEngine>
+#include <QtQuickTest>
+
+class Setup : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void qmlEngineAvailable(QQmlEngine *engine)
+    {
+        engine->addImportPath(QStringLiteral("qrc:/"));
+    }
+};
+
+QUICK_TEST_MAIN_WITH_SETUP(breezy_qml, Setup)
+
+#include "qmltests.moc"
@@ -0,0 +1,39 @@
+import QtQuick
+import QtTest
+import BreezyDesktopScene
+
+TestCase {
+    name: "Displays"
+
+    Displays {
+        id: displays
+    }
+
+    readonly property var fullHd: ({ width: 1920, height: 1080 })
+    readonly property var uhd: ({ width: 3840, height: 2160 })
+    readonly property real mb: 1024 * 1024
+
+    function test_textureScalesWithinBudget() {
+        compare(displays.textureScales([fullHd, fullHd], [0, 1], 256 * mb), [1, 1]);
+    }
+
+    function test_textureScalesLowestPriorityFirst() {
+        // the display being looked at (first in priority) keeps its resolution
+        const scales = displays.textureScales([uhd, uhd, uhd, uhd], [3, 2, 1, 0], 100 * mb);
+        compare(scales[3], 1);
+        verify(scales[0] < 1);
+    }
+
+    function test_textureScalesSharedRow() {
+        // displays 2 and 3 share an atlas row: halving 3 alone saves nothing, so once 2 is
+        // halved, 3 doesn't need to go any lower than it
+        const sizes = [uhd, uhd, uhd, uhd];
+        const scales = displays.textureScales(sizes, [0, 1, 2, 3], 100 * mb);
+        compare(scales, [1, 1, 0.5, 0.5]);
+        verify(displays.atlasBytes(displays.atlasLayout(sizes.map((size, index) => displays.scaledSize(size, scales[index])))) <= 100 * mb);
+    }
+
+    function test_textureScalesFloor() {
+        compare(displays.textureScales([uhd, uhd], [0, 1], 1), [0.125, 0.125]);
+    }
+}
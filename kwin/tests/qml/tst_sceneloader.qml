@@ -0,0 +1,80 @@
+import QtQuick
+import QtTest
+import BreezyDesktopScene
+
+TestCase {
+    name: "SceneLoader"
+    when: windowShown
+    width: 100
+    height: 100
+
+    Component {
+        id: sceneComponent
+        Item {}
+    }
+
+    Component {
+        id: fallbackComponent
+        Item {}
+    }
+
+    Component {
+        id: sceneLoaderComponent
+        SceneLoader {
+            anchors.fill: parent
+            sceneComponent: sceneComponent
+            fallbackComponent: fallbackComponent
+            targetScreenSupported: true
+        }
+    }
+
+    function createPrewarmed() {
+        const loader = createTemporaryObject(sceneLoaderComponent, this, { scenePrewarmed: true });
+        tryCompare(loader, "sceneStatus", Loader.Ready);
+        verify(!loader.sceneShown);
+        return loader;
+    }
+
+    // the order BreezyDesktopEffect uses: enabled first, then the pre-warmed flag is cleared
+    function test_prewarmedSceneSurvivesActivation() {
+        const loader = createPrewarmed();
+        const scene = loader.sceneItem;
+
+        loader.isEnabled = true;
+        loader.scenePrewarmed = false;
+        wait(0);
+
+        compare(loader.sceneItem, scene);
+        verify(loader.sceneShown);
+    }
+
+    // clearing the flag first mustn't unload the scene either
+    function test_prewarmedSceneSurvivesActivationEitherOrder() {
+        const loader = createPrewarmed();
+        const scene = loader.sceneItem;
+
+        loader.scenePrewarmed = false;
+        loader.isEnabled = true;
+        wait(0);
+
+        compare(loader.sceneItem, scene);
+        verify(loader.sceneShown);
+    }
+
+    function test_sceneReleasedWhenUnwanted() {
+        const loader = createPrewarmed();
+
+        loader.scenePrewarmed = false;
+        tryCompare(loader, "sceneStatus", Loader.Null);
+        verify(!loader.sceneShown);
+    }
+
+    function test_sceneHiddenDuringPoseReset() {
+        const loader = createTemporaryObject(sceneLoaderComponent, this, { isEnabled: true, poseResetState: true });
+        tryCompare(loader, "sceneStatus", Loader.Ready);
+        verify(!loader.sceneShown);
+
+        loader.poseResetState = false;
+        verify(loader.sceneShown);
+    }
+}
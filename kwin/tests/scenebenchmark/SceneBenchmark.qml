@@ -0,0 +1,98 @@
+import QtQuick
+import QtQuick3D
+import BreezyDesktopScene
+
+// The View3D main.qml shows once the glasses are enabled, over the mock screens
+View3D {
+    id: view3D
+
+    required property QtObject effect
+    required property var screens
+
+    // every display of the scene has been instantiated
+    readonly property bool displaysReady: breezyDesktop.displaysRevision >= screens.length
+
+    property var viewportResolution: effect.displayResolution
+
+    // x value for placing the viewport in the middle of all screens
+    property real screensXMid: {
+        let xMin = Number.MAX_VALUE;
+        let xMax = -Number.MAX_VALUE;
+
+        for (let i = 0; i < screens.length; i++) {
+            const geometry = screens[i].geometry;
+            xMin = Math.min(xMin, geometry.x);
+            xMax = Math.max(xMax, geometry.x + geometry.width);
+        }
+
+        return (xMin + xMax) / 2 - (viewportResolution[0] / 2);
+    }
+
+    // y value for placing the viewport in the middle of all screens
+    property real screensYMid: {
+        let yMin = Number.MAX_VALUE;
+        let yMax = -Number.MAX_VALUE;
+
+        for (let i = 0; i < screens.length; i++) {
+            const geometry = screens[i].geometry;
+            yMin = Math.min(yMin, geometry.y);
+            yMax = Math.max(yMax, geometry.y + geometry.height);
+        }
+
+        return (yMin + yMax) / 2 - (viewportResolution[1] / 2);
+    }
+
+    Displays {
+        id: displays
+    }
+
+    property var fovDetails: displays.buildFovDetails(
+        screens,
+        viewportResolution[0],
+        viewportResolution[1],
+        effect.diagonalFOV,
+        effect.lensDistanceRatio,
+        effect.allDisplaysDistance,
+        effect.displayWrappingScheme
+    )
+
+    property var monitorPlacements: {
+        const dx = effect.displayHorizontalOffset * viewportResolution[0];
+        const dy = effect.displayVerticalOffset * viewportResolution[1];
+        const adjustedGeometries = screens.map(screen => {
+            const g = screen.geometry;
+            return {
+                x: g.x - screensXMid + dx,
+                y: g.y - screensYMid + dy,
+                width: g.width,
+                height: g.height
+            };
+        });
+        return displays.monitorsToPlacements(fovDetails, adjustedGeometries, effect.displaySpacing);
+    }
+
+    environment: SceneEnvironment {
+        antialiasingMode: view3D.effect.antialiasingQuality === 0 ? SceneEnvironment.NoAA : SceneEnvironment.SSAA
+        antialiasingQuality: view3D.effect.antialiasingQuality === 0 ? SceneEnvironment.Medium : (
+            view3D.effect.antialiasingQuality === 1 ? SceneEnvironment.Medium : (
+            view3D.effect.antialiasingQuality === 2 ? SceneEnvironment.High : SceneEnvironment.VeryHigh))
+    }
+
+    CustomCamera {
+        id: camera
+    }
+
+    BreezyDesktop {
+        id: breezyDesktop
+        screens: view3D.screens
+        fovDetails: view3D.fovDetails
+        monitorPlacements: view3D.monitorPlacements
+    }
+
+    CameraController {
+        id: cameraController
+        anchors.fill: parent
+        camera: camera
+        fovDetails: view3D.fovDetails
+    }
+}
@@ -0,0 +1,17 @@
+import QtQuick
+import org.kde.kwin as KWinComponents
+
+// Stand-in for KWin's WindowThumbnail: a window-sized gradient instead of the window's texture
+Rectangle {
+    property var wId
+    readonly property QtObject window: KWinComponents.Workspace.window(wId)
+
+    width: window ? window.width : 0
+    height: window ? window.height : 0
+    border.color: "#293241"
+    border.width: 4
+    gradient: Gradient {
+        GradientStop { position: 0.0; color: "#3d5a80" }
+        GradientStop { position: 1.0; color: "#e0fbfc" }
+    }
+}
@@ -0,0 +1,127 @@
+#include "mockkwin.h"
+
+#include <QtMath>
+
+namespace KWin
+{
+    MockEffect::MockEffect(QObject *parent)
+        : QObject(parent)
+    {
+    }
+
+    void MockEffect::setCurvedDisplaySupported(bool supported)
+    {
+        m_meshResolved = true;
+        if (m_curvedDisplaySupported == supported) return;
+        m_curvedDisplaySupported = supported;
+        Q_EMIT curvedDisplaySupportedChanged();
+    }
+
+    void MockEffect::setPose(const QQuaternion &t0, const QQuaternion &t1, qreal elapsedMs, quint64 timestampMs)
+    {
+        m_poseOrientations = {t0, t1};
+        m_poseTimeElapsedMs = elapsedMs;
+        m_poseTimestamp = timestampMs;
+    }
+
+    void MockEffect::setCurvedDisplay(bool curved)
+    {
+        m_curvedDisplay = curved;
+        Q_EMIT configChanged();
+    }
+
+    void MockEffect::setAntialiasingQuality(int quality)
+    {
+        m_antialiasingQuality = quality;
+        Q_EMIT configChanged();
+    }
+
+    void MockEffect::reportTextureMemory(qint64 bytes, int downscaledDisplays)
+    {
+        Q_UNUSED(bytes);
+        Q_UNUSED(downscaledDisplays);
+    }
+
+    void MockEffect::recordTextureEvictions(int count)
+    {
+        Q_UNUSED(count);
+    }
+
+    void MockEffect::reportSceneFirstFrame()
+    {
+    }
+
+    MockScreen::MockScreen(const QString &name, const QRect &geometry, QObject *parent)
+        : QObject(parent)
+        , m_name(name)
+        , m_geometry(geometry)
+    {
+    }
+
+    MockWindow::MockWindow(const QRect &geometry, int stackingOrder, QObject *parent)
+        : QObject(parent)
+        , m_geometry(geometry)
+        , m_stackingOrder(stackingOrder)
+    {
+    }
+
+    MockWorkspace *MockWorkspace::self()
+    {
+        static MockWorkspace workspace;
+        return &workspace;
+    }
+
+    void MockWorkspace::setLayout(int count, const QSize &size)
+    {
+        qDeleteAll(m_screens);
+        qDeleteAll(m_windows);
+        m_screens.clear();
+        m_windows.clear();
+
+        // the same virtual display grid the KCM's layouts produce: as square as possible, row by row
+        const int columns = count <= 3 ? count : qCeil(qSqrt(count));
+        int stackingOrder = 0;
+        for (int i = 0; i < count; ++i) {
+            const QRect geometry(QPoint((i % columns) * size.width(), (i / columns) * size.height()), size);
+            m_screens.append(new MockScreen(QStringLiteral("BreezyDesktop-%1").arg(i + 1), geometry, this));
+
+            // a maximized window under two cascaded ones
+            m_windows.append(new MockWindow(geometry, stackingOrder++, this));
+            const QSize windowSize = size * 0.6;
+            for (int w = 1; w <= 2; ++w) {
+                const QPoint offset(size.width() * w / 8, size.height() * w / 8);
+                m_windows.append(new MockWindow(QRect(geometry.topLeft() + offset, windowSize), stackingOrder++, this));
+            }
+        }
+        Q_EMIT screensChanged();
+    }
+
+    QObject *MockWorkspace::window(const QUuid &internalId) const
+    {
+        for (MockWindow *window : m_windows) {
+            if (window->internalId() == internalId) return window;
+        }
+        return nullptr;
+    }
+
+    MockWindowModel::MockWindowModel(QObject *parent)
+        : QAbstractListModel(parent)
+    {
+    }
+
+    int MockWindowModel::rowCount(const QModelIndex &parent) const
+    {
+        return parent.isValid() ? 0 : MockWorkspace::self()->windows().size();
+    }
+
+    QVariant MockWindowModel::data(const QModelIndex &index, int role) const
+    {
+        if (!index.isValid() || role != WindowRole || index.row() >= rowCount()) return QVariant();
+        return QVariant::fromValue<QObject *>(MockWorkspace::self()->windows().at(index.row()));
+    }
+
+    QHash<int, QByteArray> MockWindowModel::roleNames() const
+    {
+        return {{WindowRole, QByteArrayLiteral("window")}};
+    }
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QObject>
+#include <QPointF>
+#include <QQuaternion>
+#include <QRect>
+#include <QSize>
+#include <QStringList>
+#include <QUuid>
+#include <QVariantMap>
+#include <QVector3D>
+
+namespace KWin
+{
+    // Stand-in for BreezyDesktopEffect: the same QML-facing properties, set directly by the
+    // benchmark instead of from the driver's shm file and the kcfg config. The pose
+    // properties have no notify signal, like the effect's, so the scene only sees them
+    // through its FrameAnimation.
+    class MockEffect : public QObject
+    {
+        Q_OBJECT
+        Q_PROPERTY(bool isEnabled MEMBER m_isEnabled CONSTANT)
+        Q_PROPERTY(int effectTargetScreenIndex MEMBER m_effectTargetScreenIndex)
+        Q_PROPERTY(bool zoomOnFocusEnabled MEMBER m_zoomOnFocusEnabled NOTIFY configChanged)
+        Q_PROPERTY(int lookingAtScreenIndex MEMBER m_lookingAtScreenIndex)
+        Q_PROPERTY(bool poseResetState MEMBER m_poseResetState CONSTANT)
+        Q_PROPERTY(QList<QQuaternion> poseOrientations READ poseOrientations)
+        Q_PROPERTY(QVector3D posePosition READ posePosition)
+        Q_PROPERTY(qreal poseTimeElapsedMs READ poseTimeElapsedMs)
+        Q_PROPERTY(quint64 poseTimestamp READ poseTimestamp)
+        Q_PROPERTY(qreal poseAgeMs READ poseAgeMs)
+        Q_PROPERTY(QString cursorImageSource MEMBER m_cursorImageSource CONSTANT)
+        Q_PROPERTY(QSize cursorImageSize MEMBER m_cursorImageSize CONSTANT)
+        Q_PROPERTY(QPointF cursorPos MEMBER m_cursorPos NOTIFY cursorPosChanged)
+        Q_PROPERTY(QList<qreal> lookAheadConfig MEMBER m_lookAheadConfig NOTIFY configChanged)
+        Q_PROPERTY(qreal lookAheadOverride MEMBER m_lookAheadOverride NOTIFY configChanged)
+        Q_PROPERTY(QList<quint32> displayResolution MEMBER m_displayResolution NOTIFY configChanged)
+        Q_PROPERTY(qreal focusedDisplayDistance MEMBER m_focusedDisplayDistance NOTIFY configChanged)
+        Q_PROPERTY(qreal allDisplaysDistance MEMBER m_allDisplaysDistance NOTIFY configChanged)
+        Q_PROPERTY(qreal displaySpacing MEMBER m_displaySpacing NOTIFY configChanged)
+        Q_PROPERTY(qreal displayHorizontalOffset MEMBER m_displayHorizontalOffset NOTIFY configChanged)
+        Q_PROPERTY(qreal displayVerticalOffset MEMBER m_displayVerticalOffset NOTIFY configChanged)
+        Q_PROPERTY(int displayWrappingScheme MEMBER m_displayWrappingScheme NOTIFY configChanged)
+        Q_PROPERTY(qreal diagonalFOV MEMBER m_diagonalFOV NOTIFY configChanged)
+        Q_PROPERTY(qreal lensDistanceRatio MEMBER m_lensDistanceRatio NOTIFY configChanged)
+        Q_PROPERTY(bool sbsEnabled MEMBER m_sbsEnabled NOTIFY configChanged)
+        Q_PROPERTY(bool smoothFollowEnabled MEMBER m_smoothFollowEnabled NOTIFY configChanged)
+        Q_PROPERTY(QList<QQuaternion> smoothFollowOrigin READ smoothFollowOrigin)
+        Q_PROPERTY(bool customBannerEnabled MEMBER m_customBannerEnabled CONSTANT)
+        Q_PROPERTY(int antialiasingQuality MEMBER m_antialiasingQuality NOTIFY configChanged)
+        Q_PROPERTY(bool removeVirtualDisplaysOnDisable MEMBER m_removeVirtualDisplaysOnDisable CONSTANT)
+        Q_PROPERTY(bool mirrorPhysicalDisplays MEMBER m_mirrorPhysicalDisplays CONSTANT)
+        Q_PROPERTY(bool curvedDisplay MEMBER m_curvedDisplay NOTIFY configChanged)
+        Q_PROPERTY(bool curvedDisplaySupported READ curvedDisplaySupported WRITE setCurvedDisplaySupported NOTIFY curvedDisplaySupportedChanged)
+        Q_PROPERTY(int textureMemoryBudgetMB MEMBER m_textureMemoryBudgetMB NOTIFY configChanged)
+        Q_PROPERTY(bool scenePrewarmed MEMBER m_scenePrewarmed CONSTANT)
+        Q_PROPERTY(QVariantMap virtualDisplayRefreshRates MEMBER m_virtualDisplayRefreshRates CONSTANT)
+
+    public:
+        explicit MockEffect(QObject *parent = nullptr);
+
+        QList<QQuaternion> poseOrientations() const { return m_poseOrientations; }
+        QVector3D posePosition() const { return m_posePosition; }
+        qreal poseTimeElapsedMs() const { return m_poseTimeElapsedMs; }
+        quint64 poseTimestamp() const { return m_poseTimestamp; }
+        qreal poseAgeMs() const { return m_poseAgeMs; }
+        QList<QQuaternion> smoothFollowOrigin() const { return m_smoothFollowOrigin; }
+
+        bool curvedDisplaySupported() const { return m_curvedDisplaySupported; }
+        void setCurvedDisplaySupported(bool supported);
+
+        // the scene's mesh has resolved, whichever way (curvedDisplaySupported was written)
+        bool meshResolved() const { return m_meshResolved; }
+
+        // t0 is the latest orientation (EUS), t1 the one elapsedMs before it
+        void setPose(const QQuaternion &t0, const QQuaternion &t1, qreal elapsedMs, quint64 timestampMs);
+
+        void setCurvedDisplay(bool curved);
+        void setAntialiasingQuality(int quality);
+
+        Q_INVOKABLE void reportTextureMemory(qint64 bytes, int downscaledDisplays);
+        Q_INVOKABLE void recordTextureEvictions(int count);
+        Q_INVOKABLE void reportSceneFirstFrame();
+
+    Q_SIGNALS:
+        void configChanged();
+        void cursorPosChanged();
+        void curvedDisplaySupportedChanged();
+
+    private:
+        bool m_isEnabled = true;
+        int m_effectTargetScreenIndex = -1;
+        bool m_zoomOnFocusEnabled = false;
+        int m_lookingAtScreenIndex = -1;
+        bool m_poseResetState = false;
+        QList<QQuaternion> m_poseOrientations = {QQuaternion(), QQuaternion()};
+        QVector3D m_posePosition;
+        qreal m_poseTimeElapsedMs = 0.0;
+        quint64 m_poseTimestamp = 0;
+        qreal m_poseAgeMs = 0.0;
+        QString m_cursorImageSource;
+        QSize m_cursorImageSize = QSize(32, 32);
+        QPointF m_cursorPos = QPointF(-1, -1);
+        QList<qreal> m_lookAheadConfig = {10.0, 1.25, 8.0, 30.0};
+        qreal m_lookAheadOverride = -1.0;
+        QList<quint32> m_displayResolution = {1920, 1080};
+        qreal m_focusedDisplayDistance = 0.85;
+        qreal m_allDisplaysDistance = 1.05;
+        qreal m_displaySpacing = 0.0;
+        qreal m_displayHorizontalOffset = 0.0;
+        qreal m_displayVerticalOffset = 0.0;
+        int m_displayWrappingScheme = 0;
+        qreal m_diagonalFOV = 46.0;
+        qreal m_lensDistanceRatio = 0.035;
+        bool m_sbsEnabled = false;
+        bool m_smoothFollowEnabled = false;
+        QList<QQuaternion> m_smoothFollowOrigin = {QQuaternion(), QQuaternion()};
+        bool m_customBannerEnabled = false;
+        int m_antialiasingQuality = 0;
+        bool m_removeVirtualDisplaysOnDisable = false;
+        bool m_mirrorPhysicalDisplays = false;
+        bool m_curvedDisplay = false;
+        bool m_curvedDisplaySupported = false;
+        bool m_meshResolved = false;
+        int m_textureMemoryBudgetMB = 256;
+        bool m_scenePrewarmed = false;
+        QVariantMap m_virtualDisplayRefreshRates;
+    };
+
+    // Stand-in for KWin's Output as the scene sees it
+    class MockScreen : public QObject
+    {
+        Q_OBJECT
+        Q_PROPERTY(QString name MEMBER m_name CONSTANT)
+        Q_PROPERTY(QString model MEMBER m_model CONSTANT)
+        Q_PROPERTY(QRect geometry MEMBER m_geometry CONSTANT)
+
+    public:
+        MockScreen(const QString &name, const QRect &geometry, QObject *parent = nullptr);
+
+    private:
+        QString m_name;
+        QString m_model = QStringLiteral("Air");
+        QRect m_geometry;
+    };
+
+    // Stand-in for KWin's Window as DesktopView reads it
+    class MockWindow : public QObject
+    {
+        Q_OBJECT
+        Q_PROPERTY(QUuid internalId MEMBER m_internalId CONSTANT)
+        Q_PROPERTY(qreal x READ x CONSTANT)
+        Q_PROPERTY(qreal y READ y CONSTANT)
+        Q_PROPERTY(qreal width READ width CONSTANT)
+        Q_PROPERTY(qreal height READ height CONSTANT)
+        Q_PROPERTY(int stackingOrder MEMBER m_stackingOrder CONSTANT)
+        Q_PROPERTY(bool minimized MEMBER m_minimized CONSTANT)
+        Q_PROPERTY(bool onAllDesktops MEMBER m_onAllDesktops CONSTANT)
+        Q_PROPERTY(QVariantList desktops MEMBER m_desktops CONSTANT)
+        Q_PROPERTY(QStringList activities MEMBER m_activities CONSTANT)
+
+    public:
+        MockWindow(const QRect &geometry, int stackingOrder, QObject *parent = nullptr);
+
+        QUuid internalId() const { return m_internalId; }
+        qreal x() const { return m_geometry.x(); }
+        qreal y() const { return m_geometry.y(); }
+        qreal width() const { return m_geometry.width(); }
+        qreal height() const { return m_geometry.height(); }
+
+    private:
+        QUuid m_internalId = QUuid::createUuid();
+        QRect m_geometry;
+        int m_stackingOrder;
+        bool m_minimized = false;
+        bool m_onAllDesktops = true;
+        QVariantList m_desktops;
+        QStringList m_activities;
+    };
+
+    // Stand-in for the org.kde.kwin Workspace singleton: the screens and their windows
+    class MockWorkspace : public QObject
+    {
+        Q_OBJECT
+        Q_PROPERTY(QList<QObject *> screens READ screens NOTIFY screensChanged)
+        Q_PROPERTY(QString currentActivity MEMBER m_currentActivity CONSTANT)
+        Q_PROPERTY(QVariant currentDesktop MEMBER m_currentDesktop CONSTANT)
+
+    public:
+        static MockWorkspace *self();
+
+        QList<QObject *> screens() const { return m_screens; }
+        const QList<MockWindow *> &windows() const { return m_windows; }
+
+        // count screens of size each in a grid, with a few windows on each
+        void setLayout(int count, const QSize &size);
+
+        Q_INVOKABLE QObject *window(const QUuid &internalId) const;
+
+    Q_SIGNALS:
+        void screensChanged();
+
+    private:
+        QList<QObject *> m_screens;
+        QList<MockWindow *> m_windows;
+        QString m_currentActivity;
+        QVariant m_currentDesktop;
+    };
+
+    // Stand-in for org.kde.kwin's WindowModel: every window of the workspace, role "window"
+    class MockWindowModel : public QAbstractListModel
+    {
+        Q_OBJECT
+
+    public:
+        explicit MockWindowModel(QObject *parent = nullptr);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role) const override;
+        QHash<int, QByteArray> roleNames() const override;
+
+    private:
+        enum Roles {
+            WindowRole = Qt::UserRole + 1,
+        };
+    };
+}
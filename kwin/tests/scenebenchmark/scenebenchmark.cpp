@@ -0,0 +1,341 @@
+// Offscreen benchmark of the effect's Qt Quick 3D scene
+//
+// Loads BreezyDesktop.qml and CameraController.qml (and through them Displays.qml,
+// DisplayInstances.qml and CurvableDisplayMesh.qml) from the compiled scene module into a
+// QQuickRenderControl window that renders into an offscreen QRhi texture. A mock effect
+// is fed from a pose trace, and org.kde.kwin's Workspace, WindowModel and WindowThumbnail
+// are mocked, so no KWin session is needed. Frames are stepped on a fixed 60Hz animation
+// clock and each one is timed in three phases:
+//
+//   js      events, animations (the FrameAnimation camera update), bindings and polish
+//   sync    scene graph synchronization, where Qt Quick 3D prepares the scene
+//   render  rendering the frame, up to its completion
+//
+// for each display count in --displays (default 1-9), printing p50/p99 per phase:
+//
+//   QT_QPA_PLATFORM=offscreen QSG_RHI_BACKEND=opengl LIBGL_ALWAYS_SOFTWARE=1 ./breezy_scene_benchmark
+//
+// Exits 77 if no QRhi can be created (no GL at all), for ctest to report a skip.
+
+#include "mockkwin.h"
+
+#include <QAnimationDriver>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQmlIncubationController>
+#include <QQuickItem>
+#include <QQuickRenderControl>
+#include <QQuickRenderTarget>
+#include <QQuickWindow>
+#include <QTextStream>
+#include <rhi/qrhi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace KWin;
+
+namespace
+{
+    constexpr qreal FRAME_MS = 1000.0 / 60.0;
+    constexpr int SKIP_EXIT_CODE = 77;
+    constexpr qint64 READY_TIMEOUT_MS = 30000;
+
+    // Drives Qt's animation timer from the benchmark instead of the wall clock
+    class SteppedAnimationDriver : public QAnimationDriver
+    {
+    public:
+        // Animations see whole milliseconds, so the fractional part is carried between steps
+        void step(qreal ms)
+        {
+            m_elapsed += ms;
+            advance();
+        }
+
+        qint64 elapsed() const override
+        {
+            return qRound64(m_elapsed);
+        }
+
+    private:
+        qreal m_elapsed = 0;
+    };
+
+    // Runs the scene's asynchronous incubation (the display Repeater3D, the curved mesh) between frames
+    class FrameIncubationController : public QQmlIncubationController
+    {
+    public:
+        void incubate()
+        {
+            if (incubatingObjectCount() > 0) incubateFor(10);
+        }
+    };
+
+    // NWU orientations at their sample times, as the driver writes them
+    class PoseTrace
+    {
+    public:
+        bool load(const QString &path)
+        {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+            QTextStream stream(&file);
+            while (!stream.atEnd()) {
+                const QString line = stream.readLine().trimmed();
+                if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) continue;
+
+                const QStringList fields = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+                if (fields.size() != 5) continue;
+                m_samples.push_back({fields[0].toDouble(),
+                                     QQuaternion(fields[4].toFloat(), fields[1].toFloat(), fields[2].toFloat(), fields[3].toFloat())});
+            }
+            return m_samples.size() >= 3;
+        }
+
+        // Sets the effect's pose to the latest sample at timeMs into the trace, looping
+        void apply(MockEffect &effect, qreal timeMs) const
+        {
+            const qreal duration = m_samples.back().timeMs - m_samples.front().timeMs;
+            const qreal traceTime = m_samples.front().timeMs + std::fmod(timeMs, duration);
+            auto it = std::upper_bound(m_samples.begin() + 2, m_samples.end(), traceTime,
+                                       [](qreal time, const Sample &sample) { return time < sample.timeMs; });
+            const Sample &t0 = *(it - 1);
+            const Sample &t1 = *(it - 2);
+            effect.setPose(toEus(t0.orientation), toEus(t1.orientation), t0.timeMs - t1.timeMs, static_cast<quint64>(timeMs));
+        }
+
+    private:
+        struct Sample {
+            qreal timeMs;
+            QQuaternion orientation;
+        };
+
+        // convert NWU to EUS by passing orientation values: -y, z, -x
+        static QQuaternion toEus(const QQuaternion &nwu)
+        {
+            return QQuaternion(nwu.scalar(), -nwu.y(), nwu.z(), -nwu.x());
+        }
+
+        std::vector<Sample> m_samples;
+    };
+
+    struct PhaseTimes {
+        std::vector<qint64> js;
+        std::vector<qint64> sync;
+        std::vector<qint64> render;
+    };
+
+    double percentileMs(std::vector<qint64> values, double percentile)
+    {
+        if (values.empty()) return 0.0;
+        std::sort(values.begin(), values.end());
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+        return values[index] / 1e6;
+    }
+
+    struct BenchmarkOptions {
+        int frames;
+        int warmup;
+        QSize size;
+        QSize screenSize;
+        bool curved;
+        int antialiasing;
+    };
+
+    enum class RunResult {
+        Ok,
+        Failed,
+        Skipped,
+    };
+
+    // Builds the scene for displayCount screens and times frames of it
+    RunResult runScene(int displayCount, const BenchmarkOptions &options, const PoseTrace &trace,
+                       SteppedAnimationDriver &driver, PhaseTimes &times)
+    {
+        MockWorkspace::self()->setLayout(displayCount, options.screenSize);
+
+        MockEffect effect;
+        effect.setCurvedDisplay(options.curved);
+        effect.setAntialiasingQuality(options.antialiasing);
+        trace.apply(effect, 0);
+
+        QQuickRenderControl renderControl;
+        QQuickWindow window(&renderControl);
+        window.resize(options.size);
+        if (!renderControl.initialize()) {
+            fprintf(stderr, "Failed to initialize QQuickRenderControl, no QRhi available\n");
+            return RunResult::Skipped;
+        }
+
+        QRhi *rhi = renderControl.rhi();
+        std::unique_ptr<QRhiTexture> texture(rhi->newTexture(QRhiTexture::RGBA8, options.size, 1, QRhiTexture::RenderTarget));
+        std::unique_ptr<QRhiRenderBuffer> depthStencil(rhi->newRenderBuffer(QRhiRenderBuffer::DepthStencil, options.size, 1));
+        std::unique_ptr<QRhiTextureRenderTarget> renderTarget(rhi->newTextureRenderTarget({QRhiColorAttachment(texture.get()), depthStencil.get()}));
+        std::unique_ptr<QRhiRenderPassDescriptor> renderPass(renderTarget->newCompatibleRenderPassDescriptor());
+        renderTarget->setRenderPassDescriptor(renderPass.get());
+        if (!texture->create() || !depthStencil->create() || !renderTarget->create()) {
+            fprintf(stderr, "Failed to create the offscreen render target\n");
+            return RunResult::Failed;
+        }
+        window.setRenderTarget(QQuickRenderTarget::fromRhiRenderTarget(renderTarget.get()));
+
+        FrameIncubationController incubation;
+        QQmlEngine engine;
+        engine.setIncubationController(&incubation);
+        engine.addImportPath(QStringLiteral("qrc:/"));
+
+        QQmlComponent component(&engine, QUrl(QStringLiteral("qrc:/scenebenchmark/SceneBenchmark.qml")));
+        QVariantList screens;
+        for (QObject *screen : MockWorkspace::self()->screens()) {
+            screens.append(QVariant::fromValue(screen));
+        }
+        std::unique_ptr<QObject> root(component.createWithInitialProperties({
+            {QStringLiteral("effect"), QVariant::fromValue<QObject *>(&effect)},
+            {QStringLiteral("screens"), screens},
+        }));
+        auto rootItem = qobject_cast<QQuickItem *>(root.get());
+        if (!rootItem) {
+            fprintf(stderr, "Failed to create the scene: %s\n", qPrintable(component.errorString()));
+            return RunResult::Failed;
+        }
+        rootItem->setParentItem(window.contentItem());
+        rootItem->setSize(options.size);
+
+        qreal timeMs = 0;
+        auto frame = [&](PhaseTimes *record) {
+            trace.apply(effect, timeMs);
+            timeMs += FRAME_MS;
+            incubation.incubate();
+
+            QElapsedTimer timer;
+            timer.start();
+            QCoreApplication::processEvents();
+            driver.step(FRAME_MS);
+            renderControl.polishItems();
+            const qint64 jsNs = timer.nsecsElapsed();
+
+            renderControl.beginFrame();
+            renderControl.sync();
+            const qint64 syncNs = timer.nsecsElapsed();
+
+            // endFrame submits the frame and, offscreen, waits for it to complete
+            renderControl.render();
+            renderControl.endFrame();
+            const qint64 renderNs = timer.nsecsElapsed();
+
+            if (record) {
+                record->js.push_back(jsNs);
+                record->sync.push_back(syncNs - jsNs);
+                record->render.push_back(renderNs - syncNs);
+            }
+        };
+
+        // all displays in place and the mesh resolved, curved or flat
+        QElapsedTimer readyTimer;
+        readyTimer.start();
+        while (!rootItem->property("displaysReady").toBool() || !effect.meshResolved()) {
+            if (readyTimer.elapsed() > READY_TIMEOUT_MS) {
+                fprintf(stderr, "Scene with %d displays wasn't ready after %lldms\n", displayCount, READY_TIMEOUT_MS);
+                return RunResult::Failed;
+            }
+            frame(nullptr);
+        }
+
+        for (int i = 0; i < options.warmup; ++i) {
+            frame(nullptr);
+        }
+        for (int i = 0; i < options.frames; ++i) {
+            frame(&times);
+        }
+
+        root.reset();
+        return RunResult::Ok;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("breezy_scene_benchmark"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Times the Breezy Desktop scene's frames offscreen"));
+    parser.addHelpOption();
+    QCommandLineOption traceOption(QStringLiteral("trace"), QStringLiteral("Pose trace (time_ms x y z w, NWU)."), QStringLiteral("file"),
+                                   QStringLiteral(":/scenebenchmark/pose_trace.txt"));
+    QCommandLineOption framesOption(QStringLiteral("frames"), QStringLiteral("Timed frames per display count."), QStringLiteral("n"), QStringLiteral("240"));
+    QCommandLineOption warmupOption(QStringLiteral("warmup"), QStringLiteral("Untimed frames before timing."), QStringLiteral("n"), QStringLiteral("60"));
+    QCommandLineOption displaysOption(QStringLiteral("displays"), QStringLiteral("Display counts to run, e.g. 1,2,4 (default 1-9)."), QStringLiteral("counts"));
+    QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("Output size, WxH."), QStringLiteral("size"), QStringLiteral("1920x1080"));
+    QCommandLineOption curvedOption(QStringLiteral("curved"), QStringLiteral("Use curved displays."));
+    QCommandLineOption antialiasingOption(QStringLiteral("antialiasing"), QStringLiteral("Antialiasing quality, 0 (off) to 3."), QStringLiteral("quality"),
+                                          QStringLiteral("0"));
+    parser.addOptions({traceOption, framesOption, warmupOption, displaysOption, sizeOption, curvedOption, antialiasingOption});
+    parser.process(app);
+
+    BenchmarkOptions options;
+    options.frames = parser.value(framesOption).toInt();
+    options.warmup = parser.value(warmupOption).toInt();
+    options.curved = parser.isSet(curvedOption);
+    options.antialiasing = qBound(0, parser.value(antialiasingOption).toInt(), 3);
+    const QStringList sizeFields = parser.value(sizeOption).split(QLatin1Char('x'));
+    options.size = sizeFields.size() == 2 ? QSize(sizeFields[0].toInt(), sizeFields[1].toInt()) : QSize();
+    options.screenSize = QSize(1920, 1080);
+    if (options.frames <= 0 || options.warmup < 0 || options.size.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QList<int> displayCounts;
+    if (parser.isSet(displaysOption)) {
+        for (const QString &count : parser.value(displaysOption).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+            displayCounts.append(count.toInt());
+        }
+    } else {
+        displayCounts = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    }
+    if (std::any_of(displayCounts.begin(), displayCounts.end(), [](int count) { return count < 1; })) {
+        parser.showHelp(1);
+    }
+
+    PoseTrace trace;
+    if (!trace.load(parser.value(traceOption))) {
+        fprintf(stderr, "Failed to load pose trace %s\n", qPrintable(parser.value(traceOption)));
+        return 1;
+    }
+
+    qmlRegisterType<MockWindowModel>("org.kde.kwin", 3, 0, "WindowModel");
+    qmlRegisterType(QUrl(QStringLiteral("qrc:/scenebenchmark/WindowThumbnail.qml")), "org.kde.kwin", 3, 0, "WindowThumbnail");
+    qmlRegisterSingletonInstance("org.kde.kwin", 3, 0, "Workspace", MockWorkspace::self());
+
+    SteppedAnimationDriver driver;
+    driver.install();
+
+    printf("%d timed frames per run, %dx%d output, %s displays, antialiasing %d\n", options.frames, options.size.width(),
+           options.size.height(), options.curved ? "curved" : "flat", options.antialiasing);
+    printf("%-8s %10s %10s %10s %10s %10s %10s\n", "displays", "js p50", "js p99", "sync p50", "sync p99", "render p50", "render p99");
+    for (int count : displayCounts) {
+        PhaseTimes times;
+        switch (runScene(count, options, trace, driver, times)) {
+        case RunResult::Skipped:
+            return SKIP_EXIT_CODE;
+        case RunResult::Failed:
+            return 1;
+        case RunResult::Ok:
+            break;
+        }
+        printf("%-8d %8.2fms %8.2fms %8.2fms %8.2fms %8.2fms %8.2fms\n", count,
+               percentileMs(times.js, 0.5), percentileMs(times.js, 0.99),
+               percentileMs(times.sync, 0.5), percentileMs(times.sync, 0.99),
+               percentileMs(times.render, 0.5), percentileMs(times.render, 0.99));
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,410 @@
+/*
+ * Allocation trace preload library
+ *
+ * LD_PRELOAD=libbreezy_alloc_trace.so interposes malloc and friends and counts the
+ * allocations made inside the scopes marked with breezy_alloc_trace.h. A frame of a
+ * scope past its warm-up that allocates at all is a steady-state allocation; its
+ * call stacks are collected and printed in the report at exit:
+ *
+ *   [AllocTrace] pose_update: 3600 frames, 3480 steady, 0 allocating
+ *   [AllocTrace] render_frame: 3600 frames, 3480 steady, 58 allocating (116 allocations)
+ *   [AllocTrace] site 1: 58 allocations in render_frame
+ *   ./breezy_x11_renderer(read_device_config+0x51)[0x...]
+ *
+ * Nothing here may allocate while counting, so the bookkeeping uses fixed tables,
+ * the report is formatted with snprintf into a stack buffer and symbolized with
+ * backtrace_symbols_fd, and allocations made while dlsym resolves the real
+ * allocator come from a static arena.
+ *
+ * Allocations with one of the BREEZY_ALLOC_TRACE_IGNORE objects on the stack (e.g. the
+ * GL driver, which may allocate per draw or fence) are counted apart and don't fail
+ * a frame; only the scope's own code is held to zero.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <link.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SCOPES 16
+#define MAX_SITES 64
+#define SITE_DEPTH 6
+#define SITE_SKIP 2  /* note_allocation, the interposed function */
+#define IGNORE_DEPTH 32
+#define MAX_IGNORED_OBJECTS 16
+#define DEFAULT_WARMUP_FRAMES 120
+#define STRICT_EXIT_CODE 3
+#define BOOTSTRAP_ARENA_SIZE 16384
+
+typedef struct {
+    const char *name;
+    uint64_t frames;
+    uint64_t steady_frames;
+    uint64_t allocating_frames;
+    uint64_t allocations;
+    uint64_t ignored_allocations;
+} ScopeStats;
+
+typedef struct {
+    void *frames[SITE_DEPTH];
+    int depth;
+    const ScopeStats *scope;
+    uint64_t count;
+} AllocSite;
+
+static void *(*real_malloc)(size_t);
+static void *(*real_calloc)(size_t, size_t);
+static void *(*real_realloc)(void *, size_t);
+static void (*real_free)(void *);
+static int (*real_posix_memalign)(void **, size_t, size_t);
+static void *(*real_aligned_alloc)(size_t, size_t);
+static void *(*real_memalign)(size_t, size_t);
+
+static _Alignas(16) unsigned char bootstrap_arena[BOOTSTRAP_ARENA_SIZE];
+static size_t bootstrap_used;
+static bool resolving;
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static ScopeStats scopes[MAX_SCOPES];
+static int scope_count;
+static AllocSite sites[MAX_SITES];
+static int site_count;
+static uint64_t dropped_sites;
+static uint64_t warmup_frames = DEFAULT_WARMUP_FRAMES;
+static char ignored_object_names[512];
+static const char *ignored_objects[MAX_IGNORED_OBJECTS];
+static int ignored_object_count;
+
+static __thread ScopeStats *tls_scope;
+static __thread int tls_scope_depth;
+static __thread bool tls_scope_steady;
+static __thread uint64_t tls_scope_allocations;
+static __thread uint64_t tls_scope_ignored_allocations;
+static __thread bool tls_in_hook;
+
+static void resolve_real_allocator(void) {
+    if (real_malloc || resolving) {
+        return;
+    }
+    resolving = true;
+    real_calloc = dlsym(RTLD_NEXT, "calloc");
+    real_malloc = dlsym(RTLD_NEXT, "malloc");
+    real_realloc = dlsym(RTLD_NEXT, "realloc");
+    real_free = dlsym(RTLD_NEXT, "free");
+    real_posix_memalign = dlsym(RTLD_NEXT, "posix_memalign");
+    real_aligned_alloc = dlsym(RTLD_NEXT, "aligned_alloc");
+    real_memalign = dlsym(RTLD_NEXT, "memalign");
+    resolving = false;
+}
+
+static void *bootstrap_alloc(size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    if (bootstrap_used + size > sizeof(bootstrap_arena)) {
+        return NULL;
+    }
+    void *ptr = bootstrap_arena + bootstrap_used;
+    bootstrap_used += size;
+    return ptr;
+}
+
+static bool is_bootstrap(const void *ptr) {
+    return (const unsigned char *)ptr >= bootstrap_arena &&
+           (const unsigned char *)ptr < bootstrap_arena + sizeof(bootstrap_arena);
+}
+
+static void record_site(void *const *frames, int depth) {
+    for (int i = 0; i < site_count; i++) {
+        if (sites[i].scope == tls_scope && sites[i].depth == depth &&
+            memcmp(sites[i].frames, frames, (size_t)depth * sizeof(void *)) == 0) {
+            sites[i].count++;
+            return;
+        }
+    }
+    if (site_count == MAX_SITES) {
+        dropped_sites++;
+        return;
+    }
+    AllocSite *site = &sites[site_count++];
+    memcpy(site->frames, frames, (size_t)depth * sizeof(void *));
+    site->depth = depth;
+    site->scope = tls_scope;
+    site->count = 1;
+}
+
+typedef struct {
+    uintptr_t address;
+    bool ignored;
+} ObjectLookup;
+
+static int match_ignored_object(struct dl_phdr_info *info, size_t size, void *data) {
+    (void)size;
+    ObjectLookup *lookup = data;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+        uintptr_t start = info->dlpi_addr + phdr->p_vaddr;
+        if (phdr->p_type != PT_LOAD || lookup->address < start || lookup->address >= start + phdr->p_memsz) {
+            continue;
+        }
+        for (int j = 0; j < ignored_object_count; j++) {
+            if (info->dlpi_name && strstr(info->dlpi_name, ignored_objects[j])) {
+                lookup->ignored = true;
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// dl_iterate_phdr rather than dladdr: it also finds objects without a usable dynamic symbol table
+static bool in_ignored_object(void *const *frames, int depth) {
+    for (int i = 0; i < depth; i++) {
+        ObjectLookup lookup = { .address = (uintptr_t)frames[i], .ignored = false };
+        dl_iterate_phdr(match_ignored_object, &lookup);
+        if (lookup.ignored) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called directly from each interposed function, so the caller is always SITE_SKIP frames up
+__attribute__((noinline)) static void note_allocation(void) {
+    if (!tls_scope || tls_in_hook || !tls_scope_steady) {
+        return;
+    }
+
+    tls_in_hook = true;
+    void *frames[IGNORE_DEPTH];
+    int depth = backtrace(frames, IGNORE_DEPTH) - SITE_SKIP;
+    if (ignored_object_count && in_ignored_object(frames + SITE_SKIP, depth)) {
+        tls_scope_ignored_allocations++;
+    } else {
+        tls_scope_allocations++;
+        if (depth > 0) {
+            pthread_mutex_lock(&stats_lock);
+            record_site(frames + SITE_SKIP, depth < SITE_DEPTH ? depth : SITE_DEPTH);
+            pthread_mutex_unlock(&stats_lock);
+        }
+    }
+    tls_in_hook = false;
+}
+
+void *malloc(size_t size) {
+    resolve_real_allocator();
+    if (!real_malloc) {
+        return bootstrap_alloc(size);
+    }
+    note_allocation();
+    return real_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    resolve_real_allocator();
+    if (!real_calloc) {
+        // the arena is static storage, already zeroed
+        return size && count > SIZE_MAX / size ? NULL : bootstrap_alloc(count * size);
+    }
+    note_allocation();
+    return real_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    resolve_real_allocator();
+    if (is_bootstrap(ptr) || !real_realloc) {
+        void *moved = malloc(size);
+        if (moved && ptr) {
+            size_t available = (size_t)(bootstrap_arena + sizeof(bootstrap_arena) - (unsigned char *)ptr);
+            memcpy(moved, ptr, size < available ? size : available);
+        }
+        return moved;
+    }
+    note_allocation();
+    return real_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    if (!ptr || is_bootstrap(ptr)) {
+        return;
+    }
+    resolve_real_allocator();
+    if (real_free) {
+        real_free(ptr);
+    }
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    resolve_real_allocator();
+    note_allocation();
+    return real_posix_memalign(ptr, alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    resolve_real_allocator();
+    note_allocation();
+    return real_aligned_alloc(alignment, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    resolve_real_allocator();
+    note_allocation();
+    return real_memalign(alignment, size);
+}
+
+static ScopeStats *find_scope(const char *name) {
+    for (int i = 0; i < scope_count; i++) {
+        if (scopes[i].name == name || strcmp(scopes[i].name, name) == 0) {
+            return &scopes[i];
+        }
+    }
+    if (scope_count == MAX_SCOPES) {
+        return NULL;
+    }
+    scopes[scope_count].name = name;
+    return &scopes[scope_count++];
+}
+
+void breezy_alloc_scope_begin(const char *name) {
+    if (tls_scope_depth++ > 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&stats_lock);
+    ScopeStats *scope = find_scope(name);
+    bool steady = scope && scope->frames >= warmup_frames;
+    pthread_mutex_unlock(&stats_lock);
+
+    tls_scope_allocations = 0;
+    tls_scope_ignored_allocations = 0;
+    tls_scope_steady = steady;
+    tls_scope = scope;
+}
+
+void breezy_alloc_scope_end(void) {
+    if (tls_scope_depth == 0 || --tls_scope_depth > 0) {
+        return;
+    }
+
+    ScopeStats *scope = tls_scope;
+    tls_scope = NULL;
+    if (!scope) {
+        return;
+    }
+
+    pthread_mutex_lock(&stats_lock);
+    scope->frames++;
+    if (tls_scope_steady) {
+        scope->steady_frames++;
+        scope->ignored_allocations += tls_scope_ignored_allocations;
+        if (tls_scope_allocations > 0) {
+            scope->allocating_frames++;
+            scope->allocations += tls_scope_allocations;
+        }
+    }
+    pthread_mutex_unlock(&stats_lock);
+}
+
+static void report_line(int fd, const char *format, ...) __attribute__((format(printf, 2, 3)));
+static void report_line(int fd, const char *format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length > 0) {
+        ssize_t ignored = write(fd, line, (size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1);
+        (void)ignored;
+    }
+}
+
+__attribute__((constructor)) static void alloc_trace_init(void) {
+    resolve_real_allocator();
+
+    const char *warmup = getenv("BREEZY_ALLOC_TRACE_WARMUP");
+    if (warmup && warmup[0]) {
+        warmup_frames = strtoull(warmup, NULL, 10);
+    }
+
+    // colon-separated substrings of object paths, like "_dri.so:libgallium:libLLVM"
+    const char *ignore = getenv("BREEZY_ALLOC_TRACE_IGNORE");
+    if (ignore && ignore[0]) {
+        strncpy(ignored_object_names, ignore, sizeof(ignored_object_names) - 1);
+        char *save = NULL;
+        for (char *name = strtok_r(ignored_object_names, ":", &save);
+             name && ignored_object_count < MAX_IGNORED_OBJECTS;
+             name = strtok_r(NULL, ":", &save)) {
+            ignored_objects[ignored_object_count++] = name;
+        }
+    }
+
+    // backtrace loads the unwinder (and allocates) on first use; get that out of the way
+    tls_in_hook = true;
+    void *frames[2];
+    backtrace(frames, 2);
+    tls_in_hook = false;
+}
+
+__attribute__((destructor)) static void alloc_trace_report(void) {
+    const char *report_path = getenv("BREEZY_ALLOC_TRACE_REPORT");
+    int fd = STDERR_FILENO;
+    if (report_path && report_path[0]) {
+        int report_fd = open(report_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (report_fd >= 0) {
+            fd = report_fd;
+        }
+    }
+
+    pthread_mutex_lock(&stats_lock);
+    uint64_t allocating_frames = 0;
+    for (int i = 0; i < scope_count; i++) {
+        const ScopeStats *scope = &scopes[i];
+        allocating_frames += scope->allocating_frames;
+        if (scope->allocating_frames) {
+            report_line(fd, "[AllocTrace] %s: %llu frames, %llu steady, %llu allocating (%llu allocations)\n",
+                        scope->name, (unsigned long long)scope->frames,
+                        (unsigned long long)scope->steady_frames,
+                        (unsigned long long)scope->allocating_frames,
+                        (unsigned long long)scope->allocations);
+        } else {
+            report_line(fd, "[AllocTrace] %s: %llu frames, %llu steady, 0 allocating\n",
+                        scope->name, (unsigned long long)scope->frames,
+                        (unsigned long long)scope->steady_frames);
+        }
+        if (scope->ignored_allocations) {
+            report_line(fd, "[AllocTrace] %s: %llu steady-state allocations in ignored objects\n",
+                        scope->name, (unsigned long long)scope->ignored_allocations);
+        }
+        if (scope->steady_frames == 0) {
+            report_line(fd, "[AllocTrace] %s: no frames past the %llu frame warm-up\n",
+                        scope->name, (unsigned long long)warmup_frames);
+        }
+    }
+
+    for (int i = 0; i < site_count; i++) {
+        report_line(fd, "[AllocTrace] site %d: %llu allocations in %s\n",
+                    i + 1, (unsigned long long)sites[i].count, sites[i].scope->name);
+        backtrace_symbols_fd(sites[i].frames, sites[i].depth, fd);
+    }
+    if (dropped_sites) {
+        report_line(fd, "[AllocTrace] %llu allocations from sites past the first %d not shown\n",
+                    (unsigned long long)dropped_sites, MAX_SITES);
+    }
+    pthread_mutex_unlock(&stats_lock);
+
+    if (fd != STDERR_FILENO) {
+        close(fd);
+    }
+
+    const char *strict = getenv("BREEZY_ALLOC_TRACE_STRICT");
+    if (allocating_frames && strict && strcmp(strict, "0") != 0) {
+        _exit(STRICT_EXIT_CODE);
+    }
+}
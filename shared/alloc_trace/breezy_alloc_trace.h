@@ -0,0 +1,58 @@
+/*
+ * Allocation trace scope markers
+ *
+ * Marks the per-frame paths (render loop, pose update) that must not touch the heap
+ * once warmed up. In builds with BREEZY_ALLOC_TRACE defined, the markers call into
+ * libbreezy_alloc_trace.so when it is LD_PRELOADed; the symbols are weak, so the same
+ * binary runs normally without it. Without BREEZY_ALLOC_TRACE the markers compile away.
+ *
+ * Scopes are per thread and don't nest: a begin inside an open scope is folded into
+ * the outer one. Each begin/end pair counts as one frame of the named scope.
+ *
+ * Runtime environment (read by the preload library):
+ *   BREEZY_ALLOC_TRACE_WARMUP  frames per scope allowed to allocate (default 120)
+ *   BREEZY_ALLOC_TRACE_STRICT  exit with status 3 if a steady-state frame allocated
+ *   BREEZY_ALLOC_TRACE_REPORT  write the report to this file instead of stderr
+ *   BREEZY_ALLOC_TRACE_IGNORE  colon-separated object names (substrings) whose allocations,
+ *                              e.g. the GL driver's, are reported but not counted
+ */
+
+#ifndef BREEZY_ALLOC_TRACE_H
+#define BREEZY_ALLOC_TRACE_H
+
+#ifdef BREEZY_ALLOC_TRACE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void breezy_alloc_scope_begin(const char *name) __attribute__((weak));
+void breezy_alloc_scope_end(void) __attribute__((weak));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define BREEZY_ALLOC_SCOPE_BEGIN(name) \
+    do { if (breezy_alloc_scope_begin) breezy_alloc_scope_begin(name); } while (0)
+#define BREEZY_ALLOC_SCOPE_END() \
+    do { if (breezy_alloc_scope_end) breezy_alloc_scope_end(); } while (0)
+
+#else
+
+#define BREEZY_ALLOC_SCOPE_BEGIN(name) do { (void)(name); } while (0)
+#define BREEZY_ALLOC_SCOPE_END() do { } while (0)
+
+#endif /* BREEZY_ALLOC_TRACE */
+
+#ifdef __cplusplus
+// Scope for functions with several return paths
+struct BreezyAllocScope {
+    explicit BreezyAllocScope(const char *name) { BREEZY_ALLOC_SCOPE_BEGIN(name); }
+    ~BreezyAllocScope() { BREEZY_ALLOC_SCOPE_END(); }
+    BreezyAllocScope(const BreezyAllocScope &) = delete;
+    BreezyAllocScope &operator=(const BreezyAllocScope &) = delete;
+};
+#endif
+
+#endif /* BREEZY_ALLOC_TRACE_H */
@@ -0,0 +1,45 @@
+/*
+ * Allocation trace self-test
+ *
+ * Runs a marked "frame" scope 300 times under the preload library. In "steady" mode
+ * frames only allocate during warm-up and the strict run must pass; in "allocating"
+ * mode every 50th frame allocates and the strict run must fail.
+ */
+
+#include "breezy_alloc_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FRAMES 300
+
+// keeps the compiler from pairing up and eliding malloc/free
+static void *volatile sink;
+
+static void allocate_in_frame(void) {
+    sink = malloc(64);
+    free(sink);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2 || (strcmp(argv[1], "steady") != 0 && strcmp(argv[1], "allocating") != 0)) {
+        fprintf(stderr, "Usage: %s steady|allocating\n", argv[0]);
+        return 2;
+    }
+    const int allocating = strcmp(argv[1], "allocating") == 0;
+
+    float accumulator = 0.0f;
+    for (int frame = 0; frame < TEST_FRAMES; frame++) {
+        BREEZY_ALLOC_SCOPE_BEGIN("frame");
+        if (frame < 10 || (allocating && frame % 50 == 0)) {
+            allocate_in_frame();
+        }
+        for (int i = 0; i < 1000; i++) {
+            accumulator += (float)i * 0.5f;
+        }
+        BREEZY_ALLOC_SCOPE_END();
+    }
+
+    printf("%s: %d frames (%.0f)\n", argv[1], TEST_FRAMES, accumulator);
+    return 0;
+}
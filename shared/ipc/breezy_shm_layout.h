@@ -0,0 +1,143 @@
+/*
+ * Shared memory layout for /dev/shm/breezy_desktop_imu
+ *
+ * Offsets shared by the X11 renderer and the KWin effect (the GNOME extension
+ * mirrors them in devicedatastream.js). All values are little-endian.
+ *
+ * Layout version 6 puts every field on its natural alignment and separates the
+ * pose the driver rewrites at IMU rate from the configuration it rarely touches:
+ *
+ *   [  0,  64)  header        version, enabled flag, total length
+ *   [ 64, 256)  pose block    sequence + checksum, then pose data (own cache lines)
+ *   [256, 320)  config block  generation + checksum, then device configuration
+ *
+ * Each block starts with a counter the writer makes odd before and even after
+ * updating the block (seqlock), followed by a checksum over the rest of the block.
+ * A reader copies the block and accepts it if the counter was even and unchanged
+ * across the copy and the checksum matches.
+ *
+ * EPOCH_MS and the float sample times in row 3 of POSE_ORIENTATION are wall-clock
+ * milliseconds. Drivers that set BREEZY_SHM_V6_FLAG_MONOTONIC_TIME also publish
+ * nanosecond CLOCK_MONOTONIC times for the three samples, which readers prefer for
+ * prediction since they are neither quantized nor subject to NTP steps.
+ *
+ * Drivers that set BREEZY_SHM_V6_FLAG_DOORBELL increment POSE_DOORBELL after each
+ * completed pose write and FUTEX_WAKE it (shared, not FUTEX_PRIVATE_FLAG), so
+ * readers can FUTEX_WAIT for a fresh sample instead of polling. The doorbell sits
+ * in the header, outside the pose block's cache lines, so waking readers doesn't
+ * bounce the line the writer is filling.
+ *
+ * Version 5 (packed, byte-XOR parity over epoch + orientation) is still accepted
+ * by all readers; its offsets are kept below for the compatibility paths.
+ */
+
+#ifndef BREEZY_SHM_LAYOUT_H
+#define BREEZY_SHM_LAYOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BREEZY_SHM_PATH "/dev/shm/breezy_desktop_imu"
+
+/* ============================================================================
+ * Version 6
+ * ============================================================================ */
+
+#define BREEZY_SHM_V6_VERSION 6
+#define BREEZY_SHM_CACHE_LINE 64
+
+/* Header */
+#define BREEZY_SHM_V6_OFFSET_VERSION 0                 /* uint8 */
+#define BREEZY_SHM_V6_OFFSET_ENABLED 1                 /* uint8 (bool) */
+#define BREEZY_SHM_V6_OFFSET_FLAGS 2                   /* uint8, BREEZY_SHM_V6_FLAG_* */
+#define BREEZY_SHM_V6_OFFSET_LENGTH 4                  /* uint32, total bytes */
+#define BREEZY_SHM_V6_OFFSET_POSE_DOORBELL 8           /* uint32 futex word, bumped per published pose */
+
+/* Header flags */
+#define BREEZY_SHM_V6_FLAG_MONOTONIC_TIME 0x01         /* SAMPLE_TIME_NS is populated */
+#define BREEZY_SHM_V6_FLAG_DOORBELL 0x02               /* POSE_DOORBELL is maintained */
+
+/* Pose block (hot) */
+#define BREEZY_SHM_V6_POSE_BLOCK 64
+#define BREEZY_SHM_V6_OFFSET_POSE_SEQUENCE 64          /* uint32 seqlock counter */
+#define BREEZY_SHM_V6_OFFSET_POSE_CHECKSUM 68          /* uint32 over [72, 256) */
+#define BREEZY_SHM_V6_OFFSET_EPOCH_MS 72               /* uint64 */
+#define BREEZY_SHM_V6_OFFSET_POSE_POSITION 80          /* float[3] */
+#define BREEZY_SHM_V6_OFFSET_SMOOTH_FOLLOW_ENABLED 92  /* uint8 (bool) */
+#define BREEZY_SHM_V6_OFFSET_POSE_ORIENTATION 96       /* float[16], row 3 = sample times */
+#define BREEZY_SHM_V6_OFFSET_SMOOTH_FOLLOW_ORIGIN 160  /* float[16] */
+#define BREEZY_SHM_V6_OFFSET_SAMPLE_TIME_NS 224        /* uint64[3], CLOCK_MONOTONIC of the t0..t2 samples */
+#define BREEZY_SHM_V6_POSE_DATA_START 72
+#define BREEZY_SHM_V6_POSE_BLOCK_END 256               /* [248, 256) reserved, zero */
+
+/* Config block (cold) */
+#define BREEZY_SHM_V6_CONFIG_BLOCK 256
+#define BREEZY_SHM_V6_OFFSET_CONFIG_GENERATION 256     /* uint32 seqlock counter */
+#define BREEZY_SHM_V6_OFFSET_CONFIG_CHECKSUM 260       /* uint32 over [264, 320) */
+#define BREEZY_SHM_V6_OFFSET_LOOK_AHEAD_CFG 264        /* float[4] */
+#define BREEZY_SHM_V6_OFFSET_DISPLAY_RES 280           /* uint32[2] */
+#define BREEZY_SHM_V6_OFFSET_DISPLAY_FOV 288           /* float */
+#define BREEZY_SHM_V6_OFFSET_LENS_DISTANCE_RATIO 292   /* float */
+#define BREEZY_SHM_V6_OFFSET_SBS_ENABLED 296           /* uint8 (bool) */
+#define BREEZY_SHM_V6_OFFSET_CUSTOM_BANNER_ENABLED 297 /* uint8 (bool) */
+#define BREEZY_SHM_V6_CONFIG_DATA_START 264
+#define BREEZY_SHM_V6_CONFIG_BLOCK_END 320
+
+#define BREEZY_SHM_V6_LENGTH 320
+
+/* ============================================================================
+ * Version 5 (legacy, packed)
+ * ============================================================================ */
+
+#define BREEZY_SHM_V5_VERSION 5
+#define BREEZY_SHM_V5_OFFSET_VERSION 0
+#define BREEZY_SHM_V5_OFFSET_ENABLED 1
+#define BREEZY_SHM_V5_OFFSET_LOOK_AHEAD_CFG 2
+#define BREEZY_SHM_V5_OFFSET_DISPLAY_RES 18
+#define BREEZY_SHM_V5_OFFSET_DISPLAY_FOV 26
+#define BREEZY_SHM_V5_OFFSET_LENS_DISTANCE_RATIO 30
+#define BREEZY_SHM_V5_OFFSET_SBS_ENABLED 34
+#define BREEZY_SHM_V5_OFFSET_CUSTOM_BANNER_ENABLED 35
+#define BREEZY_SHM_V5_OFFSET_SMOOTH_FOLLOW_ENABLED 36
+#define BREEZY_SHM_V5_OFFSET_SMOOTH_FOLLOW_ORIGIN 37
+#define BREEZY_SHM_V5_OFFSET_POSE_POSITION 101
+#define BREEZY_SHM_V5_OFFSET_EPOCH_MS 113
+#define BREEZY_SHM_V5_OFFSET_POSE_ORIENTATION 121
+#define BREEZY_SHM_V5_OFFSET_PARITY 185
+#define BREEZY_SHM_V5_LENGTH 186
+
+/* ============================================================================
+ * Integrity checks
+ * ============================================================================ */
+
+/**
+ * Block checksum: FNV-1a over little-endian 32-bit words
+ *
+ * Catches reordered and multi-byte changes that cancel out under XOR parity,
+ * at one multiply per 4 bytes. start/end are byte offsets into data and must
+ * be 4-byte aligned.
+ */
+static inline uint32_t breezy_shm_checksum(const uint8_t *data, size_t start, size_t end) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = start; i + 4 <= end; i += 4) {
+        uint32_t word = (uint32_t)data[i] |
+                        ((uint32_t)data[i + 1] << 8) |
+                        ((uint32_t)data[i + 2] << 16) |
+                        ((uint32_t)data[i + 3] << 24);
+        hash = (hash ^ word) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Version 5 parity: XOR of the epoch and pose orientation bytes
+ */
+static inline uint8_t breezy_shm_v5_parity(const uint8_t *data) {
+    uint8_t parity = 0;
+    for (size_t i = BREEZY_SHM_V5_OFFSET_EPOCH_MS; i < BREEZY_SHM_V5_OFFSET_PARITY; i++) {
+        parity ^= data[i];
+    }
+    return parity;
+}
+
+#endif /* BREEZY_SHM_LAYOUT_H */
@@ -212,6 +212,18 @@ float breezy_calculate_look_ahead_ms(uint64_t imu_timestamp_ms, uint64_t current
     return look_ahead + (float)data_age;
 }
 
+float breezy_calculate_look_ahead_ms_ns(uint64_t sample_time_ns, uint64_t current_time_ns,
+                                         float look_ahead_constant, float look_ahead_override) {
+    // How stale the IMU sample is
+    uint64_t data_age_ns = (current_time_ns > sample_time_ns) ?
+                           (current_time_ns - sample_time_ns) : 0;
+
+    // Use override if provided, otherwise use constant
+    float look_ahead = (look_ahead_override >= 0.0f) ? look_ahead_override : look_ahead_constant;
+
+    return look_ahead + (float)((double)data_age_ns / 1e6);
+}
+
 /* ============================================================================
  * Perspective Matrix
  * ============================================================================ */
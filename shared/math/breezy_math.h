@@ -234,6 +234,21 @@ float breezy_smooth_follow_slerp_progress(uint64_t elapsed_ms);
 float breezy_calculate_look_ahead_ms(uint64_t imu_timestamp_ms, uint64_t current_time_ms,
                                       float look_ahead_constant, float look_ahead_override);
 
+/**
+ * Calculate look-ahead milliseconds from monotonic nanosecond timestamps
+ *
+ * Preferred over breezy_calculate_look_ahead_ms when the driver publishes
+ * CLOCK_MONOTONIC sample times: no millisecond quantization, no wall-clock jumps.
+ *
+ * @param sample_time_ns CLOCK_MONOTONIC time of the newest IMU sample
+ * @param current_time_ns CLOCK_MONOTONIC time now
+ * @param look_ahead_constant Constant look-ahead value
+ * @param look_ahead_override Override value (-1 to use constant)
+ * @return Look-ahead value in milliseconds
+ */
+float breezy_calculate_look_ahead_ms_ns(uint64_t sample_time_ns, uint64_t current_time_ns,
+                                         float look_ahead_constant, float look_ahead_override);
+
 /* ============================================================================
  * Perspective Matrix
  * ============================================================================ */
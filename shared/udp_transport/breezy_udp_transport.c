@@ -0,0 +1,790 @@
+#define _GNU_SOURCE
+#include "breezy_udp_transport.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Packets start with a common header, all fields little-endian:
+//   u16 magic, u8 version, u8 type, u32 sequence, u32 send time (sender's CLOCK_MONOTONIC, us)
+// Data and parity packets continue with:
+//   u32 frame id, u32 frame size, u16 fragment size, u16 fragment index (group index
+//   for parity), u8 fec group, u8 reserved, then the payload.
+// Parity payloads are the XOR of the group's fragments, each zero-padded to the fragment size.
+// Feedback packets continue with u32 fields: echoed send time, time held before echoing (us),
+// then u16 loss (per mille), u16 frames abandoned, and jitter, decode time, assembly time
+// (us), frames completed and queue delay (us).
+#define PACKET_MAGIC 0x4255
+#define PACKET_VERSION 1
+#define PACKET_DATA 0
+#define PACKET_PARITY 1
+#define PACKET_FEEDBACK 2
+#define COMMON_HEADER_SIZE 12
+#define FRAGMENT_HEADER_SIZE 26
+#define FEEDBACK_SIZE 44
+#define MAX_PACKET_SIZE (FRAGMENT_HEADER_SIZE + BREEZY_UDP_MAX_PAYLOAD)
+#define MIN_FRAGMENT_SIZE 256
+#define MAX_FRAGMENTS 65535
+#define RECEIVER_SLOTS 3
+#define SEQUENCE_RESYNC 10000  // A jump this large is a restarted sender, not loss
+#define BASE_DELAY_WINDOW_NS 5000000000LL  // The minimum transit time is kept over one to two of these
+
+// Controller
+#define MIN_QUALITY 20
+#define QUALITY_STEP_DOWN 10
+#define QUALITY_STEP_UP 5
+#define MIN_SCALE 0.5f
+#define SCALE_STEP 0.25f
+#define HOLD_REPORTS 4        // Between step downs, for the queue to drain
+#define HEADROOM_REPORTS 10   // Consecutive reports with headroom before stepping up
+#define PROBE_REPORTS 20      // A step up that lasts this long without overload holds
+#define MAX_PROBE_BACKOFF 8   // Multiple of HEADROOM_REPORTS after failed step ups
+#define HEADROOM 0.7f         // Of the latency target
+#define MAX_ABANDONED 0.1f    // Fraction of frames lost despite parity before stepping down
+#define MIN_ABANDONED 0.02f   // ... and the most there can be to step up
+#define SMOOTHING 0.3f        // Weight of the newest report
+#define ABANDONED_WINDOW 30   // Frames per abandoned fraction; a report covers only a few
+#define QUEUE_DELAY_LIMIT 0.2f  // Of the latency target; a standing queue this long means overload
+
+struct BreezyUdpSender {
+    int fd;
+    struct sockaddr_storage peer;
+    socklen_t peer_len;
+    BreezyUdpStreamSettings settings;
+    BreezyUdpStreamSettings ceiling;
+    float latency_target_ms;
+    uint32_t frame_id;
+    uint32_t sequence;
+    uint8_t packet[MAX_PACKET_SIZE];
+    uint8_t *parity;  // One fragment per group, grown to the largest frame's need
+    size_t parity_capacity;
+    int hold_reports;
+    int headroom_reports;
+    int probe_reports;  // Since the last step up, while it's on trial
+    int probe_backoff;
+    bool probing;
+    uint32_t window_frames;
+    uint32_t window_abandoned;
+    BreezyUdpSenderStats stats;
+};
+
+typedef struct {
+    bool active;
+    uint32_t frame_id;
+    uint32_t frame_size;
+    uint32_t fragment_size;
+    uint32_t fragment_count;
+    uint32_t fec_group;
+    uint32_t group_count;
+    uint32_t fragments_received;
+    int64_t first_arrival_ns;
+    uint8_t *data;
+    uint8_t *parity;
+    uint8_t *fragment_received;
+    uint8_t *group_received;  // Data fragments received per group
+    uint8_t *group_has_parity;
+} FrameSlot;
+
+struct BreezyUdpReceiver {
+    int fd;
+    uint32_t max_frame_size;
+    uint32_t max_fragments;
+    FrameSlot slots[RECEIVER_SLOTS];
+    bool delivered_any;
+    uint32_t last_delivered_id;
+    uint8_t packet[MAX_PACKET_SIZE];
+    uint8_t scratch[BREEZY_UDP_MAX_PAYLOAD];
+
+    struct sockaddr_storage peer;
+    socklen_t peer_len;
+    bool have_peer;
+
+    // Loss from sequence numbers, as in RTCP receiver reports
+    bool have_sequence;
+    uint32_t highest_sequence;
+    uint32_t reported_sequence;
+    uint32_t received_since_report;
+
+    // RFC 3550 interarrival jitter
+    bool have_transit;
+    int32_t last_transit_us;
+    float jitter_us;
+
+    // Standing queue ahead of each frame: its first packet's transit time over the minimum
+    bool have_base_transit;
+    int32_t base_transit_us[2];  // Minimum in the current and previous window
+    int64_t base_window_start_ns;
+    uint32_t queue_delay_max_us;  // Since the last report
+
+    // Newest packet, echoed for the sender's round trip time
+    uint32_t echo_send_time_us;
+    int64_t echo_arrival_ns;
+
+    double decode_ms_sum;
+    uint32_t decode_count;
+    double assembly_ms_sum;
+    uint32_t assembly_count;
+    uint32_t frames_abandoned_since_report;
+    uint32_t feedback_sequence;
+    int64_t last_report_ns;
+    BreezyUdpReceiverStats stats;
+};
+
+static int64_t monotonic_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void put_u16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t value) {
+    put_u16(p, (uint16_t)value);
+    put_u16(p + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static void put_common_header(uint8_t *p, uint8_t type, uint32_t sequence) {
+    put_u16(p, PACKET_MAGIC);
+    p[2] = PACKET_VERSION;
+    p[3] = type;
+    put_u32(p + 4, sequence);
+    put_u32(p + 8, (uint32_t)(monotonic_now_ns() / 1000));
+}
+
+static bool valid_common_header(const uint8_t *p, size_t length) {
+    return length >= COMMON_HEADER_SIZE && get_u16(p) == PACKET_MAGIC && p[2] == PACKET_VERSION;
+}
+
+static uint32_t fragment_length(uint32_t frame_size, uint32_t fragment_size, uint32_t index) {
+    uint32_t offset = index * fragment_size;
+    return frame_size - offset < fragment_size ? frame_size - offset : fragment_size;
+}
+
+// Sender
+
+BreezyUdpSender *breezy_udp_sender_create(int fd, const struct sockaddr *peer, socklen_t peer_len,
+                                          const BreezyUdpStreamSettings *initial, float latency_target_ms) {
+    if (fd < 0 || !peer || peer_len > sizeof(struct sockaddr_storage) || !initial ||
+        initial->fps <= 0 || initial->fec_group < 0 || initial->fec_group > BREEZY_UDP_MAX_FEC_GROUP) {
+        return NULL;
+    }
+
+    BreezyUdpSender *sender = calloc(1, sizeof(*sender));
+    if (!sender) {
+        return NULL;
+    }
+    sender->fd = fd;
+    memcpy(&sender->peer, peer, peer_len);
+    sender->peer_len = peer_len;
+    sender->settings = *initial;
+    sender->ceiling = *initial;
+    sender->latency_target_ms = latency_target_ms;
+    sender->probe_backoff = 1;
+    return sender;
+}
+
+void breezy_udp_sender_destroy(BreezyUdpSender *sender) {
+    if (sender) {
+        free(sender->parity);
+        free(sender);
+    }
+}
+
+static int send_packet(BreezyUdpSender *sender, size_t length) {
+    sender->sequence++;
+    if (sendto(sender->fd, sender->packet, length, MSG_DONTWAIT,
+               (const struct sockaddr *)&sender->peer, sender->peer_len) >= 0) {
+        sender->stats.packets_sent++;
+        return 0;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS || errno == EINTR) {
+        // The receiver sees the sequence gap as loss, which is what it is
+        sender->stats.packets_not_sent++;
+        return 0;
+    }
+    return -1;
+}
+
+static void put_fragment_header(BreezyUdpSender *sender, uint8_t type, uint32_t frame_size,
+                                uint32_t index, uint32_t fec_group) {
+    uint8_t *p = sender->packet;
+    put_common_header(p, type, sender->sequence);
+    put_u32(p + 12, sender->frame_id);
+    put_u32(p + 16, frame_size);
+    put_u16(p + 20, BREEZY_UDP_MAX_PAYLOAD);
+    put_u16(p + 22, (uint16_t)index);
+    p[24] = (uint8_t)fec_group;
+    p[25] = 0;
+}
+
+int breezy_udp_sender_send_frame(BreezyUdpSender *sender, const void *data, uint32_t size) {
+    if (size == 0 || size > (uint32_t)MAX_FRAGMENTS * BREEZY_UDP_MAX_PAYLOAD) {
+        return -1;
+    }
+    uint32_t fragment_count = (size + BREEZY_UDP_MAX_PAYLOAD - 1) / BREEZY_UDP_MAX_PAYLOAD;
+
+    uint32_t fec_group = (uint32_t)sender->settings.fec_group;
+    uint32_t group_count = fec_group ? (fragment_count + fec_group - 1) / fec_group : 0;
+    size_t parity_size = (size_t)group_count * BREEZY_UDP_MAX_PAYLOAD;
+    if (parity_size > sender->parity_capacity) {
+        uint8_t *parity = realloc(sender->parity, parity_size);
+        if (!parity) {
+            return -1;
+        }
+        sender->parity = parity;
+        sender->parity_capacity = parity_size;
+    }
+    if (parity_size) {
+        memset(sender->parity, 0, parity_size);
+    }
+
+    const uint8_t *bytes = data;
+    for (uint32_t i = 0; i < fragment_count; i++) {
+        uint32_t length = fragment_length(size, BREEZY_UDP_MAX_PAYLOAD, i);
+        const uint8_t *fragment = bytes + (size_t)i * BREEZY_UDP_MAX_PAYLOAD;
+        put_fragment_header(sender, PACKET_DATA, size, i, fec_group);
+        memcpy(sender->packet + FRAGMENT_HEADER_SIZE, fragment, length);
+        if (send_packet(sender, FRAGMENT_HEADER_SIZE + length) != 0) {
+            return -1;
+        }
+
+        if (group_count) {
+            uint8_t *parity = sender->parity + (size_t)(i % group_count) * BREEZY_UDP_MAX_PAYLOAD;
+            for (uint32_t b = 0; b < length; b++) {
+                parity[b] ^= fragment[b];
+            }
+        }
+    }
+
+    for (uint32_t group = 0; group < group_count; group++) {
+        put_fragment_header(sender, PACKET_PARITY, size, group, fec_group);
+        memcpy(sender->packet + FRAGMENT_HEADER_SIZE, sender->parity + (size_t)group * BREEZY_UDP_MAX_PAYLOAD,
+               BREEZY_UDP_MAX_PAYLOAD);
+        if (send_packet(sender, MAX_PACKET_SIZE) != 0) {
+            return -1;
+        }
+    }
+
+    sender->frame_id++;
+    sender->stats.frames_sent++;
+    return 0;
+}
+
+static void step_down(BreezyUdpStreamSettings *settings, const BreezyUdpStreamSettings *ceiling) {
+    int min_quality = ceiling->jpeg_quality < MIN_QUALITY ? ceiling->jpeg_quality : MIN_QUALITY;
+    float min_scale = ceiling->scale < MIN_SCALE ? ceiling->scale : MIN_SCALE;
+    int min_fps = ceiling->fps / 2 > 0 ? ceiling->fps / 2 : 1;
+    int fps_step = ceiling->fps / 4 > 0 ? ceiling->fps / 4 : 1;
+
+    if (settings->jpeg_quality > min_quality) {
+        settings->jpeg_quality -= QUALITY_STEP_DOWN;
+        settings->jpeg_quality = settings->jpeg_quality < min_quality ? min_quality : settings->jpeg_quality;
+    } else if (settings->scale > min_scale) {
+        settings->scale -= SCALE_STEP;
+        settings->scale = settings->scale < min_scale ? min_scale : settings->scale;
+    } else if (settings->fps > min_fps) {
+        settings->fps -= fps_step;
+        settings->fps = settings->fps < min_fps ? min_fps : settings->fps;
+    }
+}
+
+static void step_up(BreezyUdpStreamSettings *settings, const BreezyUdpStreamSettings *ceiling) {
+    int fps_step = ceiling->fps / 4 > 0 ? ceiling->fps / 4 : 1;
+
+    if (settings->fps < ceiling->fps) {
+        settings->fps += fps_step;
+        settings->fps = settings->fps > ceiling->fps ? ceiling->fps : settings->fps;
+    } else if (settings->scale < ceiling->scale) {
+        settings->scale += SCALE_STEP;
+        settings->scale = settings->scale > ceiling->scale ? ceiling->scale : settings->scale;
+    } else if (settings->jpeg_quality < ceiling->jpeg_quality) {
+        settings->jpeg_quality += QUALITY_STEP_UP;
+        settings->jpeg_quality = settings->jpeg_quality > ceiling->jpeg_quality ? ceiling->jpeg_quality
+                                                                                : settings->jpeg_quality;
+    }
+}
+
+// Returns true if the settings changed
+static bool adapt_settings(BreezyUdpSender *sender) {
+    BreezyUdpStreamSettings next = sender->settings;
+    const BreezyUdpSenderStats *stats = &sender->stats;
+
+    // One parity packet per group fixes one loss in it, so shrink the groups as loss rises
+    if (sender->ceiling.fec_group) {
+        int group = stats->loss < 0.005f ? BREEZY_UDP_MAX_FEC_GROUP :
+                    stats->loss < 0.02f ? 8 :
+                    stats->loss < 0.05f ? 4 : 2;
+        // Losses in bursts longer than the interleaving hit a group twice
+        if (stats->abandoned > MIN_ABANDONED && group > 2) {
+            group /= 2;
+        }
+        next.fec_group = group < sender->ceiling.fec_group ? group : sender->ceiling.fec_group;
+    }
+
+    // A standing queue is caught before it adds up to the latency target. Abandoned frames
+    // had more losses than parity could fix; smaller frames need fewer packets.
+    float queue_delay_limit_ms = sender->latency_target_ms * QUEUE_DELAY_LIMIT;
+    bool over = stats->latency_ms > sender->latency_target_ms || stats->queue_delay_ms > queue_delay_limit_ms ||
+                stats->abandoned > MAX_ABANDONED;
+    bool headroom = stats->latency_ms < sender->latency_target_ms * HEADROOM && stats->abandoned < MIN_ABANDONED;
+    if (sender->probing && over) {
+        // The last step up overloaded the link; probe less often
+        sender->probing = false;
+        sender->probe_backoff = sender->probe_backoff * 2 < MAX_PROBE_BACKOFF ? sender->probe_backoff * 2
+                                                                              : MAX_PROBE_BACKOFF;
+    } else if (sender->probing && ++sender->probe_reports >= PROBE_REPORTS) {
+        sender->probing = false;
+        sender->probe_backoff = 1;
+    }
+
+    // Step downs are immediate (a step up may have started a queue) but spaced out so
+    // the queue can drain; step ups wait for sustained headroom
+    if (over) {
+        sender->headroom_reports = 0;
+        if (sender->hold_reports > 0) {
+            sender->hold_reports--;
+        } else {
+            step_down(&next, &sender->ceiling);
+            sender->hold_reports = HOLD_REPORTS;
+        }
+    } else {
+        sender->hold_reports = 0;
+        if (!headroom) {
+            sender->headroom_reports = 0;
+        } else if (++sender->headroom_reports >= HEADROOM_REPORTS * sender->probe_backoff) {
+            step_up(&next, &sender->ceiling);
+            sender->headroom_reports = 0;
+            sender->probing = true;
+            sender->probe_reports = 0;
+        }
+    }
+
+    bool changed = next.jpeg_quality != sender->settings.jpeg_quality || next.scale != sender->settings.scale ||
+                   next.fps != sender->settings.fps || next.fec_group != sender->settings.fec_group;
+    sender->settings = next;
+    return changed;
+}
+
+static float smooth(float current, float sample, bool first) {
+    return first ? sample : current + (sample - current) * SMOOTHING;
+}
+
+static bool handle_feedback(BreezyUdpSender *sender, const uint8_t *p) {
+    BreezyUdpSenderStats *stats = &sender->stats;
+    bool first = stats->reports == 0;
+    uint32_t now_us = (uint32_t)(monotonic_now_ns() / 1000);
+    uint32_t echo_send_time_us = get_u32(p + 12);
+    uint32_t echo_delay_us = get_u32(p + 16);
+
+    // Wrapping arithmetic on the 32-bit clock; nonsense values are from before any packet arrived
+    uint32_t rtt_us = now_us - echo_send_time_us - echo_delay_us;
+    if (echo_send_time_us && rtt_us < 10000000) {
+        stats->rtt_ms = smooth(stats->rtt_ms, (float)rtt_us / 1000.0f, first);
+    }
+    stats->loss = smooth(stats->loss, (float)get_u16(p + 20) / 1000.0f, first);
+    uint32_t abandoned = get_u16(p + 22);
+    uint32_t completed = get_u32(p + 36);
+    sender->window_abandoned += abandoned;
+    sender->window_frames += abandoned + completed;
+    if (sender->window_frames >= ABANDONED_WINDOW) {
+        stats->abandoned = (float)sender->window_abandoned / (float)sender->window_frames;
+        sender->window_abandoned = 0;
+        sender->window_frames = 0;
+    }
+    stats->jitter_ms = (float)get_u32(p + 24) / 1000.0f;
+    stats->decode_ms = smooth(stats->decode_ms, (float)get_u32(p + 28) / 1000.0f, first);
+    stats->assembly_ms = smooth(stats->assembly_ms, (float)get_u32(p + 32) / 1000.0f, first);
+    stats->queue_delay_ms = (float)get_u32(p + 40) / 1000.0f;
+    stats->latency_ms = stats->rtt_ms / 2.0f + stats->assembly_ms + stats->decode_ms;
+    stats->reports++;
+
+    return sender->latency_target_ms > 0 && adapt_settings(sender);
+}
+
+int breezy_udp_sender_poll(BreezyUdpSender *sender) {
+    int changed = 0;
+    uint8_t packet[FEEDBACK_SIZE];
+    for (;;) {
+        ssize_t length = recv(sender->fd, packet, sizeof(packet), MSG_DONTWAIT);
+        if (length < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            // ICMP port unreachable from an earlier send: the client isn't up yet
+            if (errno == EINTR || errno == ECONNREFUSED) {
+                continue;
+            }
+            return -1;
+        }
+        if (length == FEEDBACK_SIZE && valid_common_header(packet, (size_t)length) && packet[3] == PACKET_FEEDBACK &&
+            handle_feedback(sender, packet)) {
+            changed = 1;
+        }
+    }
+    return changed;
+}
+
+BreezyUdpStreamSettings breezy_udp_sender_settings(const BreezyUdpSender *sender) {
+    return sender->settings;
+}
+
+BreezyUdpSenderStats breezy_udp_sender_stats(const BreezyUdpSender *sender) {
+    return sender->stats;
+}
+
+// Receiver
+
+BreezyUdpReceiver *breezy_udp_receiver_create(int fd, uint32_t max_frame_size) {
+    if (fd < 0 || max_frame_size == 0) {
+        return NULL;
+    }
+
+    BreezyUdpReceiver *receiver = calloc(1, sizeof(*receiver));
+    if (!receiver) {
+        return NULL;
+    }
+    receiver->fd = fd;
+    receiver->max_frame_size = max_frame_size;
+    receiver->max_fragments = max_frame_size / MIN_FRAGMENT_SIZE + 1;
+    if (receiver->max_fragments > MAX_FRAGMENTS) {
+        receiver->max_fragments = MAX_FRAGMENTS;
+    }
+
+    // Groups never outnumber fragments, so the parity of a frame is at most one fragment over its size
+    for (int i = 0; i < RECEIVER_SLOTS; i++) {
+        FrameSlot *slot = &receiver->slots[i];
+        slot->data = malloc(max_frame_size);
+        slot->parity = malloc((size_t)max_frame_size + BREEZY_UDP_MAX_PAYLOAD);
+        slot->fragment_received = malloc(receiver->max_fragments);
+        slot->group_received = malloc(receiver->max_fragments);
+        slot->group_has_parity = malloc(receiver->max_fragments);
+        if (!slot->data || !slot->parity || !slot->fragment_received || !slot->group_received ||
+            !slot->group_has_parity) {
+            breezy_udp_receiver_destroy(receiver);
+            return NULL;
+        }
+    }
+    return receiver;
+}
+
+void breezy_udp_receiver_destroy(BreezyUdpReceiver *receiver) {
+    if (!receiver) {
+        return;
+    }
+    for (int i = 0; i < RECEIVER_SLOTS; i++) {
+        FrameSlot *slot = &receiver->slots[i];
+        free(slot->data);
+        free(slot->parity);
+        free(slot->fragment_received);
+        free(slot->group_received);
+        free(slot->group_has_parity);
+    }
+    free(receiver);
+}
+
+void breezy_udp_receiver_report_decode(BreezyUdpReceiver *receiver, float decode_ms) {
+    receiver->decode_ms_sum += decode_ms;
+    receiver->decode_count++;
+}
+
+BreezyUdpReceiverStats breezy_udp_receiver_stats(const BreezyUdpReceiver *receiver) {
+    BreezyUdpReceiverStats stats = receiver->stats;
+    stats.jitter_ms = receiver->jitter_us / 1000.0f;
+    return stats;
+}
+
+static void abandon_slot(BreezyUdpReceiver *receiver, FrameSlot *slot) {
+    slot->active = false;
+    receiver->stats.frames_abandoned++;
+    receiver->frames_abandoned_since_report++;
+}
+
+static FrameSlot *slot_for_frame(BreezyUdpReceiver *receiver, uint32_t frame_id) {
+    FrameSlot *free_slot = NULL;
+    FrameSlot *oldest = NULL;
+    for (int i = 0; i < RECEIVER_SLOTS; i++) {
+        FrameSlot *slot = &receiver->slots[i];
+        if (!slot->active) {
+            free_slot = free_slot ? free_slot : slot;
+        } else if (slot->frame_id == frame_id) {
+            return slot;
+        } else if (!oldest || (int32_t)(slot->frame_id - oldest->frame_id) < 0) {
+            oldest = slot;
+        }
+    }
+    if (free_slot) {
+        return free_slot;
+    }
+
+    // A packet older than every frame in flight isn't worth evicting one of them for
+    if ((int32_t)(frame_id - oldest->frame_id) < 0) {
+        return NULL;
+    }
+    abandon_slot(receiver, oldest);
+    return oldest;
+}
+
+// Rebuilds the group's missing fragment once parity and all but one of its fragments are in
+static void try_recover(BreezyUdpReceiver *receiver, FrameSlot *slot, uint32_t group) {
+    uint32_t members = (slot->fragment_count - group + slot->group_count - 1) / slot->group_count;
+    if (!slot->group_has_parity[group] || slot->group_received[group] + 1u != members) {
+        return;
+    }
+
+    uint8_t *scratch = receiver->scratch;
+    memcpy(scratch, slot->parity + (size_t)group * slot->fragment_size, slot->fragment_size);
+    uint32_t missing = 0;
+    for (uint32_t i = group; i < slot->fragment_count; i += slot->group_count) {
+        if (!slot->fragment_received[i]) {
+            missing = i;
+            continue;
+        }
+        // Only the fragment's own bytes: past the end of the frame the buffer holds stale data
+        const uint8_t *fragment = slot->data + (size_t)i * slot->fragment_size;
+        uint32_t length = fragment_length(slot->frame_size, slot->fragment_size, i);
+        for (uint32_t b = 0; b < length; b++) {
+            scratch[b] ^= fragment[b];
+        }
+    }
+
+    memcpy(slot->data + (size_t)missing * slot->fragment_size, scratch,
+           fragment_length(slot->frame_size, slot->fragment_size, missing));
+    slot->fragment_received[missing] = 1;
+    slot->group_received[group]++;
+    slot->fragments_received++;
+    receiver->stats.fragments_recovered++;
+}
+
+// A frame's first packet doesn't queue behind the rest of its own frame, so its transit
+// time over the minimum is how long the link's queue was when the frame started
+static void note_frame_start(BreezyUdpReceiver *receiver, int64_t now_ns) {
+    int32_t transit_us = receiver->last_transit_us;
+    if (!receiver->have_base_transit || now_ns - receiver->base_window_start_ns >= BASE_DELAY_WINDOW_NS) {
+        // Windowed so the base follows clock drift and route changes
+        receiver->base_transit_us[1] = receiver->have_base_transit ? receiver->base_transit_us[0] : transit_us;
+        receiver->base_transit_us[0] = transit_us;
+        receiver->base_window_start_ns = now_ns;
+        receiver->have_base_transit = true;
+    }
+    if (transit_us < receiver->base_transit_us[0]) {
+        receiver->base_transit_us[0] = transit_us;
+    }
+
+    int32_t base_us = receiver->base_transit_us[0] < receiver->base_transit_us[1] ? receiver->base_transit_us[0]
+                                                                                 : receiver->base_transit_us[1];
+    uint32_t queue_delay_us = (uint32_t)(transit_us - base_us);
+    if (queue_delay_us > receiver->queue_delay_max_us) {
+        receiver->queue_delay_max_us = queue_delay_us;
+    }
+}
+
+// Returns the frame's slot if the packet completed it, NULL otherwise
+static FrameSlot *handle_fragment(BreezyUdpReceiver *receiver, const uint8_t *p, size_t length, int64_t now_ns) {
+    if (length < FRAGMENT_HEADER_SIZE) {
+        return NULL;
+    }
+    uint8_t type = p[3];
+    uint32_t frame_id = get_u32(p + 12);
+    uint32_t frame_size = get_u32(p + 16);
+    uint32_t fragment_size = get_u16(p + 20);
+    uint32_t index = get_u16(p + 22);
+    uint32_t fec_group = p[24];
+    if (fragment_size < MIN_FRAGMENT_SIZE || fragment_size > BREEZY_UDP_MAX_PAYLOAD ||
+        frame_size == 0 || frame_size > receiver->max_frame_size || fec_group > BREEZY_UDP_MAX_FEC_GROUP) {
+        return NULL;
+    }
+    uint32_t fragment_count = (frame_size + fragment_size - 1) / fragment_size;
+    if (fragment_count > receiver->max_fragments) {
+        return NULL;
+    }
+
+    // Latest-wins: anything from before the last delivered frame is too late to use
+    if (receiver->delivered_any && (int32_t)(frame_id - receiver->last_delivered_id) <= 0) {
+        return NULL;
+    }
+
+    FrameSlot *slot = slot_for_frame(receiver, frame_id);
+    if (!slot) {
+        return NULL;
+    }
+    if (!slot->active) {
+        slot->active = true;
+        slot->frame_id = frame_id;
+        slot->frame_size = frame_size;
+        slot->fragment_size = fragment_size;
+        slot->fragment_count = fragment_count;
+        slot->fec_group = fec_group;
+        slot->group_count = fec_group ? (fragment_count + fec_group - 1) / fec_group : 0;
+        slot->fragments_received = 0;
+        slot->first_arrival_ns = now_ns;
+        note_frame_start(receiver, now_ns);
+        memset(slot->fragment_received, 0, fragment_count);
+        memset(slot->group_received, 0, slot->group_count);
+        memset(slot->group_has_parity, 0, slot->group_count);
+    } else if (slot->frame_size != frame_size || slot->fragment_size != fragment_size || slot->fec_group != fec_group) {
+        return NULL;
+    }
+
+    const uint8_t *payload = p + FRAGMENT_HEADER_SIZE;
+    size_t payload_length = length - FRAGMENT_HEADER_SIZE;
+    if (type == PACKET_DATA) {
+        uint32_t expected_length = index < fragment_count ? fragment_length(frame_size, fragment_size, index) : 0;
+        if (index >= fragment_count || payload_length != expected_length || slot->fragment_received[index]) {
+            return NULL;
+        }
+        memcpy(slot->data + (size_t)index * fragment_size, payload, expected_length);
+        slot->fragment_received[index] = 1;
+        slot->fragments_received++;
+        if (slot->group_count) {
+            uint32_t group = index % slot->group_count;
+            slot->group_received[group]++;
+            try_recover(receiver, slot, group);
+        }
+    } else {
+        if (index >= slot->group_count || payload_length != fragment_size || slot->group_has_parity[index]) {
+            return NULL;
+        }
+        memcpy(slot->parity + (size_t)index * fragment_size, payload, fragment_size);
+        slot->group_has_parity[index] = 1;
+        try_recover(receiver, slot, index);
+    }
+
+    if (slot->fragments_received < slot->fragment_count) {
+        return NULL;
+    }
+
+    slot->active = false;
+    receiver->delivered_any = true;
+    receiver->last_delivered_id = frame_id;
+    receiver->stats.frames_completed++;
+    receiver->assembly_ms_sum += (double)(now_ns - slot->first_arrival_ns) / 1e6;
+    receiver->assembly_count++;
+    for (int i = 0; i < RECEIVER_SLOTS; i++) {
+        FrameSlot *other = &receiver->slots[i];
+        if (other->active && (int32_t)(other->frame_id - frame_id) < 0) {
+            abandon_slot(receiver, other);
+        }
+    }
+    return slot;
+}
+
+static void note_packet(BreezyUdpReceiver *receiver, uint32_t sequence, uint32_t send_time_us, int64_t now_ns) {
+    int32_t ahead = (int32_t)(sequence - receiver->highest_sequence);
+    if (!receiver->have_sequence || ahead > SEQUENCE_RESYNC || ahead < -SEQUENCE_RESYNC) {
+        receiver->have_sequence = true;
+        receiver->highest_sequence = sequence;
+        receiver->reported_sequence = sequence - 1;
+        receiver->received_since_report = 0;
+        receiver->have_transit = false;
+        receiver->have_base_transit = false;
+        ahead = 1;
+    }
+    receiver->stats.packets_received++;
+    receiver->received_since_report++;
+    if (ahead > 0) {
+        receiver->highest_sequence = sequence;
+        receiver->echo_send_time_us = send_time_us;
+        receiver->echo_arrival_ns = now_ns;
+    }
+
+    // The clocks differ by a constant, which cancels out of the transit time differences
+    int32_t transit_us = (int32_t)((uint32_t)(now_ns / 1000) - send_time_us);
+    if (receiver->have_transit) {
+        int32_t delta = transit_us - receiver->last_transit_us;
+        float magnitude = (float)(delta < 0 ? -delta : delta);
+        receiver->jitter_us += (magnitude - receiver->jitter_us) / 16.0f;
+    }
+    receiver->last_transit_us = transit_us;
+    receiver->have_transit = true;
+}
+
+static void send_report(BreezyUdpReceiver *receiver, int64_t now_ns) {
+    uint32_t expected = receiver->highest_sequence - receiver->reported_sequence;
+    uint32_t lost = expected > receiver->received_since_report ? expected - receiver->received_since_report : 0;
+    receiver->stats.packets_lost += lost;
+    uint32_t abandoned = receiver->frames_abandoned_since_report;
+
+    uint8_t p[FEEDBACK_SIZE];
+    put_common_header(p, PACKET_FEEDBACK, receiver->feedback_sequence++);
+    put_u32(p + 12, receiver->echo_send_time_us);
+    put_u32(p + 16, (uint32_t)((now_ns - receiver->echo_arrival_ns) / 1000));
+    put_u16(p + 20, (uint16_t)(expected ? (uint64_t)lost * 1000 / expected : 0));
+    put_u16(p + 22, (uint16_t)(abandoned > UINT16_MAX ? UINT16_MAX : abandoned));
+    put_u32(p + 24, (uint32_t)receiver->jitter_us);
+    put_u32(p + 28, receiver->decode_count ? (uint32_t)(receiver->decode_ms_sum / receiver->decode_count * 1000.0) : 0);
+    put_u32(p + 32, receiver->assembly_count ? (uint32_t)(receiver->assembly_ms_sum / receiver->assembly_count * 1000.0) : 0);
+    put_u32(p + 36, receiver->assembly_count);
+    put_u32(p + 40, receiver->queue_delay_max_us);
+
+    // A report that doesn't go out is simply late; the next one covers the same ground
+    if (sendto(receiver->fd, p, sizeof(p), MSG_DONTWAIT, (const struct sockaddr *)&receiver->peer,
+               receiver->peer_len) < 0) {
+        return;
+    }
+
+    receiver->reported_sequence = receiver->highest_sequence;
+    receiver->received_since_report = 0;
+    receiver->frames_abandoned_since_report = 0;
+    receiver->decode_ms_sum = 0.0;
+    receiver->decode_count = 0;
+    receiver->assembly_ms_sum = 0.0;
+    receiver->assembly_count = 0;
+    receiver->queue_delay_max_us = 0;
+    receiver->last_report_ns = now_ns;
+}
+
+int breezy_udp_receiver_poll(BreezyUdpReceiver *receiver, const uint8_t **frame, uint32_t *size,
+                             uint32_t *frame_id) {
+    int result = 0;
+    for (;;) {
+        struct sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+        ssize_t length = recvfrom(receiver->fd, receiver->packet, sizeof(receiver->packet), MSG_DONTWAIT,
+                                  (struct sockaddr *)&from, &from_len);
+        if (length < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR || errno == ECONNREFUSED) {
+                continue;
+            }
+            return -1;
+        }
+
+        const uint8_t *p = receiver->packet;
+        if (!valid_common_header(p, (size_t)length) || (p[3] != PACKET_DATA && p[3] != PACKET_PARITY)) {
+            continue;
+        }
+        int64_t now_ns = monotonic_now_ns();
+        memcpy(&receiver->peer, &from, from_len);
+        receiver->peer_len = from_len;
+        receiver->have_peer = true;
+        note_packet(receiver, get_u32(p + 4), get_u32(p + 8), now_ns);
+
+        FrameSlot *slot = handle_fragment(receiver, p, (size_t)length, now_ns);
+        if (slot) {
+            *frame = slot->data;
+            *size = slot->frame_size;
+            *frame_id = slot->frame_id;
+            result = 1;
+            break;
+        }
+    }
+
+    int64_t now_ns = monotonic_now_ns();
+    if (receiver->have_peer && now_ns - receiver->last_report_ns >= BREEZY_UDP_FEEDBACK_INTERVAL_MS * 1000000LL) {
+        send_report(receiver, now_ns);
+    }
+    return result;
+}
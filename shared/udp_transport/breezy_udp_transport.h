@@ -0,0 +1,110 @@
+/*
+ * UDP frame transport for remote clients
+ *
+ * Carries encoded frames (e.g. MJPEG, see ANDROID_RASPBERRY_CLIENT_OPTIONS.md) to a
+ * client over UDP. On Wi-Fi a single lost packet would otherwise lose the whole frame,
+ * so every frame is sent with XOR parity: its fragments are split into groups of
+ * fec_group, interleaved (fragment i is in group i % group_count) so a short burst of
+ * losses hits different groups, and each group gets one parity packet. Any one lost
+ * fragment per group is rebuilt by the receiver.
+ *
+ * The receiver reports back every BREEZY_UDP_FEEDBACK_INTERVAL_MS: packet loss before
+ * FEC, frames it had to give up on, interarrival jitter, queueing delay, frame assembly
+ * time and the decode time the client reports. The sender turns that into a latency estimate and
+ * adapts the stream settings to hold a latency target: it lowers JPEG quality first,
+ * then resolution, then frame rate, and raises them in the reverse order once there's
+ * headroom. Encoding is up to the caller, which applies the settings to its encoder.
+ *
+ * Both sides use a caller-owned, non-blocking UDP socket and never block. Buffers are
+ * sized up front, so sending and receiving don't allocate per frame. Frames are
+ * latest-wins: completing a frame abandons any older incomplete one.
+ *
+ * tests/udp_transport_harness.c exercises it over loopback with simulated loss, delay,
+ * jitter and a rate-limited link.
+ */
+
+#ifndef BREEZY_UDP_TRANSPORT_H
+#define BREEZY_UDP_TRANSPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BREEZY_UDP_MAX_PAYLOAD 1200           // Fragment size; keeps packets under a typical MTU
+#define BREEZY_UDP_MAX_FEC_GROUP 16
+#define BREEZY_UDP_FEEDBACK_INTERVAL_MS 50
+
+typedef struct BreezyUdpStreamSettings {
+    int jpeg_quality;  // 1-100
+    float scale;       // Of the source resolution, per axis
+    int fps;
+    int fec_group;     // Data fragments per parity packet, 0 for no parity
+} BreezyUdpStreamSettings;
+
+// Sender's view, from the receiver's last reports
+typedef struct BreezyUdpSenderStats {
+    uint64_t frames_sent;
+    uint64_t packets_sent;
+    uint64_t packets_not_sent;  // Socket buffer full
+    uint32_t reports;
+    float rtt_ms;
+    float latency_ms;           // Smoothed estimate: rtt/2 + frame assembly + decode
+    float loss;                 // Smoothed packet loss before FEC, 0-1
+    float jitter_ms;
+    float decode_ms;
+    float assembly_ms;
+    float queue_delay_ms;       // Longest queue ahead of a frame in the last report
+    float abandoned;            // Fraction of recent frames the receiver gave up on
+} BreezyUdpSenderStats;
+
+typedef struct BreezyUdpReceiverStats {
+    uint64_t packets_received;
+    uint64_t packets_lost;         // From sequence gaps, before FEC
+    uint64_t fragments_recovered;  // Rebuilt from parity
+    uint64_t frames_completed;
+    uint64_t frames_abandoned;     // Incomplete when a newer frame completed or took the slot
+    float jitter_ms;
+} BreezyUdpReceiverStats;
+
+typedef struct BreezyUdpSender BreezyUdpSender;
+typedef struct BreezyUdpReceiver BreezyUdpReceiver;
+
+// initial is also the ceiling the controller climbs back to; latency_target_ms <= 0
+// keeps the settings fixed. Returns NULL on failure.
+BreezyUdpSender *breezy_udp_sender_create(int fd, const struct sockaddr *peer, socklen_t peer_len,
+                                          const BreezyUdpStreamSettings *initial, float latency_target_ms);
+void breezy_udp_sender_destroy(BreezyUdpSender *sender);
+
+// Fragments and sends one encoded frame with the current fec_group. 0 on success
+// (including packets dropped because the socket buffer was full), -1 on error.
+int breezy_udp_sender_send_frame(BreezyUdpSender *sender, const void *data, uint32_t size);
+
+// Handles pending receiver reports. 1 if the stream settings changed, 0 if not, -1 on error.
+int breezy_udp_sender_poll(BreezyUdpSender *sender);
+
+BreezyUdpStreamSettings breezy_udp_sender_settings(const BreezyUdpSender *sender);
+BreezyUdpSenderStats breezy_udp_sender_stats(const BreezyUdpSender *sender);
+
+// max_frame_size bounds the frames it can assemble. Returns NULL on failure.
+BreezyUdpReceiver *breezy_udp_receiver_create(int fd, uint32_t max_frame_size);
+void breezy_udp_receiver_destroy(BreezyUdpReceiver *receiver);
+
+// Reads pending packets until a frame completes. Returns 1 with the frame (valid until
+// the next call), 0 if none is ready, -1 on error. Also sends the periodic report.
+int breezy_udp_receiver_poll(BreezyUdpReceiver *receiver, const uint8_t **frame, uint32_t *size,
+                             uint32_t *frame_id);
+
+// Time the client took to decode a frame, for the next report
+void breezy_udp_receiver_report_decode(BreezyUdpReceiver *receiver, float decode_ms);
+
+BreezyUdpReceiverStats breezy_udp_receiver_stats(const BreezyUdpReceiver *receiver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BREEZY_UDP_TRANSPORT_H */
@@ -0,0 +1,462 @@
+/*
+ * UDP transport loopback harness
+ *
+ * Runs a sender and a receiver over 127.0.0.1 with an impairing relay between them,
+ * all in this process. The relay does what netem would: packet loss (Gilbert-Elliott,
+ * so losses can come in bursts), delay with jitter, a rate limit with a drop-tail
+ * queue. Reports travel back through it with the base delay only.
+ *
+ * Frames come from a stand-in encoder: their size follows the stream settings (JPEG
+ * quality, scale, fps) and their content is a pattern the receiver checks byte for
+ * byte, so a wrongly rebuilt fragment fails the run. The decode time reported back
+ * is modelled from the frame size. Latency is measured on the one clock both ends
+ * share here: frame sent -> frame complete, plus the modelled decode.
+ *
+ * Scenarios:
+ *   - 720p at fixed settings with 1% loss, without and then with parity: parity
+ *     must deliver at least 95% of frames, and clearly more than without
+ *   - 1080p60 at quality 90 into a 40 Mbit/s link with bursty loss, with fixed
+ *     settings and then adapting to a 40ms latency target: adapting must hold the
+ *     p90 latency near the target, deliver at least 20 fps, and beat fixed settings
+ *
+ * The relay socket needs a receive buffer big enough for the sender's bursts; the
+ * harness asks for one and warns if the system caps it (net.core.rmem_max).
+ * Exits 0 on success, 1 on failure.
+ *
+ * Usage: udp_transport_harness [seconds_per_scenario]
+ */
+
+#define _GNU_SOURCE
+#include "breezy_udp_transport.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_SECONDS 6
+#define SOCKET_BUFFER_BYTES (4 * 1024 * 1024)
+#define MAX_FRAME_SIZE (4 * 1024 * 1024)
+#define QUEUE_CAPACITY 8192
+#define MAX_PACKET 1500
+#define FRAME_HISTORY 1024
+#define MAX_LATENCY_SAMPLES 8192
+
+typedef struct {
+    const char *name;
+    int width;
+    int height;
+    BreezyUdpStreamSettings settings;
+    float latency_target_ms;  // 0 keeps the settings fixed
+    double loss;              // Long-run packet loss probability
+    double burst;             // Mean loss burst length in packets, 1 for independent losses
+    double delay_ms;
+    double jitter_ms;         // Uniform, +/-
+    double rate_mbps;         // 0 for unlimited
+    double queue_limit_ms;    // Drop-tail once this much is queued for the rate limit
+} Scenario;
+
+typedef struct {
+    int64_t release_ns;
+    uint16_t length;
+    uint8_t data[MAX_PACKET];
+} QueuedPacket;
+
+typedef struct {
+    QueuedPacket *packets;
+    uint32_t head;
+    uint32_t count;
+    int64_t last_release_ns;
+} PacketQueue;
+
+typedef struct {
+    int fd;
+    struct sockaddr_in sender;
+    struct sockaddr_in receiver;
+    PacketQueue forward;  // Sender -> receiver, impaired
+    PacketQueue reverse;  // Receiver -> sender, delay only
+    bool bad_state;       // Gilbert-Elliott loss state
+    int64_t link_free_ns; // When the rate-limited link finishes what's queued
+    uint64_t dropped_loss;
+    uint64_t dropped_queue;
+} Relay;
+
+typedef struct {
+    uint64_t frames_sent;
+    uint64_t frames_delivered;
+    uint64_t frames_measured;  // Sent in the second half
+    uint64_t delivered_measured;
+    uint64_t corrupt;
+    float latency_ms[MAX_LATENCY_SAMPLES];
+    uint32_t latency_count;
+    BreezyUdpStreamSettings final_settings;
+    BreezyUdpReceiverStats receiver;
+    BreezyUdpSenderStats sender;
+} Result;
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static double random_unit(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (double)(rng_state >> 11) / (double)(1ULL << 53);
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int open_socket(struct sockaddr_in *address) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(*address);
+    if (bind(fd, (struct sockaddr *)address, sizeof(*address)) != 0 ||
+        getsockname(fd, (struct sockaddr *)address, &length) != 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+
+    // The sender writes a whole frame at once; FORCE needs CAP_NET_ADMIN, so fall back to the capped size
+    int size = SOCKET_BUFFER_BYTES;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) != 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    int effective = 0;
+    length = sizeof(effective);
+    getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &effective, &length);
+    if (effective < SOCKET_BUFFER_BYTES) {
+        fprintf(stderr, "[Harness] Warning: receive buffer capped at %d bytes (raise net.core.rmem_max); "
+                "large frames may overflow it before the simulated link\n", effective);
+    }
+    return fd;
+}
+
+static void queue_push(PacketQueue *queue, int64_t release_ns, const uint8_t *data, size_t length) {
+    if (queue->count == QUEUE_CAPACITY || length > MAX_PACKET) {
+        return;
+    }
+    // Kept in order: a packet never overtakes the one before it
+    if (release_ns < queue->last_release_ns) {
+        release_ns = queue->last_release_ns;
+    }
+    queue->last_release_ns = release_ns;
+
+    QueuedPacket *packet = &queue->packets[(queue->head + queue->count) % QUEUE_CAPACITY];
+    packet->release_ns = release_ns;
+    packet->length = (uint16_t)length;
+    memcpy(packet->data, data, length);
+    queue->count++;
+}
+
+static void queue_release(PacketQueue *queue, int fd, const struct sockaddr_in *to, int64_t now) {
+    while (queue->count && queue->packets[queue->head].release_ns <= now) {
+        QueuedPacket *packet = &queue->packets[queue->head];
+        sendto(fd, packet->data, packet->length, 0, (const struct sockaddr *)to, sizeof(*to));
+        queue->head = (queue->head + 1) % QUEUE_CAPACITY;
+        queue->count--;
+    }
+}
+
+// Decides a forwarded packet's fate; returns its release time or -1 if it's dropped
+static int64_t impair(Relay *relay, const Scenario *scenario, size_t length, int64_t now) {
+    if (scenario->loss > 0.0) {
+        double leave_bad = 1.0 / scenario->burst;
+        double enter_bad = scenario->loss * leave_bad / (1.0 - scenario->loss);
+        relay->bad_state = relay->bad_state ? random_unit() >= leave_bad : random_unit() < enter_bad;
+        if (relay->bad_state) {
+            relay->dropped_loss++;
+            return -1;
+        }
+    }
+
+    int64_t depart_ns = now;
+    if (scenario->rate_mbps > 0.0) {
+        int64_t start_ns = relay->link_free_ns > now ? relay->link_free_ns : now;
+        if ((double)(start_ns - now) / 1e6 > scenario->queue_limit_ms) {
+            relay->dropped_queue++;
+            return -1;
+        }
+        relay->link_free_ns = start_ns + (int64_t)((double)length * 8.0 * 1000.0 / scenario->rate_mbps);
+        depart_ns = relay->link_free_ns;
+    }
+
+    double jitter_ms = scenario->jitter_ms * (2.0 * random_unit() - 1.0);
+    return depart_ns + (int64_t)((scenario->delay_ms + jitter_ms) * 1e6);
+}
+
+static void relay_pump(Relay *relay, const Scenario *scenario, int64_t now) {
+    uint8_t buffer[MAX_PACKET];
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t from_length = sizeof(from);
+        ssize_t length = recvfrom(relay->fd, buffer, sizeof(buffer), 0, (struct sockaddr *)&from, &from_length);
+        if (length < 0) {
+            break;
+        }
+
+        if (from.sin_port == relay->sender.sin_port) {
+            int64_t release_ns = impair(relay, scenario, (size_t)length, now);
+            if (release_ns >= 0) {
+                queue_push(&relay->forward, release_ns, buffer, (size_t)length);
+            }
+        } else {
+            queue_push(&relay->reverse, now + (int64_t)(scenario->delay_ms * 1e6), buffer, (size_t)length);
+        }
+    }
+    queue_release(&relay->forward, relay->fd, &relay->receiver, now);
+    queue_release(&relay->reverse, relay->fd, &relay->sender, now);
+}
+
+// Stand-in for a JPEG encoder: roughly 0.4 bits per pixel at low quality, 3 near the top
+static uint32_t encoded_size(const Scenario *scenario, const BreezyUdpStreamSettings *settings) {
+    double quality = settings->jpeg_quality / 100.0;
+    double bits_per_pixel = 0.4 + 3.0 * quality * quality * quality;
+    double pixels = (double)scenario->width * settings->scale * (double)scenario->height * settings->scale;
+    uint32_t size = (uint32_t)(pixels * bits_per_pixel / 8.0);
+    return size < 8 ? 8 : size > MAX_FRAME_SIZE ? MAX_FRAME_SIZE : size;
+}
+
+static uint8_t pattern_byte(uint32_t frame, uint32_t i) {
+    return (uint8_t)(frame * 131u + i * 7u + (i >> 9));
+}
+
+static void fill_frame(uint8_t *frame, uint32_t size, uint32_t number) {
+    memcpy(frame, &number, sizeof(number));
+    memcpy(frame + 4, &size, sizeof(size));
+    for (uint32_t i = 8; i < size; i++) {
+        frame[i] = pattern_byte(number, i);
+    }
+}
+
+static bool check_frame(const uint8_t *frame, uint32_t size, uint32_t *number) {
+    uint32_t stored_size;
+    memcpy(number, frame, sizeof(*number));
+    memcpy(&stored_size, frame + 4, sizeof(stored_size));
+    if (stored_size != size) {
+        return false;
+    }
+    for (uint32_t i = 8; i < size; i++) {
+        if (frame[i] != pattern_byte(*number, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static float modelled_decode_ms(uint32_t size) {
+    return 1.0f + (float)size / 200000.0f;  // ~200 MB/s plus fixed overhead
+}
+
+static int compare_floats(const void *a, const void *b) {
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static float percentile(float *values, uint32_t count, float p) {
+    if (count == 0) {
+        return INFINITY;
+    }
+    qsort(values, count, sizeof(float), compare_floats);
+    uint32_t index = (uint32_t)(p * (float)count);
+    return values[index < count ? index : count - 1];
+}
+
+static int run_scenario(const Scenario *scenario, double seconds, Result *result) {
+    memset(result, 0, sizeof(*result));
+
+    Relay relay = { 0 };
+    struct sockaddr_in relay_address;
+    int sender_fd = open_socket(&relay.sender);
+    int receiver_fd = open_socket(&relay.receiver);
+    relay.fd = open_socket(&relay_address);
+    relay.forward.packets = malloc(QUEUE_CAPACITY * sizeof(QueuedPacket));
+    relay.reverse.packets = malloc(QUEUE_CAPACITY * sizeof(QueuedPacket));
+    uint8_t *frame = malloc(MAX_FRAME_SIZE);
+    BreezyUdpSender *sender = NULL;
+    BreezyUdpReceiver *receiver = NULL;
+    int status = -1;
+    if (sender_fd < 0 || receiver_fd < 0 || relay.fd < 0 || !relay.forward.packets || !relay.reverse.packets || !frame) {
+        goto out;
+    }
+
+    sender = breezy_udp_sender_create(sender_fd, (struct sockaddr *)&relay_address, sizeof(relay_address),
+                                      &scenario->settings, scenario->latency_target_ms);
+    receiver = breezy_udp_receiver_create(receiver_fd, MAX_FRAME_SIZE);
+    if (!sender || !receiver) {
+        fprintf(stderr, "[Harness] Failed to create the transport\n");
+        goto out;
+    }
+
+    int64_t sent_at_ns[FRAME_HISTORY];
+    int64_t start_ns = now_ns();
+    int64_t measure_from_ns = start_ns + (int64_t)(seconds * 0.5e9);
+    int64_t end_ns = start_ns + (int64_t)(seconds * 1e9);
+    int64_t next_frame_ns = start_ns;
+    uint32_t frame_number = 0;
+
+    for (int64_t now = start_ns; now < end_ns; now = now_ns()) {
+        if (now >= next_frame_ns) {
+            BreezyUdpStreamSettings settings = breezy_udp_sender_settings(sender);
+            uint32_t size = encoded_size(scenario, &settings);
+            fill_frame(frame, size, frame_number);
+            sent_at_ns[frame_number % FRAME_HISTORY] = now;
+            if (breezy_udp_sender_send_frame(sender, frame, size) != 0) {
+                fprintf(stderr, "[Harness] Send failed: %s\n", strerror(errno));
+                goto out;
+            }
+            result->frames_sent++;
+            result->frames_measured += now >= measure_from_ns;
+            frame_number++;
+            next_frame_ns += 1000000000LL / settings.fps;
+            if (next_frame_ns < now) {
+                next_frame_ns = now;
+            }
+        }
+
+        relay_pump(&relay, scenario, now);
+
+        const uint8_t *received;
+        uint32_t size;
+        uint32_t frame_id;
+        int polled;
+        while ((polled = breezy_udp_receiver_poll(receiver, &received, &size, &frame_id)) == 1) {
+            uint32_t number;
+            if (!check_frame(received, size, &number)) {
+                result->corrupt++;
+                continue;
+            }
+            float decode_ms = modelled_decode_ms(size);
+            breezy_udp_receiver_report_decode(receiver, decode_ms);
+            result->frames_delivered++;
+
+            int64_t sent_ns = sent_at_ns[number % FRAME_HISTORY];
+            if (sent_ns >= measure_from_ns) {
+                result->delivered_measured++;
+                if (result->latency_count < MAX_LATENCY_SAMPLES) {
+                    result->latency_ms[result->latency_count++] = (float)(now_ns() - sent_ns) / 1e6f + decode_ms;
+                }
+            }
+        }
+        if (polled < 0 || breezy_udp_sender_poll(sender) < 0) {
+            fprintf(stderr, "[Harness] Poll failed: %s\n", strerror(errno));
+            goto out;
+        }
+
+        struct timespec pause = { .tv_sec = 0, .tv_nsec = 100000 };
+        nanosleep(&pause, NULL);
+    }
+
+    result->final_settings = breezy_udp_sender_settings(sender);
+    result->receiver = breezy_udp_receiver_stats(receiver);
+    result->sender = breezy_udp_sender_stats(sender);
+    status = 0;
+
+out:
+    breezy_udp_sender_destroy(sender);
+    breezy_udp_receiver_destroy(receiver);
+    free(frame);
+    free(relay.forward.packets);
+    free(relay.reverse.packets);
+    if (sender_fd >= 0) close(sender_fd);
+    if (receiver_fd >= 0) close(receiver_fd);
+    if (relay.fd >= 0) close(relay.fd);
+    return status;
+}
+
+static void print_result(const Scenario *scenario, Result *result, float *p50, float *p90) {
+    double delivered = result->frames_measured ? (double)result->delivered_measured / (double)result->frames_measured : 0.0;
+    *p50 = percentile(result->latency_ms, result->latency_count, 0.5f);
+    *p90 = percentile(result->latency_ms, result->latency_count, 0.9f);
+    printf("[Harness] %s\n", scenario->name);
+    printf("  frames: %llu sent, %llu delivered (%.1f%% in the second half), %llu corrupt\n",
+           (unsigned long long)result->frames_sent, (unsigned long long)result->frames_delivered,
+           delivered * 100.0, (unsigned long long)result->corrupt);
+    printf("  packets: %llu received, %llu lost, %llu rebuilt from parity; %llu frames abandoned\n",
+           (unsigned long long)result->receiver.packets_received, (unsigned long long)result->receiver.packets_lost,
+           (unsigned long long)result->receiver.fragments_recovered,
+           (unsigned long long)result->receiver.frames_abandoned);
+    printf("  latency ms (second half): p50 %.1f, p90 %.1f; sender estimate %.1f (rtt %.1f, queue %.1f, jitter %.2f)\n",
+           *p50, *p90, result->sender.latency_ms, result->sender.rtt_ms, result->sender.queue_delay_ms,
+           result->sender.jitter_ms);
+    printf("  settings at the end: quality %d, scale %.2f, %d fps, parity every %d\n",
+           result->final_settings.jpeg_quality, result->final_settings.scale, result->final_settings.fps,
+           result->final_settings.fec_group);
+}
+
+static double delivered_fraction(const Result *result) {
+    return result->frames_measured ? (double)result->delivered_measured / (double)result->frames_measured : 0.0;
+}
+
+static bool check(bool condition, const char *what) {
+    if (!condition) {
+        printf("[Harness] FAIL: %s\n", what);
+    }
+    return condition;
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : DEFAULT_SECONDS;
+    if (seconds <= 0.0) {
+        fprintf(stderr, "Usage: %s [seconds_per_scenario]\n", argv[0]);
+        return 1;
+    }
+
+    static const Scenario scenarios[] = {
+        { "720p30 fixed, 1% loss, no parity", 1280, 720, { 50, 1.0f, 30, 0 }, 0.0f,
+          0.01, 1.0, 5.0, 1.0, 0.0, 0.0 },
+        { "720p30 fixed, 1% loss, parity every 4", 1280, 720, { 50, 1.0f, 30, 4 }, 0.0f,
+          0.01, 1.0, 5.0, 1.0, 0.0, 0.0 },
+        { "1080p60 fixed, 40 Mbit/s, 1% loss in bursts", 1920, 1080, { 90, 1.0f, 60, 16 }, 0.0f,
+          0.01, 2.0, 5.0, 2.0, 40.0, 150.0 },
+        { "1080p60 adaptive to 40ms, 40 Mbit/s, 1% loss in bursts", 1920, 1080, { 90, 1.0f, 60, 16 }, 40.0f,
+          0.01, 2.0, 5.0, 2.0, 40.0, 150.0 },
+    };
+    enum { NO_PARITY, PARITY, FIXED, ADAPTIVE, SCENARIO_COUNT };
+
+    static Result results[SCENARIO_COUNT];
+    float p50[SCENARIO_COUNT];
+    float p90[SCENARIO_COUNT];
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        if (run_scenario(&scenarios[i], seconds, &results[i]) != 0) {
+            return 1;
+        }
+        print_result(&scenarios[i], &results[i], &p50[i], &p90[i]);
+    }
+
+    bool ok = true;
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        ok &= check(results[i].corrupt == 0, "a delivered frame didn't match what was sent");
+    }
+    ok &= check(delivered_fraction(&results[PARITY]) >= 0.95, "parity delivered under 95% of frames at 1% loss");
+    ok &= check(delivered_fraction(&results[PARITY]) > delivered_fraction(&results[NO_PARITY]) + 0.2,
+                "parity didn't clearly beat no parity");
+    ok &= check(p90[ADAPTIVE] <= scenarios[ADAPTIVE].latency_target_ms * 1.25f,
+                "adaptive p90 latency more than 25% over the target");
+    ok &= check(p90[ADAPTIVE] < p90[FIXED], "adapting didn't lower latency over fixed settings");
+    ok &= check((double)results[ADAPTIVE].delivered_measured / (seconds * 0.5) >= 20.0,
+                "adaptive delivered under 20 fps");
+
+    printf("[Harness] %s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
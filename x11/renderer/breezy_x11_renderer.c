@@ -27,12 +27,16 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <dirent.h>
+#include <poll.h>
 #include <math.h>
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/Xrandr.h>
+#include <X11/extensions/dpms.h>
+#include <sys/eventfd.h>
 
 #define GL_GLEXT_PROTOTYPES
 #include <GL/gl.h>
@@ -50,6 +54,8 @@
 
 #include "breezy_x11_renderer.h"
 #include "logging.h"
+#include "capture_ipc.h"
+#include "breezy_alloc_trace.h"
 #include "../../shared/math/breezy_math.h"
 
 // Forward declarations
@@ -58,9 +64,25 @@ typedef struct FrameBuffer FrameBuffer;
 
 // Frame buffer structure (lock-free ring buffer for maximum performance)
 #define RING_BUFFER_SIZE 3  // Triple buffering
+#define RENDER_WAKE_MARGIN_NS 1000000LL  // Slack between render completion and the vblank it targets
+#define DEFAULT_FRAME_PERIOD_NS (1000000000LL / 60)  // Used when RandR reports no usable mode
+
+// Power management thresholds
+#define IDLE_POSE_AGE_MS 500            // No new pose for this long: glasses still or driver stalled
+#define SUSPEND_POSE_AGE_MS 5000        // No new pose for this long: glasses unplugged
+#define IDLE_FRAME_PERIOD_NS 100000000LL  // 10Hz capture/render while idle
+
+// Look-ahead calibration: set to measure the present latency and save a per-device profile
+#define CALIBRATE_LOOK_AHEAD_ENV "BREEZY_CALIBRATE_LOOK_AHEAD"
+#define CALIBRATION_FRAMES 600  // ~5-10s of frames, enough for stable percentiles
+
+// Headless latency mode (headless.c, tests/latency_harness.c): set to a results file path
+#define HEADLESS_ENV "BREEZY_RENDERER_HEADLESS"
+#define DISABLE_PREDICTION_ENV "BREEZY_DISABLE_PREDICTION"  // Render the latest pose, no look-ahead
+#define HUD_ENV "BREEZY_RENDERER_HUD"  // Start with the performance HUD shown (SIGUSR1 toggles it)
 
 struct FrameBuffer {
-    uint32_t width;
+    uint32_t width;   // Size at init; the captured size is per slot below
     uint32_t height;
     uint32_t stride;
 
@@ -69,11 +91,33 @@ struct FrameBuffer {
     uint32_t write_index;  // Atomic access
     uint32_t read_index;   // Atomic access
 
-    // Frame metadata
+    // Frame metadata, published with write_index
     struct timespec timestamps[RING_BUFFER_SIZE];
+    uint32_t widths[RING_BUFFER_SIZE];
+    uint32_t heights[RING_BUFFER_SIZE];
     uint32_t frame_count;
 };
 
+// Power state machine
+//   ACTIVE:    fresh poses, display on - capture and render at full rate
+//   IDLE:      driver enabled but no new pose recently - capture and render at IDLE_FRAME_PERIOD_NS
+//   SUSPENDED: driver disabled, pose stale for SUSPEND_POSE_AGE_MS or display powered off (DPMS) -
+//              capture and render threads block until the main loop sees a wake event (the
+//              driver's pose doorbell, or a per-frame poll for drivers without one)
+typedef enum {
+    POWER_STATE_ACTIVE,
+    POWER_STATE_IDLE,
+    POWER_STATE_SUSPENDED
+} PowerState;
+
+typedef struct PowerControl {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    volatile PowerState state;
+    uint64_t last_pose_id;  // Sample time (or epoch, for drivers without one) of the newest pose seen
+    int64_t last_pose_ns;   // CLOCK_MONOTONIC when that pose was sampled, 0 before the first
+} PowerControl;
+
 // DeviceConfig, IMUData, IMUReader, CaptureThread, RenderThread are all defined in breezy_x11_renderer.h
 
 // CaptureThread and RenderThread are fully defined in breezy_x11_renderer.h
@@ -98,13 +142,28 @@ struct Renderer {
     // Configuration
     uint32_t virtual_width;
     uint32_t virtual_height;
-    uint32_t virtual_framerate;
-    uint32_t render_refresh_rate;
+    double capture_rate_override;  // Hz, 0 = use the virtual output's mode timing
+    double render_rate_override;   // Hz, 0 = use the glasses output's mode timing
 
     // Device configuration (cached, updated periodically)
     DeviceConfig device_config;
     uint64_t last_config_update_ms;
 
+    // Calibrated look-ahead for the connected device (look_ahead_profile.c), kept by the main loop
+    char device_key[256];                // "" while no device is connected
+    volatile float look_ahead_offset_ms; // Correction to the driver's constant, 0 if the device has no profile
+    volatile float calibrated_offset_ms; // Finished calibration waiting to be saved once calibration_ready
+    volatile bool calibration_ready;
+
+    const char *headless_results_path;  // NULL unless running headless
+    bool prediction_disabled;
+    bool hud_requested;                        // HUD shown at startup
+    volatile sig_atomic_t hud_toggle_count;    // Bumped by SIGUSR1, applied by the render thread
+
+    PowerControl power;
+
+    int64_t startup_ns;  // CLOCK_MONOTONIC at launch, for the startup phase timings
+
     // Control
     bool running;
     pthread_mutex_t control_lock;
@@ -115,6 +174,8 @@ struct Renderer {
 
 static void *capture_thread_func(void *arg);
 static void *capture_keepalive_thread_func(void *arg);
+static void *capture_client_thread_func(void *arg);
+static void *headless_source_thread_func(void *arg);
 static int init_capture_thread(CaptureThread *thread, Renderer *renderer);
 static void cleanup_capture_thread(CaptureThread *thread);
 
@@ -128,7 +189,63 @@ static int init_frame_buffer(FrameBuffer *fb, uint32_t width, uint32_t height);
 static void cleanup_frame_buffer(FrameBuffer *fb);
 static bool write_frame(FrameBuffer *fb, const uint8_t *data, uint32_t width, uint32_t height);
 static bool read_latest_frame(FrameBuffer *fb, uint8_t **data, struct timespec *timestamp);
+static void latest_frame_size(FrameBuffer *fb, uint32_t *width, uint32_t *height);
+
+
+static int64_t monotonic_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Sleep until an absolute CLOCK_MONOTONIC deadline (returns immediately if it already passed)
+static void sleep_until_ns(int64_t deadline_ns) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000LL),
+        .tv_nsec = (long)(deadline_ns % 1000000000LL)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
 
+static const char *power_state_name(PowerState state) {
+    switch (state) {
+        case POWER_STATE_ACTIVE: return "ACTIVE";
+        case POWER_STATE_IDLE: return "IDLE";
+        case POWER_STATE_SUSPENDED: return "SUSPENDED";
+    }
+    return "UNKNOWN";
+}
+
+// Block the calling worker thread while suspended; returns the state it may run in
+static PowerState power_wait_until_runnable(PowerControl *power, volatile bool *stop_requested) {
+    pthread_mutex_lock(&power->lock);
+    while (power->state == POWER_STATE_SUSPENDED && !*stop_requested) {
+        pthread_cond_wait(&power->wake, &power->lock);
+    }
+    PowerState state = power->state;
+    pthread_mutex_unlock(&power->lock);
+    return state;
+}
+
+static void power_set_state(PowerControl *power, PowerState state, const char *reason) {
+    pthread_mutex_lock(&power->lock);
+    PowerState previous = power->state;
+    power->state = state;
+    pthread_cond_broadcast(&power->wake);
+    pthread_mutex_unlock(&power->lock);
+
+    if (previous != state) {
+        log_info("[Power] %s -> %s (%s)\n", power_state_name(previous), power_state_name(state), reason);
+    }
+}
+
+// Wake any blocked worker (used on shutdown)
+static void power_wake_all(PowerControl *power) {
+    pthread_mutex_lock(&power->lock);
+    pthread_cond_broadcast(&power->wake);
+    pthread_mutex_unlock(&power->lock);
+}
 
 // Frame Buffer Implementation (Lock-free ring buffer)
 static int init_frame_buffer(FrameBuffer *fb, uint32_t width, uint32_t height) {
@@ -149,6 +266,8 @@ static int init_frame_buffer(FrameBuffer *fb, uint32_t width, uint32_t height) {
             return -1;
         }
         clock_gettime(CLOCK_MONOTONIC, &fb->timestamps[i]);
+        fb->widths[i] = width;
+        fb->heights[i] = height;
     }
 
     return 0;
@@ -165,10 +284,6 @@ static void cleanup_frame_buffer(FrameBuffer *fb) {
 static bool write_frame(FrameBuffer *fb, const uint8_t *data, uint32_t width, uint32_t height) {
     (void)data;  // Not used - DMA-BUF path doesn't copy pixel data here
 
-    if (width != fb->width || height != fb->height) {
-        return false;
-    }
-
     // Lock-free write: advance write index
     uint32_t next_write = (fb->write_index + 1) % RING_BUFFER_SIZE;
 
@@ -176,8 +291,14 @@ static bool write_frame(FrameBuffer *fb, const uint8_t *data, uint32_t width, ui
     // data can be NULL - this is just a marker that a new frame is available
     // The actual frame is accessed via DMA-BUF in the render thread
 
-    // Update timestamp
+    // Update timestamp and size. No pixels are stored, so a capture at another size (the
+    // virtual output's mode isn't the one given on the command line, or it changed) is just
+    // recorded in the slot, published with the index below so readers never pair a new size
+    // with an old frame. Dropping the write would stop frame_count, which the mip chain,
+    // headless content and HUD follow.
     clock_gettime(CLOCK_MONOTONIC, &fb->timestamps[next_write]);
+    fb->widths[next_write] = width;
+    fb->heights[next_write] = height;
 
     // Atomic update of write index (capture thread only writes)
     __sync_synchronize();  // Memory barrier
@@ -208,6 +329,30 @@ static bool read_latest_frame(FrameBuffer *fb, uint8_t **data, struct timespec *
     return true;  // Always return true if write_index is valid
 }
 
+// Size of the latest published frame
+static void latest_frame_size(FrameBuffer *fb, uint32_t *width, uint32_t *height) {
+    __sync_synchronize();  // Memory barrier
+    uint32_t read_idx = fb->write_index;
+    *width = fb->widths[read_idx];
+    *height = fb->heights[read_idx];
+}
+
+// Grow the render thread's pending damage to cover a newly captured region (caller holds dmabuf_mutex)
+static void add_pending_damage(RenderThread *render_thread, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    DamageRect *damage = &render_thread->pending_damage;
+    if (damage->width == 0 || damage->height == 0) {
+        *damage = (DamageRect){ x, y, width, height };
+        return;
+    }
+
+    uint32_t x1 = damage->x + damage->width > x + width ? damage->x + damage->width : x + width;
+    uint32_t y1 = damage->y + damage->height > y + height ? damage->y + damage->height : y + height;
+    damage->x = damage->x < x ? damage->x : x;
+    damage->y = damage->y < y ? damage->y : y;
+    damage->width = x1 - damage->x;
+    damage->height = y1 - damage->y;
+}
+
 // Keep-alive thread function for capture thread (runs independently, doesn't block frame capture)
 // This ensures keep-alive queries don't interrupt 120Hz frame capture timing
 static void *capture_keepalive_thread_func(void *arg) {
@@ -227,21 +372,173 @@ static void *capture_keepalive_thread_func(void *arg) {
     return NULL;
 }
 
+// Hand a captured framebuffer to the render thread (shared by in-process capture and the
+// capture service client). Only duplicates the DMA-BUF FD when the framebuffer changed,
+// otherwise the render thread keeps reusing its EGL image. service_frame tags the capture
+// service frame for the ACK (0 in-process). Returns false if the FD could not be duplicated.
+static bool hand_off_dmabuf(Renderer *renderer, int dmabuf_fd, uint32_t fb_id,
+                            uint32_t width, uint32_t height, uint32_t format,
+                            uint32_t stride, uint64_t modifier, uint64_t service_frame) {
+    RenderThread *render_thread = &renderer->render_thread;
+
+    // Lock mutex to protect shared DMA-BUF data
+    pthread_mutex_lock(&render_thread->dmabuf_mutex);
+
+    // Check if framebuffer changed (need to update EGL image)
+    if (fb_id != render_thread->current_fb_id) {
+        // Duplicate FD for render thread (it closes its copy once imported)
+        int dmabuf_fd_dup = dup(dmabuf_fd);
+        if (dmabuf_fd_dup < 0) {
+            pthread_mutex_unlock(&render_thread->dmabuf_mutex);
+            log_error("[Capture] Failed to duplicate DMA-BUF FD: %s\n", strerror(errno));
+            return false;
+        }
+
+        // Close old FD if the render thread never consumed it
+        if (render_thread->current_dmabuf_fd >= 0) {
+            close(render_thread->current_dmabuf_fd);
+        }
+
+        render_thread->current_dmabuf_fd = dmabuf_fd_dup;
+        render_thread->current_fb_id = fb_id;
+        render_thread->current_width = width;
+        render_thread->current_height = height;
+        render_thread->current_format = format;
+        render_thread->current_stride = stride;
+        render_thread->current_modifier = modifier;
+        render_thread->fb_changed = true;  // Signal render thread to create new EGL image
+    }
+
+    // KMS scanout gives us no damage information, so every capture tick dirties the whole frame
+    add_pending_damage(render_thread, 0, 0, width, height);
+    render_thread->current_service_frame = service_frame;
+
+    pthread_mutex_unlock(&render_thread->dmabuf_mutex);
+
+    // Signal new frame available (marker frame - no pixel copy)
+    uint8_t *dummy = NULL;  // No pixel data - render thread uses DMA-BUF
+    write_frame(&renderer->frame_buffer, dummy, width, height);
+    return true;
+}
+
+// Capture service client: receives framebuffers and frame ticks from breezy_capture_service
+// instead of querying RandR/DRM in this process. Reconnects if the service restarts.
+static void *capture_client_thread_func(void *arg) {
+    CaptureThread *thread = (CaptureThread *)arg;
+
+    log_info("[Capture] Receiving frames from capture service\n");
+
+    // Framebuffer currently described by the service (we own fb_fd)
+    int fb_fd = -1;
+    CaptureMessage format = {0};
+    uint32_t generation = 1;    // Bumped per connection, tags frames handed to the render thread
+    uint64_t acked_frame = 0;
+
+    while (!thread->stop_requested) {
+        // While suspended, stop consuming; the service skips us once our in-flight window is full
+        power_wait_until_runnable(&thread->renderer->power, &thread->stop_requested);
+        if (thread->stop_requested) {
+            break;
+        }
+
+        if (thread->service_fd < 0) {
+            struct timespec sleep_time = { .tv_sec = 1, .tv_nsec = 0 };
+            nanosleep(&sleep_time, NULL);
+            thread->service_fd = capture_ipc_connect(CAPTURE_IPC_DEFAULT_MAX_IN_FLIGHT);
+            continue;
+        }
+
+        // Bounded wait so stop requests are noticed
+        struct pollfd pfds[2] = {
+            { .fd = thread->service_fd, .events = POLLIN },
+            { .fd = thread->ack_event_fd, .events = POLLIN },
+        };
+        int ready = poll(pfds, thread->ack_event_fd >= 0 ? 2 : 1, 100);
+        if (ready <= 0) {
+            continue;
+        }
+
+        // The render thread presented a frame: ACK it, unless it came from an earlier connection
+        if (pfds[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t drained = read(thread->ack_event_fd, &count, sizeof(count));
+            (void)drained;
+            uint64_t presented = atomic_load_explicit(&thread->presented_service_frame, memory_order_acquire);
+            if ((uint32_t)(presented >> 32) == generation && presented != acked_frame) {
+                CaptureMessage ack;
+                capture_ipc_message_init(&ack, CAPTURE_MSG_ACK);
+                ack.sequence = (uint32_t)presented;
+                if (capture_ipc_send(thread->service_fd, &ack, -1) == 0) {
+                    acked_frame = presented;
+                }
+            }
+        }
+        if (!pfds[0].revents) {
+            continue;
+        }
+
+        CaptureMessage msg;
+        int passed_fd = -1;
+        if (capture_ipc_recv(thread->service_fd, &msg, &passed_fd) != 0) {
+            log_warn("[Capture] Lost connection to capture service, reconnecting\n");
+            close(thread->service_fd);
+            thread->service_fd = -1;
+            // Sequences restart with the new connection; frames still tagged with this
+            // generation are never ACKed on it
+            generation++;
+            atomic_store_explicit(&thread->presented_service_frame, 0, memory_order_release);
+            acked_frame = 0;
+            continue;
+        }
+
+        if (msg.type == CAPTURE_MSG_FORMAT) {
+            if (passed_fd < 0) {
+                log_warn("[Capture] FORMAT message without DMA-BUF FD\n");
+                continue;
+            }
+            if (fb_fd >= 0) {
+                close(fb_fd);
+            }
+            fb_fd = passed_fd;
+            format = msg;
+            log_info("[Capture] Capture service framebuffer: %ux%u, FB ID %u\n", msg.width, msg.height, msg.fb_id);
+        } else if (msg.type == CAPTURE_MSG_FRAME) {
+            if (passed_fd >= 0) {
+                close(passed_fd);
+            }
+            if (fb_fd < 0 || msg.fb_id != format.fb_id) {
+                continue;
+            }
+            hand_off_dmabuf(thread->renderer, fb_fd, format.fb_id, format.width, format.height,
+                            format.format, format.stride, format.modifier,
+                            ((uint64_t)generation << 32) | msg.sequence);
+        } else if (passed_fd >= 0) {
+            close(passed_fd);
+        }
+    }
+
+    if (fb_fd >= 0) {
+        close(fb_fd);
+    }
+
+    log_info("[Capture] Capture service client stopping\n");
+    return NULL;
+}
+
 // Capture Thread Implementation
 static void *capture_thread_func(void *arg) {
     CaptureThread *thread = (CaptureThread *)arg;
 
-    log_info("[Capture] Thread started for %dx%d@%dHz\n",
-             thread->width, thread->height, thread->framerate);
+    log_info("[Capture] Thread started for %dx%d@%.3fHz\n",
+             thread->width, thread->height, 1e9 / (double)thread->frame_period_ns);
 
-    const double frame_time = 1.0 / thread->framerate;
-    struct timespec next_frame_time;
-    clock_gettime(CLOCK_MONOTONIC, &next_frame_time);
+    int64_t next_frame_ns = monotonic_now_ns();
 
     // Start keep-alive thread (runs independently, doesn't block frame capture)
     // This ensures keep-alive queries don't interrupt 120Hz frame capture timing
     pthread_t keepalive_thread = 0;
     bool keepalive_thread_started = false;
+    bool refresh_failing = false;
     if (pthread_create(&keepalive_thread, NULL, capture_keepalive_thread_func, thread) == 0) {
         keepalive_thread_started = true;
     } else {
@@ -249,110 +546,42 @@ static void *capture_thread_func(void *arg) {
     }
 
     while (!thread->stop_requested) {
-        // Check if framebuffer still exists (lightweight check for mode changes)
-        // If FB was destroyed/changed, cached_dmabuf_fd will be invalid
-        drmModeFBPtr fb_check = drmModeGetFB(thread->drm_fd, thread->fb_id);
-        if (!fb_check) {
-            // Framebuffer changed (resolution/mode switch) - re-initialize DRM capture
-            log_info("[Capture] Framebuffer changed (FB ID %u invalidated), re-initializing DRM capture\n", thread->fb_id);
-
-            // Cleanup old framebuffer info and cached DMA-BUF FD
-            cleanup_drm_capture(thread);
-
-            // Re-initialize with new framebuffer ID (will export new DMA-BUF FD)
-            if (init_drm_capture(thread) < 0) {
-                log_error("[Capture] Failed to reinitialize DRM capture after framebuffer change\n");
-                // Wait a bit before retrying
-                struct timespec sleep_time = { .tv_sec = 0, .tv_nsec = 10000000 };  // 10ms
-                nanosleep(&sleep_time, NULL);
-                continue;
-            } else {
-                log_info("[Capture] Successfully reinitialized DRM capture with new framebuffer ID %u\n", thread->fb_id);
-            }
-        } else {
-            drmModeFreeFB(fb_check);
+        PowerState power_state = power_wait_until_runnable(&thread->renderer->power, &thread->stop_requested);
+        if (thread->stop_requested) {
+            break;
         }
 
-        // Reuse cached DMA-BUF FD (exported once during init, reused for all frames)
-        // Only pass FD to render thread when framebuffer changes (optimization: reuse EGL image)
-        if (thread->cached_dmabuf_fd >= 0) {
-            RenderThread *render_thread = &thread->renderer->render_thread;
-
-            // Lock mutex to protect shared DMA-BUF data
-            pthread_mutex_lock(&render_thread->dmabuf_mutex);
-
-            // Check if framebuffer changed (need to update EGL image)
-            bool fb_changed = (thread->fb_id != render_thread->current_fb_id);
-
-            if (fb_changed) {
-                // Framebuffer changed - close old FD if exists and create new EGL image
-                if (render_thread->current_dmabuf_fd >= 0) {
-                    close(render_thread->current_dmabuf_fd);
-                }
-
-                // Duplicate cached FD for render thread (EGL will take ownership)
-                int dmabuf_fd_dup = dup(thread->cached_dmabuf_fd);
-                if (dmabuf_fd_dup >= 0) {
-                    render_thread->current_dmabuf_fd = dmabuf_fd_dup;
-                    render_thread->current_fb_id = thread->fb_id;
-                    render_thread->current_format = thread->cached_format;
-                    render_thread->current_stride = thread->cached_stride;
-                    render_thread->current_modifier = thread->cached_modifier;
-                    render_thread->fb_changed = true;  // Signal render thread to create new EGL image
-
-                    pthread_mutex_unlock(&render_thread->dmabuf_mutex);
-
-                    // Signal new frame available (marker frame - no pixel copy)
-                    uint8_t *dummy = NULL;  // No pixel data - render thread uses DMA-BUF
-                    write_frame(&thread->renderer->frame_buffer, dummy, thread->width, thread->height);
-                } else {
-                    pthread_mutex_unlock(&render_thread->dmabuf_mutex);
-                    log_error("[Capture] Failed to duplicate DMA-BUF FD: %s\n", strerror(errno));
-                    // Wait a bit before retrying
-                    struct timespec sleep_time = { .tv_sec = 0, .tv_nsec = 10000000 };  // 10ms
-                    nanosleep(&sleep_time, NULL);
-                }
-            } else {
-                // Framebuffer unchanged - reuse existing EGL image (no FD needed)
-                render_thread->fb_changed = false;
-                pthread_mutex_unlock(&render_thread->dmabuf_mutex);
-
-                // Signal new frame available (render thread will reuse existing EGL image)
-                uint8_t *dummy = NULL;  // No pixel data - render thread uses DMA-BUF
-                write_frame(&thread->renderer->frame_buffer, dummy, thread->width, thread->height);
-            }
-        } else {
-            // Cached FD not available - should not happen after successful init
-            log_warn("[Capture] Cached DMA-BUF FD not available, re-initializing\n");
-            cleanup_drm_capture(thread);
-            if (init_drm_capture(thread) < 0) {
-                struct timespec sleep_time = { .tv_sec = 0, .tv_nsec = 10000000 };  // 10ms
-                nanosleep(&sleep_time, NULL);
+        // Lightweight check for mode changes; rebinds (and re-exports) if the FB was replaced.
+        // A failure is retried on the next tick, which is when the new FB is next needed anyway.
+        int refreshed = drm_capture_refresh(thread);
+        if (refreshed < 0) {
+            if (!refresh_failing) {
+                log_error("[Capture] Lost the framebuffer, retrying every tick\n");
             }
+            refresh_failing = true;
+        } else if (refreshed > 0 || refresh_failing) {
+            log_info("[Capture] Capturing framebuffer ID %u (%dx%d)\n", thread->fb_id, thread->width, thread->height);
+            refresh_failing = false;
         }
 
-        // Sleep until next frame
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-
-        double elapsed = (now.tv_sec - next_frame_time.tv_sec) +
-                        (now.tv_nsec - next_frame_time.tv_nsec) / 1e9;
-
-        if (elapsed < frame_time) {
-            struct timespec sleep_time = {
-                .tv_sec = 0,
-                .tv_nsec = (long)((frame_time - elapsed) * 1e9)
-            };
+        // Reuse cached DMA-BUF FD (exported once during init, reused for all frames)
+        // Only pass FD to render thread when framebuffer changes (optimization: reuse EGL image)
+        if (refreshed >= 0 &&
+            !hand_off_dmabuf(thread->renderer, thread->cached_dmabuf_fd, thread->fb_id,
+                             thread->width, thread->height, thread->cached_format,
+                             thread->cached_stride, thread->cached_modifier, 0)) {
+            // Wait a bit before retrying
+            struct timespec sleep_time = { .tv_sec = 0, .tv_nsec = 10000000 };  // 10ms
             nanosleep(&sleep_time, NULL);
         }
 
-        // Update next frame time
-        next_frame_time.tv_sec += (time_t)frame_time;
-        next_frame_time.tv_nsec += (long)((frame_time - (int)frame_time) * 1e9);
-        if (next_frame_time.tv_nsec >= 1000000000L) {
-            next_frame_time.tv_sec++;
-            next_frame_time.tv_nsec -= 1000000000L;
+        // Sleep until next tick of the virtual output (period follows mode changes)
+        next_frame_ns += power_state == POWER_STATE_IDLE ? IDLE_FRAME_PERIOD_NS : thread->frame_period_ns;
+        int64_t now_ns = monotonic_now_ns();
+        if (next_frame_ns < now_ns) {
+            next_frame_ns = now_ns;  // Fell behind - don't burst to catch up
         }
+        sleep_until_ns(next_frame_ns);
     }
 
     log_info("[Capture] Thread stopping\n");
@@ -365,6 +594,42 @@ static void *capture_thread_func(void *arg) {
     return NULL;
 }
 
+// Headless stand-in for capture: publishes a new numbered content frame every tick of the
+// capture rate; the render thread paints the number into the source texture
+static void *headless_source_thread_func(void *arg) {
+    CaptureThread *thread = (CaptureThread *)arg;
+    Renderer *renderer = thread->renderer;
+    RenderThread *render_thread = &renderer->render_thread;
+
+    log_info("[Headless] Content source started at %.3fHz\n", 1e9 / (double)thread->frame_period_ns);
+
+    int64_t next_frame_ns = monotonic_now_ns();
+    while (!thread->stop_requested) {
+        power_wait_until_runnable(&renderer->power, &thread->stop_requested);
+        if (thread->stop_requested) {
+            break;
+        }
+
+        pthread_mutex_lock(&render_thread->dmabuf_mutex);
+        add_pending_damage(render_thread, 0, 0, thread->width, thread->height);
+        pthread_mutex_unlock(&render_thread->dmabuf_mutex);
+
+        // write_frame bumps frame_count, which is the content frame number
+        write_frame(&renderer->frame_buffer, NULL, thread->width, thread->height);
+        headless_record_content(render_thread, renderer->frame_buffer.frame_count, monotonic_now_ns());
+
+        next_frame_ns += thread->frame_period_ns;
+        int64_t now_ns = monotonic_now_ns();
+        if (next_frame_ns < now_ns) {
+            next_frame_ns = now_ns;
+        }
+        sleep_until_ns(next_frame_ns);
+    }
+
+    log_info("[Headless] Content source stopping\n");
+    return NULL;
+}
+
 static int init_capture_thread(CaptureThread *thread, Renderer *renderer) {
     memset(thread, 0, sizeof(*thread));
     thread->renderer = renderer;
@@ -373,8 +638,31 @@ static int init_capture_thread(CaptureThread *thread, Renderer *renderer) {
     thread->thread_started = false;
     thread->drm_fd = -1;
     thread->cached_dmabuf_fd = -1;  // Initialize cached DMA-BUF FD to invalid
+    thread->service_fd = -1;
+    thread->ack_event_fd = -1;
+    atomic_init(&thread->presented_service_frame, 0);
     thread->connector_name = "XR-0";  // Default virtual connector name
 
+    // Headless frames come from headless_source_thread_func, not the virtual output
+    if (renderer->headless_results_path) {
+        thread->width = renderer->virtual_width;
+        thread->height = renderer->virtual_height;
+        return 0;
+    }
+
+    // Prefer a running capture service so the DRM work is shared with other sinks
+    thread->service_fd = capture_ipc_connect(CAPTURE_IPC_DEFAULT_MAX_IN_FLIGHT);
+    if (thread->service_fd >= 0) {
+        thread->ack_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (thread->ack_event_fd < 0) {
+            log_error("[Capture] Failed to create the ACK eventfd: %s\n", strerror(errno));
+            close(thread->service_fd);
+            thread->service_fd = -1;
+            return -1;
+        }
+        return 0;
+    }
+
     // Initialize DRM capture
     if (init_drm_capture(thread) < 0) {
         log_error("[Capture] Failed to initialize DRM capture\n");
@@ -392,22 +680,169 @@ static void cleanup_capture_thread(CaptureThread *thread) {
         thread->thread_started = false;
         thread->running = false;
     }
+    if (thread->service_fd >= 0) {
+        close(thread->service_fd);
+        thread->service_fd = -1;
+    }
+    if (thread->ack_event_fd >= 0) {
+        close(thread->ack_event_fd);
+        thread->ack_event_fd = -1;
+    }
     cleanup_drm_capture(thread);
     // Cleanup cached keep-alive Display connection
     drm_capture_cleanup_keepalive();
 }
 
+// Pick up the connected device's calibrated look-ahead when the device changes, and save a
+// finished calibration. Called from the main loop so the render thread never touches the files.
+static void update_look_ahead_profile(Renderer *renderer) {
+    if (renderer->calibration_ready) {
+        __sync_synchronize();
+        float offset_ms = renderer->calibrated_offset_ms;
+        renderer->calibration_ready = false;
+        if (renderer->device_key[0] && look_ahead_profile_save(renderer->device_key, offset_ms) == 0) {
+            renderer->look_ahead_offset_ms = offset_ms;
+        } else {
+            log_warn("[Calibration] No connected device reported by the driver - profile not saved\n");
+        }
+    }
+
+    char key[sizeof(renderer->device_key)];
+    if (look_ahead_profile_device_key(key, sizeof(key)) != 0) {
+        key[0] = '\0';
+    }
+    if (strcmp(key, renderer->device_key) == 0) {
+        return;
+    }
+
+    memcpy(renderer->device_key, key, sizeof(key));
+    float offset_ms = 0.0f;
+    if (key[0] && look_ahead_profile_load(key, &offset_ms) == 0) {
+        log_info("[Calibration] Using calibrated look-ahead offset %+.2fms for \"%s\"\n", offset_ms, key);
+    }
+    renderer->look_ahead_offset_ms = offset_ms;
+}
+
+static int compare_floats(const void *a, const void *b) {
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static float percentile(float *sorted, uint32_t count, float p) {
+    uint32_t index = (uint32_t)(p * (float)(count - 1) + 0.5f);
+    return sorted[index];
+}
+
+// Needs real presentation timestamps: the CPU time a swap call returns only says how the
+// driver queues swaps, not when the frame reached the display
+static void start_look_ahead_calibration(RenderThread *thread) {
+    if (!thread->present_timestamps) {
+        log_error("[Calibration] The display connection has no presentation timestamps "
+                  "(GLX_OML_sync_control) - not calibrating\n");
+        return;
+    }
+
+    thread->calibration_latency_ms = calloc(CALIBRATION_FRAMES, sizeof(float));
+    if (!thread->calibration_latency_ms) {
+        return;
+    }
+    thread->calibration_count = 0;
+    thread->calibration_sbc = 0;
+    log_info("[Calibration] Measuring present latency over %d frames - keep the glasses on\n", CALIBRATION_FRAMES);
+}
+
+static void stop_look_ahead_calibration(RenderThread *thread) {
+    free(thread->calibration_latency_ms);
+    thread->calibration_latency_ms = NULL;
+}
+
+// Called after each swap. The shader predicts pose_age + constant ahead of the pose (pose age
+// is added per frame, so it isn't part of the constant), and the frame is seen around
+// mid-scanout of the vblank it was presented on, so the ideal constant is the time from the
+// look-ahead computation to mid-scanout. One swap is tracked at a time until its present
+// timestamp arrives, so the render loop never blocks on it.
+static void record_calibration_sample(RenderThread *thread, int64_t period_ns) {
+    if (thread->calibration_sbc) {
+        int64_t present_ns;
+        int presented = opengl_present_time(thread, thread->calibration_sbc, &present_ns);
+        if (presented == 0) {
+            return;
+        }
+        int64_t look_ahead_ns = thread->calibration_look_ahead_ns;
+        thread->calibration_sbc = 0;
+        if (presented > 0) {
+            // UST is only assumed to be CLOCK_MONOTONIC; anything else can't be compared
+            int64_t now_ns = monotonic_now_ns();
+            if (present_ns < look_ahead_ns || present_ns > now_ns) {
+                log_error("[Calibration] Present timestamps aren't on CLOCK_MONOTONIC - not calibrating\n");
+                stop_look_ahead_calibration(thread);
+                return;
+            }
+            thread->calibration_latency_ms[thread->calibration_count++] =
+                (float)(present_ns + period_ns / 2 - look_ahead_ns) / 1e6f;
+        }
+    }
+
+    if (thread->calibration_count < CALIBRATION_FRAMES) {
+        if (thread->look_ahead_time_ns) {
+            thread->calibration_sbc = thread->swap_count;
+            thread->calibration_look_ahead_ns = thread->look_ahead_time_ns;
+            thread->look_ahead_time_ns = 0;
+        }
+        return;
+    }
+
+    float *latency = thread->calibration_latency_ms;
+    qsort(latency, CALIBRATION_FRAMES, sizeof(float), compare_floats);
+    float look_ahead_ms = percentile(latency, CALIBRATION_FRAMES, 0.5f);
+    log_info("[Calibration] Render-to-present latency ms: p10 %.2f, p50 %.2f, p90 %.2f, p99 %.2f\n",
+             percentile(latency, CALIBRATION_FRAMES, 0.1f), look_ahead_ms,
+             percentile(latency, CALIBRATION_FRAMES, 0.9f), percentile(latency, CALIBRATION_FRAMES, 0.99f));
+
+    // Saved as the difference from what the driver's constant assumes, so it keeps applying
+    // if the driver's default changes. The main loop saves it; the render thread stays off
+    // the filesystem.
+    float driver_ms = thread->renderer->device_config.look_ahead_cfg[0];
+    log_info("[Calibration] Driver constant %.2fms, offset %+.2fms\n", driver_ms, look_ahead_ms - driver_ms);
+    thread->renderer->calibrated_offset_ms = look_ahead_ms - driver_ms;
+    __sync_synchronize();
+    thread->renderer->calibration_ready = true;
+    stop_look_ahead_calibration(thread);
+}
+
 // Render Thread Implementation
 static void *render_thread_func(void *arg) {
     RenderThread *thread = (RenderThread *)arg;
 
-    log_info("[Render] Thread started at %dHz\n", thread->refresh_rate);
+    log_info("[Render] Thread started at %.3fHz\n", 1e9 / (double)thread->frame_period_ns);
+
+    if (opengl_context_make_current(thread, true) != 0) {
+        log_error("[Render] Failed to make the OpenGL context current\n");
+        return NULL;
+    }
 
-    const double frame_time = 1.0 / thread->refresh_rate;
-    struct timespec next_frame_time;
-    clock_gettime(CLOCK_MONOTONIC, &next_frame_time);
+    sig_atomic_t hud_toggles_applied = 0;
+    bool first_frame_presented = false;
+    int64_t nominal_period_ns = thread->frame_period_ns;
+    int64_t last_swap_ns = 0;
+    int64_t render_cost_ns = 0;  // Smoothed wake-to-swap time
+    uint32_t idle_doorbell = 0;  // Doorbell position for the idle-rate wait
 
     while (!thread->stop_requested) {
+        PowerState power_state = power_wait_until_runnable(&thread->renderer->power, &thread->stop_requested);
+        if (thread->stop_requested) {
+            break;
+        }
+
+        int64_t wake_ns = monotonic_now_ns();
+
+        sig_atomic_t hud_toggles = thread->renderer->hud_toggle_count;
+        if (hud_toggles != hud_toggles_applied && thread->hud_state) {
+            thread->hud_enabled = !thread->hud_enabled;
+            log_info("[HUD] Performance HUD %s\n", thread->hud_enabled ? "shown" : "hidden");
+        }
+        hud_toggles_applied = hud_toggles;
+
         // Read latest frame from ring buffer
         uint8_t *frame_data = NULL;
         struct timespec frame_timestamp;
@@ -421,7 +856,9 @@ static void *render_thread_func(void *arg) {
         }
 
         // Read latest IMU data
+        BREEZY_ALLOC_SCOPE_BEGIN("pose_update");
         IMUData imu = read_latest_imu(&thread->renderer->imu_reader);
+        BREEZY_ALLOC_SCOPE_END();
 
         // Update device config periodically (every second)
         uint64_t current_time_ms = 0;
@@ -437,36 +874,85 @@ static void *render_thread_func(void *arg) {
         }
 
         // Render frame with 3D transformations
+        BREEZY_ALLOC_SCOPE_BEGIN("render_frame");
         render_frame(thread, &thread->renderer->frame_buffer, &imu, &thread->renderer->device_config);
 
         // Swap buffers (vsync)
-        swap_buffers(thread);
+        int64_t submit_ns = monotonic_now_ns();
+        if (thread->headless) {
+            headless_present(thread);
+        } else {
+            swap_buffers(thread);
+        }
+        int64_t swap_ns = monotonic_now_ns();
+
+        // Have the capture client thread tell the service which frame we presented - the one
+        // render_frame sampled, not the newest received - so it can send the next one (that
+        // thread owns the connection, which it may reopen)
+        CaptureThread *capture = &thread->renderer->capture_thread;
+        uint64_t presented_frame = thread->sampled_service_frame;
+        if (capture->ack_event_fd >= 0 && presented_frame && presented_frame != thread->published_service_frame) {
+            thread->published_service_frame = presented_frame;
+            atomic_store_explicit(&capture->presented_service_frame, presented_frame, memory_order_release);
+            uint64_t one = 1;
+            ssize_t written = write(capture->ack_event_fd, &one, sizeof(one));
+            (void)written;  // Only fails if the counter is saturated, which still wakes the reader
+        }
+        BREEZY_ALLOC_SCOPE_END();
 
-        // Sleep until next frame
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (!first_frame_presented && thread->frame_texture) {
+            first_frame_presented = true;
+            log_info("[Startup] First frame presented %.1fms after launch\n",
+                     (double)(swap_ns - thread->renderer->startup_ns) / 1e6);
+        }
 
-        double elapsed = (now.tv_sec - next_frame_time.tv_sec) +
-                        (now.tv_nsec - next_frame_time.tv_nsec) / 1e9;
+        // Mode changed - the old measurement no longer applies
+        if (thread->frame_period_ns != nominal_period_ns) {
+            nominal_period_ns = thread->frame_period_ns;
+            thread->measured_period_ns = 0;
+            last_swap_ns = 0;
+        }
 
-        if (elapsed < frame_time) {
-            struct timespec sleep_time = {
-                .tv_sec = 0,
-                .tv_nsec = (long)((frame_time - elapsed) * 1e9)
-            };
-            nanosleep(&sleep_time, NULL);
+        // With vsync, swaps complete on vblank, so their spacing is the real vblank period.
+        // Only intervals near one nominal period count (skips missed or doubled vblanks).
+        if (thread->vsync_enabled && last_swap_ns) {
+            int64_t interval = swap_ns - last_swap_ns;
+            if (interval > nominal_period_ns * 3 / 4 && interval < nominal_period_ns * 5 / 4) {
+                thread->measured_period_ns = thread->measured_period_ns
+                    ? thread->measured_period_ns + (interval - thread->measured_period_ns) / 16
+                    : interval;
+            }
         }
+        last_swap_ns = swap_ns;
 
-        // Update next frame time
-        next_frame_time.tv_sec += (time_t)frame_time;
-        next_frame_time.tv_nsec += (long)((frame_time - (int)frame_time) * 1e9);
-        if (next_frame_time.tv_nsec >= 1000000000L) {
-            next_frame_time.tv_sec++;
-            next_frame_time.tv_nsec -= 1000000000L;
+        // Idle-rate frames aren't frame intervals
+        hud_record_frame(thread, power_state == POWER_STATE_ACTIVE ? swap_ns : 0,
+                         thread->measured_period_ns ? thread->measured_period_ns : nominal_period_ns);
+
+        if (thread->calibration_latency_ms) {
+            record_calibration_sample(thread, thread->measured_period_ns ? thread->measured_period_ns : nominal_period_ns);
         }
+
+        int64_t cost = submit_ns - wake_ns;
+        render_cost_ns = render_cost_ns ? render_cost_ns + (cost - render_cost_ns) / 8 : cost;
+
+        if (power_state == POWER_STATE_IDLE) {
+            // Nothing is moving - keep the display content current at a low rate, but
+            // render as soon as the driver rings the doorbell with a new pose
+            int64_t idle_deadline_ns = swap_ns + IDLE_FRAME_PERIOD_NS;
+            if (imu_wait_for_sample(&thread->renderer->imu_reader, &idle_doorbell, idle_deadline_ns) < 0) {
+                sleep_until_ns(idle_deadline_ns);
+            }
+            continue;
+        }
+
+        // Wake just early enough to render before the next vblank
+        int64_t period_ns = thread->measured_period_ns ? thread->measured_period_ns : nominal_period_ns;
+        sleep_until_ns(swap_ns + period_ns - render_cost_ns - RENDER_WAKE_MARGIN_NS);
     }
 
     log_info("[Render] Thread stopping\n");
+    opengl_context_make_current(thread, false);
     return NULL;
 }
 
@@ -521,10 +1007,24 @@ static int init_render_thread(RenderThread *thread, Renderer *renderer) {
     thread->current_format = 0;
     thread->current_stride = 0;
     thread->current_modifier = 0;
+    thread->current_width = 0;
+    thread->current_height = 0;
     thread->fb_changed = false;
+    thread->pending_damage = (DamageRect){ 0, 0, 0, 0 };
+    thread->mip_texture = 0;
+    thread->mip_valid = false;
     thread->vbo = 0;
     thread->vao = 0;
 
+    // Headless renders the virtual display into an offscreen target of the same size
+    thread->headless = renderer->headless_results_path != NULL;
+    if (thread->headless) {
+        thread->output_width = renderer->virtual_width;
+        thread->output_height = renderer->virtual_height;
+        thread->current_width = renderer->virtual_width;
+        thread->current_height = renderer->virtual_height;
+    }
+
     // Initialize mutex for DMA-BUF data sharing
     if (pthread_mutex_init(&thread->dmabuf_mutex, NULL) != 0) {
         log_error("[Render] Failed to initialize DMA-BUF mutex\n");
@@ -551,10 +1051,59 @@ static int init_render_thread(RenderThread *thread, Renderer *renderer) {
         return -1;
     }
 
+    if (thread->headless && headless_init(thread, renderer->headless_results_path) != 0) {
+        log_error("[Render] Failed to initialize headless mode\n");
+        cleanup_opengl_context(thread);
+        return -1;
+    }
+
+    // Optional, the renderer runs without it
+    if (hud_init(thread, renderer->hud_requested) != 0) {
+        log_warn("[HUD] Failed to initialize the performance HUD\n");
+    }
+
+    // The render thread makes the context current for itself
+    opengl_context_make_current(thread, false);
+
     log_info("[Render] Render thread initialized successfully\n");
     return 0;
 }
 
+// Context creation and shader compiles are the slowest part of startup and don't depend on
+// capture, so main runs them on their own thread while it sets up everything else
+typedef struct RenderInit {
+    Renderer *renderer;
+    pthread_t thread;
+    bool async;
+    int result;
+    int64_t duration_ns;
+} RenderInit;
+
+static void *render_init_thread_func(void *arg) {
+    RenderInit *init = (RenderInit *)arg;
+    int64_t start_ns = monotonic_now_ns();
+    init->result = init_render_thread(&init->renderer->render_thread, init->renderer);
+    init->duration_ns = monotonic_now_ns() - start_ns;
+    return NULL;
+}
+
+static void start_render_init(RenderInit *init, Renderer *renderer) {
+    init->renderer = renderer;
+    init->result = -1;
+    init->async = pthread_create(&init->thread, NULL, render_init_thread_func, init) == 0;
+    if (!init->async) {
+        render_init_thread_func(init);
+    }
+}
+
+static int wait_for_render_init(RenderInit *init) {
+    if (init->async) {
+        pthread_join(init->thread, NULL);
+        init->async = false;
+    }
+    return init->result;
+}
+
 static void cleanup_render_thread(RenderThread *thread) {
     thread->stop_requested = true;
     // Only join if thread was actually started (prevents double-join)
@@ -567,7 +1116,10 @@ static void cleanup_render_thread(RenderThread *thread) {
     // Destroy mutex
     pthread_mutex_destroy(&thread->dmabuf_mutex);
 
-    // Cleanup OpenGL resources
+    // Cleanup OpenGL resources (the render thread has released the context)
+    opengl_context_make_current(thread, true);
+    headless_cleanup(thread);
+    hud_cleanup(thread);
     if (thread->shader_program) {
         glDeleteProgram(thread->shader_program);
         thread->shader_program = 0;
@@ -580,6 +1132,7 @@ static void cleanup_render_thread(RenderThread *thread) {
         glDeleteShader(thread->fragment_shader);
         thread->fragment_shader = 0;
     }
+    cleanup_mipmapped_texture(thread);
     cleanup_dmabuf_texture(thread);
     if (thread->vbo) {
         glDeleteBuffers(1, &thread->vbo);
@@ -591,6 +1144,7 @@ static void cleanup_render_thread(RenderThread *thread) {
     }
 
     cleanup_opengl_context(thread);
+    stop_look_ahead_calibration(thread);
 }
 
 static int load_shaders(RenderThread *thread) {
@@ -633,22 +1187,41 @@ static void set_shader_uniforms(RenderThread *thread, IMUData *imu, DeviceConfig
         return;
     }
 
-    // Calculate look_ahead_ms using shared math library
-    uint64_t current_time_ms = 0;
-    struct timespec ts;
-    if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
-        current_time_ms = (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
-    }
-    float look_ahead_override = -1.0f;  // No override by default (-1 means use constant)
-    float look_ahead_ms = breezy_calculate_look_ahead_ms(
-        imu->timestamp_ms,
-        current_time_ms,
-        config->look_ahead_cfg[0],
-        look_ahead_override
-    );
+    // Calculate look_ahead_ms using shared math library, from monotonic sample times when
+    // the driver publishes them, else from the millisecond epoch. A calibrated per-device
+    // profile corrects the driver's constant by how far this renderer's measured
+    // render-to-present latency is from it.
+    float look_ahead_constant = config->look_ahead_cfg[0] + thread->renderer->look_ahead_offset_ms;
+    float look_ahead_ms;
+    thread->look_ahead_time_ns = monotonic_now_ns();
+    if (imu->sample_time_ns) {
+        look_ahead_ms = breezy_calculate_look_ahead_ms_ns(
+            imu->sample_time_ns,
+            (uint64_t)thread->look_ahead_time_ns,
+            look_ahead_constant,
+            -1.0f
+        );
+    } else {
+        uint64_t current_time_ms = 0;
+        struct timespec ts;
+        if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
+            current_time_ms = (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+        }
+        look_ahead_ms = breezy_calculate_look_ahead_ms(
+            imu->timestamp_ms,
+            current_time_ms,
+            look_ahead_constant,
+            -1.0f
+        );
+    }
+    thread->last_pose_age_ms = look_ahead_ms - look_ahead_constant;
+    if (thread->renderer->prediction_disabled) {
+        look_ahead_ms = 0.0f;
+    }
 
-    // Calculate frametime (inverse of refresh rate)
-    float frametime = 1000.0f / (float)thread->refresh_rate;
+    // Calculate frametime (measured vblank period when available)
+    int64_t period_ns = thread->measured_period_ns ? thread->measured_period_ns : thread->frame_period_ns;
+    float frametime = (float)period_ns / 1e6f;
 
     // Calculate FOV values from display_fov using shared math library
     float display_aspect_ratio = (float)config->display_resolution[0] / (float)config->display_resolution[1];
@@ -838,14 +1411,17 @@ static void render_frame(RenderThread *thread, FrameBuffer *fb, IMUData *imu, De
         return;
     }
 
-    // Get frame dimensions
-    int width = fb->width;
-    int height = fb->height;
+    uint32_t frame_width, frame_height;
+    latest_frame_size(fb, &frame_width, &frame_height);
 
     // Check if framebuffer changed (need to create new EGL image)
     // Lock mutex to read shared DMA-BUF data
     pthread_mutex_lock(&thread->dmabuf_mutex);
 
+    // Use the captured framebuffer's real size when known (it follows mode changes)
+    int width = thread->current_width ? (int)thread->current_width : (int)frame_width;
+    int height = thread->current_height ? (int)thread->current_height : (int)frame_height;
+
     bool fb_changed = thread->fb_changed;
     int dmabuf_fd = -1;
     if (fb_changed && thread->current_dmabuf_fd >= 0) {
@@ -857,6 +1433,7 @@ static void render_frame(RenderThread *thread, FrameBuffer *fb, IMUData *imu, De
     uint32_t format = thread->current_format;
     uint32_t stride = thread->current_stride;
     uint32_t modifier = thread->current_modifier;
+    thread->sampled_service_frame = thread->current_service_frame;
 
     pthread_mutex_unlock(&thread->dmabuf_mutex);
 
@@ -865,17 +1442,17 @@ static void render_frame(RenderThread *thread, FrameBuffer *fb, IMUData *imu, De
         // Framebuffer changed - create new EGL image
         GLuint texture = import_dmabuf_as_texture(thread, dmabuf_fd,
                                                    width, height, format, stride, modifier);
+
+        // The EGL image holds its own reference to the buffer, so the FD isn't needed past import
+        close(dmabuf_fd);
         if (texture == 0) {
             log_error("Failed to import DMA-BUF as texture - rendering will be skipped\n");
-            // Close fd on failure
-            close(dmabuf_fd);
             return;
         }
-
-        // fd ownership transferred to EGL image - don't close it here
-        // It will be closed when EGL image is destroyed
     }
 
+    headless_paint_content(thread, fb->frame_count);
+
     if (thread->frame_texture == 0) {
         // No texture yet, skip rendering
         return;
@@ -888,6 +1465,32 @@ static void render_frame(RenderThread *thread, FrameBuffer *fb, IMUData *imu, De
         return;
     }
 
+    // When the virtual display has more pixels than the glasses, sample a mip chain instead of
+    // the raw import to avoid shimmering. The chain is only rebuilt when capture published a
+    // new frame (frame_count), over the region damaged since the last rebuild. Neither KMS nor
+    // the capture service report damage today, so that region is always the whole frame.
+    GLuint sample_texture = thread->frame_texture;
+    bool downscaled = config->valid &&
+                      ((uint32_t)width > config->display_resolution[0] ||
+                       (uint32_t)height > config->display_resolution[1]);
+    if (downscaled) {
+        __sync_synchronize();
+        uint32_t sequence = fb->frame_count;
+        if (!thread->mip_valid || sequence != thread->mip_sequence) {
+            pthread_mutex_lock(&thread->dmabuf_mutex);
+            DamageRect damage = thread->pending_damage;
+            thread->pending_damage = (DamageRect){ 0, 0, 0, 0 };
+            pthread_mutex_unlock(&thread->dmabuf_mutex);
+
+            if (update_mipmapped_texture(thread, (uint32_t)width, (uint32_t)height, &damage) == 0) {
+                thread->mip_sequence = sequence;
+            }
+        }
+        if (thread->mip_valid) {
+            sample_texture = thread->mip_texture;
+        }
+    }
+
     // Clear screen
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -904,17 +1507,114 @@ static void render_frame(RenderThread *thread, FrameBuffer *fb, IMUData *imu, De
     GLint screen_tex_loc = glGetUniformLocation(thread->shader_program, "screenTexture");
     if (screen_tex_loc >= 0) {
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, thread->frame_texture);
+        glBindTexture(GL_TEXTURE_2D, sample_texture);
         glUniform1i(screen_tex_loc, 0);
     }
 
     // Note: frame_texture now directly references DRM framebuffer via DMA-BUF (zero-copy!)
 
     // Render fullscreen quad
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
     glBindVertexArray(0);
     glUseProgram(0);
+
+    if (thread->hud_enabled) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        hud_draw(thread, (float)(now.tv_sec - frame_timestamp.tv_sec) * 1000.0f +
+                         (float)(now.tv_nsec - frame_timestamp.tv_nsec) / 1e6f);
+    }
+}
+
+// Resolve capture/render periods from explicit rates or RandR mode timings
+static void update_display_timing(Renderer *renderer, void *x_display) {
+    CaptureThread *capture = &renderer->capture_thread;
+    RenderThread *render = &renderer->render_thread;
+    DisplayTiming timing;
+
+    int64_t capture_period_ns = DEFAULT_FRAME_PERIOD_NS;
+    if (renderer->capture_rate_override > 0.0) {
+        capture_period_ns = (int64_t)(1e9 / renderer->capture_rate_override);
+    } else if (query_output_timing(x_display, capture->connector_name, &timing) == 0) {
+        capture_period_ns = timing.frame_period_ns;
+    }
+
+    int64_t render_period_ns = DEFAULT_FRAME_PERIOD_NS;
+    if (renderer->render_rate_override > 0.0) {
+        render_period_ns = (int64_t)(1e9 / renderer->render_rate_override);
+    } else if (query_glasses_timing(x_display, capture->connector_name, render->x_window, &timing) == 0) {
+        render_period_ns = timing.frame_period_ns;
+    }
+
+    if (capture_period_ns != capture->frame_period_ns || render_period_ns != render->frame_period_ns) {
+        log_info("Capture rate: %.3fHz, render rate: %.3fHz\n",
+                 1e9 / (double)capture_period_ns, 1e9 / (double)render_period_ns);
+    }
+    capture->frame_period_ns = capture_period_ns;
+    render->frame_period_ns = render_period_ns;
+}
+
+// True if the X server has powered the displays down (DPMS standby/suspend/off)
+static bool displays_powered_off(Display *dpy) {
+    int event_base, error_base;
+    if (!dpy || !DPMSQueryExtension(dpy, &event_base, &error_base) || !DPMSCapable(dpy)) {
+        return false;
+    }
+
+    CARD16 power_level = DPMSModeOn;
+    BOOL dpms_enabled = False;
+    if (!DPMSInfo(dpy, &power_level, &dpms_enabled)) {
+        return false;
+    }
+    return dpms_enabled && power_level != DPMSModeOn;
+}
+
+// Evaluate the power state from the driver's ENABLED flag, pose age and DPMS state
+static void update_power_state(Renderer *renderer, Display *dpy) {
+    PowerControl *power = &renderer->power;
+
+    if (!imu_source_enabled(&renderer->imu_reader)) {
+        power_set_state(power, POWER_STATE_SUSPENDED, "driver disabled");
+        return;
+    }
+
+    if (displays_powered_off(dpy)) {
+        power_set_state(power, POWER_STATE_SUSPENDED, "display powered off");
+        return;
+    }
+
+    // Pose age runs on CLOCK_MONOTONIC so wall clock steps (NTP, suspend/resume) can't fake
+    // or hide activity. Drivers without monotonic sample times get their epoch translated
+    // once, when the pose is first seen.
+    IMUData imu = read_latest_imu(&renderer->imu_reader);
+    int64_t now_ns = monotonic_now_ns();
+    uint64_t pose_id = imu.sample_time_ns ? imu.sample_time_ns : imu.timestamp_ms;
+    if (imu.valid && pose_id != power->last_pose_id) {
+        power->last_pose_id = pose_id;
+        if (imu.sample_time_ns) {
+            power->last_pose_ns = (int64_t)imu.sample_time_ns;
+        } else {
+            struct timespec ts;
+            int64_t epoch_age_ns = 0;
+            if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
+                uint64_t now_ms = (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+                epoch_age_ns = now_ms > imu.timestamp_ms ? (int64_t)(now_ms - imu.timestamp_ms) * 1000000LL : 0;
+            }
+            power->last_pose_ns = now_ns - epoch_age_ns;
+        }
+    }
+
+    uint64_t pose_age_ms = power->last_pose_ns == 0 ? UINT64_MAX :
+                           now_ns > power->last_pose_ns ? (uint64_t)(now_ns - power->last_pose_ns) / 1000000 : 0;
+
+    if (pose_age_ms >= SUSPEND_POSE_AGE_MS) {
+        power_set_state(power, POWER_STATE_SUSPENDED, "no pose updates");
+    } else if (pose_age_ms >= IDLE_POSE_AGE_MS) {
+        power_set_state(power, POWER_STATE_IDLE, "pose idle");
+    } else {
+        power_set_state(power, POWER_STATE_ACTIVE, "pose updating");
+    }
 }
 
 // Main renderer
@@ -927,67 +1627,140 @@ static void signal_handler(int sig) {
     }
 }
 
+static void hud_signal_handler(int sig) {
+    (void)sig;
+    if (g_renderer) {
+        g_renderer->hud_toggle_count++;
+    }
+}
+
 int main(int argc, char *argv[]) {
+    int64_t startup_ns = monotonic_now_ns();
+
     // Initialize logging first
     if (log_init() != 0) {
         fprintf(stderr, "Warning: Failed to initialize logging, continuing with stderr output\n");
     }
 
-    if (argc < 5) {
-        fprintf(stderr, "Usage: %s <width> <height> <capture_fps> <render_fps>\n", argv[0]);
-        fprintf(stderr, "Example: %s 1920 1080 60 90\n", argv[0]);
-        log_error("Invalid arguments: expected 4 arguments, got %d\n", argc - 1);
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <width> <height> [capture_fps] [render_fps]\n", argv[0]);
+        fprintf(stderr, "Rates default to (or 0 selects) the outputs' actual mode timings\n");
+        fprintf(stderr, "Example: %s 1920 1080\n", argv[0]);
+        log_error("Invalid arguments: expected at least 2 arguments, got %d\n", argc - 1);
         log_cleanup();
         return 1;
     }
 
+    // Startup opens X connections from several threads at once
+    XInitThreads();
+
     Renderer renderer = {0};
     g_renderer = &renderer;
+    renderer.startup_ns = startup_ns;
 
     renderer.virtual_width = atoi(argv[1]);
     renderer.virtual_height = atoi(argv[2]);
-    renderer.virtual_framerate = atoi(argv[3]);
-    renderer.render_refresh_rate = atoi(argv[4]);
+    renderer.capture_rate_override = argc > 3 ? atof(argv[3]) : 0.0;
+    renderer.render_rate_override = argc > 4 ? atof(argv[4]) : 0.0;
+
+    const char *headless = getenv(HEADLESS_ENV);
+    renderer.headless_results_path = headless && headless[0] ? headless : NULL;
+    const char *disable_prediction = getenv(DISABLE_PREDICTION_ENV);
+    renderer.prediction_disabled = disable_prediction && disable_prediction[0] && strcmp(disable_prediction, "0") != 0;
+    const char *hud = getenv(HUD_ENV);
+    renderer.hud_requested = hud && hud[0] && strcmp(hud, "0") != 0;
 
     log_info("Breezy Desktop Standalone Renderer starting\n");
-    log_info("Virtual display: %dx%d@%dHz\n",
+    log_info("Virtual display: %dx%d\n",
              renderer.virtual_width,
-             renderer.virtual_height,
-             renderer.virtual_framerate);
-    log_info("Render rate: %dHz\n", renderer.render_refresh_rate);
+             renderer.virtual_height);
+
+    // The render thread's context is created in parallel with the rest of startup
+    RenderInit render_init;
+    start_render_init(&render_init, &renderer);
 
     // Initialize components
     if (init_frame_buffer(&renderer.frame_buffer,
                          renderer.virtual_width,
                          renderer.virtual_height) != 0) {
         log_error("Failed to initialize frame buffer\n");
+        if (wait_for_render_init(&render_init) == 0) {
+            cleanup_render_thread(&renderer.render_thread);
+        }
         return 1;
     }
 
     if (init_imu_reader(&renderer.imu_reader) != 0) {
         log_error("Failed to initialize IMU reader\n");
+        if (wait_for_render_init(&render_init) == 0) {
+            cleanup_render_thread(&renderer.render_thread);
+        }
         cleanup_frame_buffer(&renderer.frame_buffer);
         return 1;
     }
 
+    int64_t capture_start_ns = monotonic_now_ns();
     if (init_capture_thread(&renderer.capture_thread, &renderer) != 0) {
         log_error("Failed to initialize capture thread\n");
+        if (wait_for_render_init(&render_init) == 0) {
+            cleanup_render_thread(&renderer.render_thread);
+        }
         cleanup_imu_reader(&renderer.imu_reader);
         cleanup_frame_buffer(&renderer.frame_buffer);
         return 1;
     }
+    int64_t capture_init_ns = monotonic_now_ns() - capture_start_ns;
 
-    if (init_render_thread(&renderer.render_thread, &renderer) != 0) {
+    // Power state machine: worker threads block while suspended, the main loop wakes them
+    pthread_mutex_init(&renderer.power.lock, NULL);
+    pthread_cond_init(&renderer.power.wake, NULL);
+    renderer.power.state = POWER_STATE_ACTIVE;
+
+    Display *timing_display = XOpenDisplay(NULL);
+    int randr_event_base = 0, randr_error_base = 0;
+    if (timing_display && XRRQueryExtension(timing_display, &randr_event_base, &randr_error_base)) {
+        XRRSelectInput(timing_display, DefaultRootWindow(timing_display),
+                       RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+        XFlush(timing_display);
+    }
+
+    int64_t render_wait_start_ns = monotonic_now_ns();
+    if (wait_for_render_init(&render_init) != 0) {
         log_error("Failed to initialize render thread\n");
         cleanup_capture_thread(&renderer.capture_thread);
         cleanup_imu_reader(&renderer.imu_reader);
         cleanup_frame_buffer(&renderer.frame_buffer);
+        if (timing_display) {
+            XCloseDisplay(timing_display);
+        }
+        pthread_cond_destroy(&renderer.power.wake);
+        pthread_mutex_destroy(&renderer.power.lock);
         return 1;
     }
+    int64_t ready_ns = monotonic_now_ns();
+
+    // Derive capture and render cadence from the outputs' real mode timings (init_render_thread
+    // resets the render thread's state, so this waits for it)
+    update_display_timing(&renderer, timing_display);
+    log_info("[Startup] Capture init %.1fms, OpenGL init %.1fms (in parallel, %.1fms waited), ready %.1fms after launch\n",
+             (double)capture_init_ns / 1e6, (double)render_init.duration_ns / 1e6,
+             (double)(ready_ns - render_wait_start_ns) / 1e6, (double)(ready_ns - startup_ns) / 1e6);
+
+    update_power_state(&renderer, timing_display);
+    update_look_ahead_profile(&renderer);
+
+    const char *calibrate = getenv(CALIBRATE_LOOK_AHEAD_ENV);
+    if (calibrate && calibrate[0] && strcmp(calibrate, "0") != 0) {
+        start_look_ahead_calibration(&renderer.render_thread);
+    }
 
     // Setup signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    // Persistent, unlike signal() here - the HUD can be toggled any number of times
+    struct sigaction hud_action = { .sa_handler = hud_signal_handler, .sa_flags = SA_RESTART };
+    sigemptyset(&hud_action.sa_mask);
+    sigaction(SIGUSR1, &hud_action, NULL);
 
     // Start threads
     renderer.running = true;
@@ -996,27 +1769,70 @@ int main(int argc, char *argv[]) {
     renderer.render_thread.running = true;
     renderer.render_thread.stop_requested = false;
 
-    if (pthread_create(&renderer.capture_thread.thread, NULL,
-                      capture_thread_func, &renderer.capture_thread) != 0) {
-        log_error("Failed to create capture thread\n");
-        goto cleanup;
-    }
-    renderer.capture_thread.thread_started = true;
-
+    // Render thread first, so its context is current by the time the first DMA-BUF arrives
     if (pthread_create(&renderer.render_thread.thread, NULL,
                       render_thread_func, &renderer.render_thread) != 0) {
         log_error("Failed to create render thread\n");
-        // Stop capture thread and let cleanup handle joining
-        renderer.capture_thread.stop_requested = true;
         goto cleanup;
     }
     renderer.render_thread.thread_started = true;
 
+    void *(*capture_func)(void *) = renderer.headless_results_path ? headless_source_thread_func :
+                                    renderer.capture_thread.service_fd >= 0 ?
+                                    capture_client_thread_func : capture_thread_func;
+    if (pthread_create(&renderer.capture_thread.thread, NULL,
+                      capture_func, &renderer.capture_thread) != 0) {
+        log_error("Failed to create capture thread\n");
+        // Stop render thread and let cleanup handle joining
+        renderer.render_thread.stop_requested = true;
+        goto cleanup;
+    }
+    renderer.capture_thread.thread_started = true;
+
     log_info("Renderer running. Press Ctrl+C to stop.\n");
 
-    // Main loop
+    // Main loop: re-evaluate display timing whenever RandR reports a mode change, and the
+    // power state on a timer while active. While idle/suspended it parks on the driver's pose
+    // doorbell instead, so the first new pose resumes full rate; RandR events queued meanwhile
+    // are handled right after. Enabled drivers without a doorbell are polled once per render
+    // frame, which still resumes within a frame of the first new pose.
+    uint32_t power_doorbell = 0;  // The main loop's own position, independent of the render thread's
+    int64_t profile_checked_ns = monotonic_now_ns();
     while (renderer.running) {
-        sleep(1);
+        bool active = renderer.power.state == POWER_STATE_ACTIVE;
+        if (active || imu_wait_for_sample(&renderer.imu_reader, &power_doorbell,
+                                          monotonic_now_ns() + 1000000000LL) < 0) {
+            int frame_ms = (int)((renderer.render_thread.frame_period_ns + 999999) / 1000000);
+            int timeout_ms = active ? 250 : imu_source_enabled(&renderer.imu_reader) ? frame_ms : 1000;
+            struct pollfd pfd = { .fd = timing_display ? ConnectionNumber(timing_display) : -1, .events = POLLIN };
+            poll(&pfd, 1, timeout_ms);
+        }
+
+        // Driver restarted and recreated the segment: swap the mapping and follow the new inode
+        imu_reader_check_reattach(&renderer.imu_reader);
+        update_power_state(&renderer, timing_display);
+        if (monotonic_now_ns() - profile_checked_ns >= 1000000000LL) {
+            profile_checked_ns = monotonic_now_ns();
+            update_look_ahead_profile(&renderer);
+        }
+
+        if (!timing_display) {
+            continue;
+        }
+
+        bool mode_changed = false;
+        while (XPending(timing_display) > 0) {
+            XEvent event;
+            XNextEvent(timing_display, &event);
+            XRRUpdateConfiguration(&event);
+            if (event.type == randr_event_base + RRScreenChangeNotify ||
+                event.type == randr_event_base + RRNotify) {
+                mode_changed = true;
+            }
+        }
+        if (mode_changed) {
+            update_display_timing(&renderer, timing_display);
+        }
     }
 
 cleanup:
@@ -1025,12 +1841,19 @@ cleanup:
     // Stop threads - cleanup functions will handle joining safely
     renderer.capture_thread.stop_requested = true;
     renderer.render_thread.stop_requested = true;
+    power_wake_all(&renderer.power);
 
-    // Cleanup (will join threads if they were started)
-    cleanup_render_thread(&renderer.render_thread);
+    // Cleanup (will join threads if they were started); capture goes first since it
+    // hands frames to the render thread's state
     cleanup_capture_thread(&renderer.capture_thread);
+    cleanup_render_thread(&renderer.render_thread);
     cleanup_imu_reader(&renderer.imu_reader);
     cleanup_frame_buffer(&renderer.frame_buffer);
+    if (timing_display) {
+        XCloseDisplay(timing_display);
+    }
+    pthread_cond_destroy(&renderer.power.wake);
+    pthread_mutex_destroy(&renderer.power.lock);
 
     log_cleanup();
     return 0;
@@ -3,10 +3,15 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <pthread.h>
 #include <time.h>
 #include <xf86drmMode.h>
 
+// Shared memory published by XRLinuxDriver (layout in shared/ipc/breezy_shm_layout.h)
+#define IMU_SHM_PATH "/dev/shm/breezy_desktop_imu"
+#define IMU_SHM_PATH_ENV "BREEZY_IMU_SHM_PATH"  // Overrides IMU_SHM_PATH (test harnesses)
+
 // Forward declare GL types if not included
 #ifndef __gl_h_
 typedef unsigned int GLuint;
@@ -16,6 +21,14 @@ typedef unsigned int GLuint;
 typedef struct Renderer Renderer;
 typedef struct FrameBuffer FrameBuffer;
 
+// Region of the captured frame that changed since it was last consumed (in source pixels)
+typedef struct DamageRect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} DamageRect;
+
 // Capture thread structure (needed by drm_capture.c)
 typedef struct CaptureThread {
     pthread_t thread;
@@ -28,7 +41,7 @@ typedef struct CaptureThread {
     const char *connector_name;  // e.g., "XR-0"
     uint32_t width;
     uint32_t height;
-    uint32_t framerate;
+    volatile int64_t frame_period_ns;  // Capture cadence (virtual output's vblank period)
     
     // DRM/KMS capture
     int drm_fd;  // -1 if not initialized
@@ -43,6 +56,15 @@ typedef struct CaptureThread {
     uint32_t cached_format;
     uint32_t cached_stride;
     uint32_t cached_modifier;
+    
+    // Capture service subscription (see capture_ipc.h); when connected, the thread above
+    // receives frames from breezy_capture_service instead of capturing in-process
+    // Only the capture thread uses service_fd; the render thread hands it presented frames to ACK.
+    // Service frames are tagged (connection generation << 32) | FRAME sequence, so an ACK is
+    // never sent for a frame received on an earlier connection.
+    int service_fd;  // -1 if capturing in-process
+    _Atomic uint64_t presented_service_frame;  // Tag of the frame the render thread last presented, 0 if none
+    int ack_event_fd;  // eventfd the render thread signals after presenting one, -1 if unused
 } CaptureThread;
 
 // Render thread structure (needed by opengl_context.c and shader_loader.c)
@@ -53,7 +75,11 @@ typedef struct RenderThread {
     bool stop_requested;
     bool thread_started;  // Track if thread was successfully started (for safe cleanup)
     
-    uint32_t refresh_rate;  // AR glasses refresh rate (60/72/90/120 Hz)
+    volatile int64_t frame_period_ns;  // Nominal vblank period of the glasses output (updated on mode changes)
+    int64_t measured_period_ns;  // Vblank period measured from swap completions (0 until measured)
+    bool vsync_enabled;  // True if swaps block on vblank (required for measuring the period)
+    bool present_timestamps;  // GLX_OML_sync_control: swaps report when they were presented
+    int64_t swap_count;       // Swap buffer count (SBC) the last swap completes as
     
     // OpenGL context
     void *x_display;  // Display* (void* to avoid X11 dependency in header)
@@ -62,6 +88,14 @@ typedef struct RenderThread {
     void *egl_display;  // EGLDisplay (void* to avoid EGL dependency in header)
     void *egl_surface;  // EGLSurface (void* to avoid EGL dependency in header)
     void *egl_context;  // EGLContext (void* to avoid EGL dependency in header)
+
+    // Headless latency mode (headless.c): surfaceless EGL, rendering into an offscreen framebuffer
+    bool headless;
+    uint32_t headless_fbo;           // GLuint, the "display" framebuffer
+    uint32_t headless_renderbuffer;  // GLuint, its color attachment
+    uint32_t output_width;
+    uint32_t output_height;
+    void *headless_state;            // HeadlessState, NULL unless headless
     
     // Shader program (from Sombrero.frag)
     uint32_t shader_program;  // GLuint (0 if not initialized)
@@ -79,11 +113,38 @@ typedef struct RenderThread {
     uint32_t current_format;  // DRM format of current framebuffer
     uint32_t current_stride;  // Stride of current framebuffer
     uint64_t current_modifier;  // Modifier of current framebuffer (uint64_t per DRM spec)
+    uint32_t current_width;  // Size of current framebuffer (may differ from the requested virtual size)
+    uint32_t current_height;
     bool fb_changed;  // True when framebuffer changed (need to recreate EGL image)
+    uint64_t current_service_frame;  // Capture service frame tag of the latest handoff, 0 if in-process
+    DamageRect pending_damage;  // Union of damage reported by capture since the render thread last consumed it (always full-frame today)
+    uint64_t sampled_service_frame;    // current_service_frame when the last frame was rendered (render thread only)
+    uint64_t published_service_frame;  // Last one handed to the capture thread for ACK (render thread only)
+    
+    // Mipmapped copy of the captured frame for downscaled sampling (virtual display larger than glasses)
+    uint32_t mip_texture;     // GLuint (0 if not initialized)
+    uint32_t mip_fbos[2];     // GLuint read/draw framebuffers used for level blits
+    uint32_t mip_width;
+    uint32_t mip_height;
+    uint32_t mip_levels;
+    uint32_t mip_sequence;    // FrameBuffer frame_count the mip chain was last built from
+    bool mip_valid;           // False until level 0 holds a complete copy of the current framebuffer
     
     // VBO/VAO for fullscreen quad
     uint32_t vbo;  // GLuint (0 if not initialized)
     uint32_t vao;  // GLuint (0 if not initialized)
+    
+    // Look-ahead calibration (see look_ahead_profile.c); samples are NULL unless calibrating
+    int64_t look_ahead_time_ns;    // CLOCK_MONOTONIC when the last frame's look-ahead was computed
+    float last_pose_age_ms;        // Pose age used for that frame
+    float *calibration_latency_ms; // Look-ahead time to mid-scanout, per frame
+    uint32_t calibration_count;
+    int64_t calibration_sbc;          // Swap awaiting its present timestamp, 0 if none
+    int64_t calibration_look_ahead_ns; // look_ahead_time_ns of that swap's frame
+
+    // Performance HUD (see hud.c); hud_state is NULL if it couldn't be set up
+    void *hud_state;   // HudState
+    bool hud_enabled;  // Drawn this frame; flipped by the render thread on SIGUSR1
 } RenderThread;
 
 // IMU data structure (must be defined before IMUReader)
@@ -91,16 +152,24 @@ typedef struct IMUData {
     float pose_orientation[16];  // 4x4 matrix: rows 0-2 are quaternions (t0, t1, t2), row 3 is timestamps
     float position[3];            // x, y, z
     uint64_t timestamp_ms;
+    uint64_t sample_time_ns;      // CLOCK_MONOTONIC of the t0 sample, 0 if the driver doesn't publish it
     bool valid;
 } IMUData;
 
 // IMU reader structure (defined here so it can be used in .c files)
 typedef struct IMUReader {
+    // Current mapping; swapped under lock by imu_reader_check_reattach
     int shm_fd;
     void *shm_ptr;
     size_t shm_size;
+    uint64_t shm_dev;  // Identity of the mapped file, to spot the driver recreating it
+    uint64_t shm_ino;
     IMUData latest;
     pthread_mutex_t lock;
+    // imu_wait_for_sample calls parked on the current mapping's doorbell, and on the one a
+    // re-attach just replaced, which stays mapped until they've left it (under lock)
+    uint32_t doorbell_waiters;
+    uint32_t retired_doorbell_waiters;
 } IMUReader;
 
 // Device configuration from shared memory
@@ -116,6 +185,16 @@ typedef struct DeviceConfig {
     bool valid;
 } DeviceConfig;
 
+// Output timing derived from the RandR mode (exact, e.g. 59.94Hz rather than 60Hz)
+typedef struct DisplayTiming {
+    char output_name[64];
+    uint32_t width;
+    uint32_t height;
+    double refresh_hz;
+    int64_t frame_period_ns;
+    bool valid;
+} DisplayTiming;
+
 // Structure to pass DMA-BUF info from capture to render thread
 typedef struct {
     int dmabuf_fd;
@@ -128,17 +207,41 @@ typedef struct {
 } DmabufFrame;
 
 // DRM capture functions (in drm_capture.c)
+// Framebuffer ID lookup for a connector; returns 0 if there is none. Defaults to the RandR FRAMEBUFFER_ID property.
+typedef uint32_t (*DrmFramebufferIdSource)(const char *connector_name, void *user_data);
+void drm_capture_set_framebuffer_id_source(DrmFramebufferIdSource source, void *user_data);  // NULL restores RandR
 int init_drm_capture(CaptureThread *thread);
+int drm_capture_refresh(CaptureThread *thread);  // 0 unchanged, 1 rebound, 2 re-initialized, -1 error
 int export_drm_framebuffer_to_dmabuf(CaptureThread *thread, int *dmabuf_fd, uint32_t *format, uint32_t *stride, uint32_t *modifier);
 void cleanup_drm_capture(CaptureThread *thread);
 void drm_capture_keep_alive(const char *output_name);  // Keep-alive signal for virtual output (non-blocking, uses cached connection)
-void drm_capture_cleanup_keepalive(void);  // Cleanup cached keep-alive Display connection
+void drm_capture_cleanup_keepalive(void);  // Cleanup cached keep-alive and RandR query Display connections
+
+// Display timing functions (in display_timing.c); x_display may be NULL to use a temporary connection
+int query_output_timing(void *x_display, const char *output_name, DisplayTiming *timing);
+// window: the renderer's window, used to pick the output showing it (0 if there is none)
+int query_glasses_timing(void *x_display, const char *virtual_output_name, uint32_t window, DisplayTiming *timing);
+
+// Per-device look-ahead profiles (in look_ahead_profile.c); file I/O, so main loop only
+int look_ahead_profile_device_key(char *key, size_t size);
+int look_ahead_profile_load(const char *device_key, float *offset_ms);
+int look_ahead_profile_save(const char *device_key, float offset_ms);
 
 // IMU reader functions (in imu_reader.c)
 int init_imu_reader(IMUReader *reader);
 void cleanup_imu_reader(IMUReader *reader);
 IMUData read_latest_imu(IMUReader *reader);
 DeviceConfig read_device_config(IMUReader *reader);
+bool imu_source_enabled(IMUReader *reader);
+const char *imu_shm_path(void);  // IMU_SHM_PATH unless IMU_SHM_PATH_ENV is set
+// Re-map IMU_SHM_PATH if the driver replaced or resized it (call off the render path).
+// Returns 1 if re-attached, 0 if unchanged, -1 if the file is currently missing.
+int imu_reader_check_reattach(IMUReader *reader);
+// Block until the driver publishes a pose newer than *last_doorbell (the caller's own position,
+// updated on return), or until the absolute CLOCK_MONOTONIC deadline or a signal. Returns 1 on a
+// fresh sample, 0 on deadline/signal, -1 if the driver has no doorbell (caller should fall back
+// to sleeping).
+int imu_wait_for_sample(IMUReader *reader, uint32_t *last_doorbell, int64_t deadline_ns);
 
 // Shader loading functions (in shader_loader.c)
 int load_sombrero_shaders(RenderThread *thread, const char *frag_shader_path);
@@ -147,10 +250,32 @@ int load_sombrero_shaders(RenderThread *thread, const char *frag_shader_path);
 int init_opengl_context(RenderThread *thread);
 void cleanup_opengl_context(RenderThread *thread);
 void swap_buffers(RenderThread *thread);
+// When swap `sbc` was presented (CLOCK_MONOTONIC). Returns 1 with *present_ns set, 0 while it
+// is still pending, -1 if its timestamp is unavailable (no OML_sync_control, or superseded).
+int opengl_present_time(RenderThread *thread, int64_t sbc, int64_t *present_ns);
+// Bind the context to (or release it from) the calling thread; it can only be current on one thread
+int opengl_context_make_current(RenderThread *thread, bool current);
 
 // DMA-BUF texture import (in opengl_context.c)
 GLuint import_dmabuf_as_texture(RenderThread *thread, int dmabuf_fd, uint32_t width, uint32_t height, uint32_t format, uint32_t stride, uint64_t modifier);
 void cleanup_dmabuf_texture(RenderThread *thread);
 
+// Mipmapped sampling of the imported frame (in opengl_context.c)
+int update_mipmapped_texture(RenderThread *thread, uint32_t width, uint32_t height, const DamageRect *damage);
+void cleanup_mipmapped_texture(RenderThread *thread);
+
+// Headless latency mode (in headless.c); results are written to results_path for tests/latency_harness.c
+int headless_init(RenderThread *thread, const char *results_path);  // context must be current
+void headless_cleanup(RenderThread *thread);
+void headless_record_content(RenderThread *thread, uint32_t content_frame, int64_t produced_ns);  // any thread
+void headless_paint_content(RenderThread *thread, uint32_t content_frame);  // marker into the source texture
+void headless_present(RenderThread *thread);  // stands in for swap_buffers, reads the frame back asynchronously
+
+// Performance HUD (in hud.c); all on the render thread with its context current
+int hud_init(RenderThread *thread, bool enabled);
+void hud_cleanup(RenderThread *thread);
+void hud_record_frame(RenderThread *thread, int64_t swap_ns, int64_t period_ns);  // swap_ns 0 breaks the interval
+void hud_draw(RenderThread *thread, float capture_age_ms);  // no-op unless hud_enabled
+
 #endif
 
@@ -0,0 +1,160 @@
+/*
+ * Capture service IPC helpers
+ *
+ * Message framing and SCM_RIGHTS fd passing shared by breezy_capture_service
+ * and the renderer's capture client (see capture_ipc.h for the protocol)
+ */
+
+#define _GNU_SOURCE
+#include "capture_ipc.h"
+#include "logging.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+int capture_ipc_socket_path(char *path, size_t size) {
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (!runtime_dir || !runtime_dir[0]) {
+        return -1;
+    }
+
+    int written = snprintf(path, size, "%s/breezy_desktop/%s", runtime_dir, CAPTURE_IPC_SOCKET_NAME);
+    if (written < 0 || (size_t)written >= size) {
+        return -1;
+    }
+    return 0;
+}
+
+void capture_ipc_message_init(CaptureMessage *msg, CaptureMessageType type) {
+    memset(msg, 0, sizeof(*msg));
+    msg->magic = CAPTURE_IPC_MAGIC;
+    msg->version = CAPTURE_IPC_VERSION;
+    msg->type = (uint16_t)type;
+}
+
+int capture_ipc_send(int sock, const CaptureMessage *msg, int fd) {
+    struct iovec iov = { .iov_base = (void *)msg, .iov_len = sizeof(*msg) };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr hdr = {0};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    if (fd >= 0) {
+        memset(&control, 0, sizeof(control));
+        hdr.msg_control = control.buf;
+        hdr.msg_controllen = sizeof(control.buf);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    ssize_t sent = sendmsg(sock, &hdr, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 1;
+        }
+        return -1;
+    }
+    return sent == (ssize_t)sizeof(*msg) ? 0 : -1;
+}
+
+int capture_ipc_recv(int sock, CaptureMessage *msg, int *fd) {
+    struct iovec iov = { .iov_base = msg, .iov_len = sizeof(*msg) };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+
+    struct msghdr hdr = {0};
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control.buf;
+    hdr.msg_controllen = sizeof(control.buf);
+
+    if (fd) {
+        *fd = -1;
+    }
+
+    ssize_t received = recvmsg(sock, &hdr, MSG_CMSG_CLOEXEC);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 1;
+        }
+        return -1;
+    }
+    if (received == 0) {
+        return -1;  // Peer closed
+    }
+
+    int passed_fd = -1;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(&passed_fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    if (received != (ssize_t)sizeof(*msg) || msg->magic != CAPTURE_IPC_MAGIC ||
+        msg->version != CAPTURE_IPC_VERSION) {
+        log_warn("[CaptureIPC] Dropping malformed message (%zd bytes)\n", received);
+        if (passed_fd >= 0) {
+            close(passed_fd);
+        }
+        return -1;
+    }
+
+    if (fd) {
+        *fd = passed_fd;
+    } else if (passed_fd >= 0) {
+        close(passed_fd);
+    }
+    return 0;
+}
+
+int capture_ipc_connect(uint32_t max_in_flight) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    if (capture_ipc_socket_path(path, sizeof(path)) != 0) {
+        return -1;
+    }
+
+    if (access(path, F_OK) != 0) {
+        return -1;  // No service running - caller captures in-process
+    }
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        log_error("[CaptureIPC] Failed to create socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        log_warn("[CaptureIPC] Capture service socket %s present but not accepting: %s\n", path, strerror(errno));
+        close(sock);
+        return -1;
+    }
+
+    CaptureMessage hello;
+    capture_ipc_message_init(&hello, CAPTURE_MSG_HELLO);
+    hello.max_in_flight = max_in_flight;
+    if (capture_ipc_send(sock, &hello, -1) != 0) {
+        log_error("[CaptureIPC] Failed to send HELLO to capture service\n");
+        close(sock);
+        return -1;
+    }
+
+    log_info("[CaptureIPC] Connected to capture service at %s\n", path);
+    return sock;
+}
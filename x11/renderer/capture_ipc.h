@@ -0,0 +1,70 @@
+#ifndef BREEZY_CAPTURE_IPC_H
+#define BREEZY_CAPTURE_IPC_H
+
+/*
+ * Wire protocol between breezy_capture_service and its subscribers
+ *
+ * One capture service owns the RandR/DRM work for a virtual output and fans the
+ * resulting DMA-BUF out to any number of sinks over a SOCK_SEQPACKET Unix socket.
+ *
+ * Subscriber -> service:
+ *   HELLO   max_in_flight = how many FRAME messages may be outstanding un-acked
+ *   ACK     sequence = newest frame the subscriber has consumed (acks all older ones)
+ *
+ * Service -> subscriber:
+ *   FORMAT  framebuffer description, DMA-BUF fd attached via SCM_RIGHTS. Sent on
+ *           connect and whenever the framebuffer is replaced (mode change).
+ *   FRAME   sequence number of a new capture tick for the current framebuffer.
+ *           Skipped for subscribers that already have max_in_flight frames un-acked,
+ *           so a slow sink never stalls the service or other sinks.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CAPTURE_IPC_MAGIC 0x50414342  // "BCAP"
+#define CAPTURE_IPC_VERSION 1
+#define CAPTURE_IPC_SOCKET_NAME "capture.sock"
+#define CAPTURE_IPC_DEFAULT_MAX_IN_FLIGHT 2
+#define CAPTURE_IPC_MAX_IN_FLIGHT 8
+
+typedef enum {
+    CAPTURE_MSG_HELLO = 1,
+    CAPTURE_MSG_FORMAT = 2,
+    CAPTURE_MSG_FRAME = 3,
+    CAPTURE_MSG_ACK = 4
+} CaptureMessageType;
+
+typedef struct CaptureMessage {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;          // CaptureMessageType
+    uint32_t sequence;      // FRAME/ACK: capture sequence number
+    uint32_t fb_id;         // FORMAT/FRAME: framebuffer the message refers to
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;        // DRM fourcc
+    uint32_t stride;
+    uint64_t modifier;
+    uint32_t max_in_flight; // HELLO only
+    uint32_t reserved;
+} CaptureMessage;
+
+// Build the socket path ($XDG_RUNTIME_DIR/breezy_desktop/capture.sock); returns 0 on success
+int capture_ipc_socket_path(char *path, size_t size);
+
+// Initialize a message header of the given type
+void capture_ipc_message_init(CaptureMessage *msg, CaptureMessageType type);
+
+// Send a message, optionally passing fd (-1 for none) via SCM_RIGHTS. Never blocks.
+// Returns 0 on success, 1 if the socket buffer is full, -1 on error/disconnect.
+int capture_ipc_send(int sock, const CaptureMessage *msg, int fd);
+
+// Receive one message; *fd receives an attached descriptor or -1 (caller owns it).
+// Returns 0 on success, 1 if nothing is queued (non-blocking sockets), -1 on error/disconnect.
+int capture_ipc_recv(int sock, CaptureMessage *msg, int *fd);
+
+// Connect to a running capture service and announce max_in_flight. Returns socket or -1.
+int capture_ipc_connect(uint32_t max_in_flight);
+
+#endif
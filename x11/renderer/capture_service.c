@@ -0,0 +1,400 @@
+/*
+ * Breezy Desktop Capture Service
+ *
+ * Runs the DRM/KMS capture stage for a virtual XR output once and publishes the
+ * exported DMA-BUF plus per-tick sequence numbers to any number of subscribers
+ * (standalone renderer, streaming sink, recorder, ...) over a Unix socket.
+ *
+ * The RandR lookup, drmModeGetFB check and PRIME export happen here only; each
+ * subscriber just imports the fd it was handed. Subscribers acknowledge consumed
+ * frames, and a subscriber with too many un-acked frames is skipped for that tick
+ * instead of queueing behind it (per-subscriber backpressure).
+ *
+ * Usage: breezy_capture_service [connector] [capture_fps]
+ *        capture_fps defaults to (or 0 selects) the connector's actual mode timing
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include "breezy_x11_renderer.h"
+#include "capture_ipc.h"
+#include "logging.h"
+
+#define MAX_SUBSCRIBERS 16
+
+typedef struct Subscriber {
+    int sock;                   // -1 if slot unused
+    uint32_t max_in_flight;
+    uint32_t sent_fb_id;        // Framebuffer last described to this subscriber (0 = none)
+    uint32_t in_flight[CAPTURE_IPC_MAX_IN_FLIGHT];  // Sequences sent but not yet acked
+    uint32_t in_flight_count;
+    uint64_t frames_sent;
+    uint64_t frames_skipped;
+} Subscriber;
+
+static volatile sig_atomic_t g_running = 1;
+
+static void signal_handler(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+static void *keepalive_thread_func(void *arg) {
+    CaptureThread *capture = (CaptureThread *)arg;
+    while (!capture->stop_requested) {
+        struct timespec sleep_time = { .tv_sec = 1, .tv_nsec = 500000000 };  // 1.5 seconds
+        nanosleep(&sleep_time, NULL);
+        if (capture->stop_requested)
+            break;
+        drm_capture_keep_alive(capture->connector_name);
+    }
+    return NULL;
+}
+
+static int create_listen_socket(char *path, size_t path_size) {
+    if (capture_ipc_socket_path(path, path_size) != 0) {
+        log_error("[CaptureService] XDG_RUNTIME_DIR not set, cannot create socket\n");
+        return -1;
+    }
+
+    // Create $XDG_RUNTIME_DIR/breezy_desktop if needed
+    char dir[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash) {
+        *slash = '\0';
+        if (mkdir(dir, 0700) == -1 && errno != EEXIST) {
+            log_error("[CaptureService] Failed to create %s: %s\n", dir, strerror(errno));
+            return -1;
+        }
+    }
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        log_error("[CaptureService] Failed to create socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    unlink(path);  // Stale socket from a previous run
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(sock, MAX_SUBSCRIBERS) != 0) {
+        log_error("[CaptureService] Failed to listen on %s: %s\n", path, strerror(errno));
+        close(sock);
+        return -1;
+    }
+
+    log_info("[CaptureService] Listening on %s\n", path);
+    return sock;
+}
+
+static void drop_subscriber(Subscriber *sub) {
+    if (sub->sock < 0) {
+        return;
+    }
+    log_info("[CaptureService] Subscriber %d disconnected (sent=%llu, skipped=%llu)\n",
+             sub->sock, (unsigned long long)sub->frames_sent, (unsigned long long)sub->frames_skipped);
+    close(sub->sock);
+    memset(sub, 0, sizeof(*sub));
+    sub->sock = -1;
+}
+
+static void accept_subscribers(int listen_sock, Subscriber *subs) {
+    while (true) {
+        int sock = accept4(listen_sock, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (sock < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                log_warn("[CaptureService] accept failed: %s\n", strerror(errno));
+            }
+            return;
+        }
+
+        Subscriber *slot = NULL;
+        for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+            if (subs[i].sock < 0) {
+                slot = &subs[i];
+                break;
+            }
+        }
+        if (!slot) {
+            log_warn("[CaptureService] Subscriber limit (%d) reached, rejecting connection\n", MAX_SUBSCRIBERS);
+            close(sock);
+            continue;
+        }
+
+        memset(slot, 0, sizeof(*slot));
+        slot->sock = sock;
+        slot->max_in_flight = CAPTURE_IPC_DEFAULT_MAX_IN_FLIGHT;
+        log_info("[CaptureService] Subscriber %d connected\n", sock);
+    }
+}
+
+// Drain HELLO/ACK messages from a subscriber
+static void read_subscriber(Subscriber *sub) {
+    while (sub->sock >= 0) {
+        CaptureMessage msg;
+        int ret = capture_ipc_recv(sub->sock, &msg, NULL);
+        if (ret == 1) {
+            return;
+        }
+        if (ret < 0) {
+            drop_subscriber(sub);
+            return;
+        }
+
+        if (msg.type == CAPTURE_MSG_HELLO) {
+            uint32_t max = msg.max_in_flight;
+            if (max == 0) max = CAPTURE_IPC_DEFAULT_MAX_IN_FLIGHT;
+            if (max > CAPTURE_IPC_MAX_IN_FLIGHT) max = CAPTURE_IPC_MAX_IN_FLIGHT;
+            sub->max_in_flight = max;
+        } else if (msg.type == CAPTURE_MSG_ACK) {
+            // Acking a sequence retires it and everything sent before it
+            uint32_t kept = 0;
+            for (uint32_t i = 0; i < sub->in_flight_count; i++) {
+                if ((int32_t)(sub->in_flight[i] - msg.sequence) > 0) {
+                    sub->in_flight[kept++] = sub->in_flight[i];
+                }
+            }
+            sub->in_flight_count = kept;
+        }
+    }
+}
+
+static void publish_frame(CaptureThread *capture, Subscriber *subs, uint32_t sequence) {
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        Subscriber *sub = &subs[i];
+        if (sub->sock < 0) {
+            continue;
+        }
+
+        if (sub->sent_fb_id != capture->fb_id) {
+            CaptureMessage format;
+            capture_ipc_message_init(&format, CAPTURE_MSG_FORMAT);
+            format.fb_id = capture->fb_id;
+            format.width = capture->width;
+            format.height = capture->height;
+            format.format = capture->cached_format;
+            format.stride = capture->cached_stride;
+            format.modifier = capture->cached_modifier;
+
+            int ret = capture_ipc_send(sub->sock, &format, capture->cached_dmabuf_fd);
+            if (ret < 0) {
+                drop_subscriber(sub);
+                continue;
+            }
+            if (ret == 1) {
+                continue;  // Socket full - retry the format on the next tick
+            }
+            sub->sent_fb_id = capture->fb_id;
+            sub->in_flight_count = 0;  // Frames of the old framebuffer no longer matter
+        }
+
+        if (sub->in_flight_count >= sub->max_in_flight) {
+            sub->frames_skipped++;
+            continue;
+        }
+
+        CaptureMessage frame;
+        capture_ipc_message_init(&frame, CAPTURE_MSG_FRAME);
+        frame.sequence = sequence;
+        frame.fb_id = capture->fb_id;
+        frame.width = capture->width;
+        frame.height = capture->height;
+
+        int ret = capture_ipc_send(sub->sock, &frame, -1);
+        if (ret < 0) {
+            drop_subscriber(sub);
+        } else if (ret == 1) {
+            sub->frames_skipped++;
+        } else {
+            sub->in_flight[sub->in_flight_count++] = sequence;
+            sub->frames_sent++;
+        }
+    }
+}
+
+// Same lightweight validity check the in-process capture thread does each tick
+static bool refresh_framebuffer(CaptureThread *capture) {
+    int refreshed = drm_capture_refresh(capture);
+    if (refreshed > 0) {
+        log_info("[CaptureService] Capturing FB ID %u (%ux%u)\n", capture->fb_id, capture->width, capture->height);
+    }
+    return refreshed >= 0;
+}
+
+// Capture at the connector's exact mode rate unless a rate was given on the command line
+static void update_capture_period(CaptureThread *capture, double rate_override) {
+    DisplayTiming timing;
+    if (rate_override > 0.0) {
+        capture->frame_period_ns = (int64_t)(1e9 / rate_override);
+    } else if (query_output_timing(NULL, capture->connector_name, &timing) == 0) {
+        capture->frame_period_ns = timing.frame_period_ns;
+    } else if (capture->frame_period_ns == 0) {
+        capture->frame_period_ns = 1000000000LL / 60;
+    }
+}
+
+static int64_t timespec_to_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    if (log_init() != 0) {
+        fprintf(stderr, "Warning: Failed to initialize logging, continuing with stderr output\n");
+    }
+
+    CaptureThread capture;
+    memset(&capture, 0, sizeof(capture));
+    capture.drm_fd = -1;
+    capture.cached_dmabuf_fd = -1;
+    capture.connector_name = argc > 1 ? argv[1] : "XR-0";
+    double rate_override = argc > 2 ? atof(argv[2]) : 0.0;
+    if (rate_override < 0.0) {
+        fprintf(stderr, "Usage: %s [connector] [capture_fps]\n", argv[0]);
+        log_cleanup();
+        return 1;
+    }
+    update_capture_period(&capture, rate_override);
+
+    log_info("[CaptureService] Starting for %s at %.3fHz\n", capture.connector_name,
+             1e9 / (double)capture.frame_period_ns);
+
+    char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    int listen_sock = create_listen_socket(socket_path, sizeof(socket_path));
+    if (listen_sock < 0) {
+        log_cleanup();
+        return 1;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    pthread_t keepalive_thread;
+    bool keepalive_started = pthread_create(&keepalive_thread, NULL, keepalive_thread_func, &capture) == 0;
+    if (!keepalive_started) {
+        log_error("[CaptureService] Warning: Failed to create keep-alive thread\n");
+    }
+
+    Subscriber subs[MAX_SUBSCRIBERS];
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        memset(&subs[i], 0, sizeof(subs[i]));
+        subs[i].sock = -1;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t next_tick_ns = timespec_to_ns(&now);
+    uint32_t sequence = 0;
+
+    while (g_running) {
+        // Wait for socket activity until the next capture tick
+        struct pollfd fds[MAX_SUBSCRIBERS + 1];
+        int sub_index[MAX_SUBSCRIBERS + 1];
+        nfds_t nfds = 0;
+        fds[nfds].fd = listen_sock;
+        fds[nfds].events = POLLIN;
+        sub_index[nfds++] = -1;
+        int subscriber_count = 0;
+        for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+            if (subs[i].sock >= 0) {
+                fds[nfds].fd = subs[i].sock;
+                fds[nfds].events = POLLIN;
+                sub_index[nfds++] = i;
+                subscriber_count++;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t wait_ns = next_tick_ns - timespec_to_ns(&now);
+        // With no subscribers there is nothing to capture for - sleep until someone connects
+        int timeout_ms = subscriber_count == 0 ? -1 : (wait_ns > 0 ? (int)((wait_ns + 999999) / 1000000) : 0);
+
+        int ready = poll(fds, nfds, timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            log_error("[CaptureService] poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        if (ready > 0) {
+            for (nfds_t i = 0; i < nfds; i++) {
+                if (!fds[i].revents) {
+                    continue;
+                }
+                if (sub_index[i] < 0) {
+                    accept_subscribers(listen_sock, subs);
+                } else if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                    drop_subscriber(&subs[sub_index[i]]);
+                } else {
+                    read_subscriber(&subs[sub_index[i]]);
+                }
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t now_ns = timespec_to_ns(&now);
+        if (now_ns < next_tick_ns) {
+            continue;
+        }
+        // Don't try to catch up on missed ticks after an idle period
+        next_tick_ns += capture.frame_period_ns;
+        if (next_tick_ns < now_ns) {
+            next_tick_ns = now_ns + capture.frame_period_ns;
+        }
+
+        bool have_subscribers = false;
+        for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+            have_subscribers |= subs[i].sock >= 0;
+        }
+        if (!have_subscribers) {
+            continue;
+        }
+
+        uint32_t previous_fb_id = capture.fb_id;
+        if (!refresh_framebuffer(&capture)) {
+            continue;  // Retried on the next tick
+        }
+        if (capture.fb_id != previous_fb_id) {
+            update_capture_period(&capture, rate_override);  // New framebuffer usually means a new mode
+        }
+
+        publish_frame(&capture, subs, ++sequence);
+    }
+
+    log_info("[CaptureService] Shutting down\n");
+
+    capture.stop_requested = true;
+    if (keepalive_started) {
+        pthread_join(keepalive_thread, NULL);
+    }
+
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
+        drop_subscriber(&subs[i]);
+    }
+    close(listen_sock);
+    unlink(socket_path);
+
+    cleanup_drm_capture(&capture);
+    drm_capture_cleanup_keepalive();
+    log_cleanup();
+    return 0;
+}
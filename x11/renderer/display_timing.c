@@ -0,0 +1,226 @@
+/*
+ * Display timing discovery via XRandR
+ *
+ * Derives exact refresh rates from RandR mode timings (pixel clock / total
+ * pixels per frame) instead of the rounded rates xrandr prints, so fractional
+ * modes like 59.94Hz or 119.88Hz pace correctly. RandR builds these modes from
+ * the EDID detailed timings, so no separate EDID parsing is needed.
+ */
+
+#include "breezy_x11_renderer.h"
+#include "logging.h"
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/extensions/Xrandr.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLASSES_OUTPUT_ENV "BREEZY_GLASSES_OUTPUT"
+
+// Refresh rate of a mode from its timing (handles interlaced and doublescan modes)
+static double mode_refresh_hz(const XRRModeInfo *mode) {
+    if (!mode->hTotal || !mode->vTotal) {
+        return 0.0;
+    }
+
+    double v_total = (double)mode->vTotal;
+    if (mode->modeFlags & RR_DoubleScan) {
+        v_total *= 2.0;
+    }
+    if (mode->modeFlags & RR_Interlace) {
+        v_total /= 2.0;
+    }
+
+    return (double)mode->dotClock / ((double)mode->hTotal * v_total);
+}
+
+static const XRRModeInfo *find_mode(const XRRScreenResources *res, RRMode id) {
+    for (int i = 0; i < res->nmode; i++) {
+        if (res->modes[i].id == id) {
+            return &res->modes[i];
+        }
+    }
+    return NULL;
+}
+
+// True if the output advertises the "non-desktop" property (HMDs hidden from the desktop)
+static bool output_is_non_desktop(Display *dpy, RROutput output) {
+    Atom prop_atom = XInternAtom(dpy, "non-desktop", True);
+    if (prop_atom == None) {
+        return false;
+    }
+
+    Atom actual_type;
+    int actual_format;
+    unsigned long nitems, bytes_after;
+    unsigned char *prop_data = NULL;
+    bool non_desktop = false;
+
+    if (XRRGetOutputProperty(dpy, output, prop_atom, 0, 1, False, False, AnyPropertyType,
+                             &actual_type, &actual_format, &nitems, &bytes_after, &prop_data) == Success &&
+        prop_data && nitems == 1 && actual_format == 32) {
+        non_desktop = *((long *)prop_data) != 0;
+    }
+
+    if (prop_data) {
+        XFree(prop_data);
+    }
+    return non_desktop;
+}
+
+// Fill timing from the mode currently driven on the output's CRTC
+static int timing_from_output(Display *dpy, XRRScreenResources *res, XRROutputInfo *info, DisplayTiming *timing) {
+    if (info->connection != RR_Connected || !info->crtc) {
+        return -1;
+    }
+
+    XRRCrtcInfo *crtc = XRRGetCrtcInfo(dpy, res, info->crtc);
+    if (!crtc) {
+        return -1;
+    }
+
+    const XRRModeInfo *mode = crtc->mode ? find_mode(res, crtc->mode) : NULL;
+    double refresh_hz = mode ? mode_refresh_hz(mode) : 0.0;
+    XRRFreeCrtcInfo(crtc);
+
+    if (refresh_hz <= 0.0) {
+        return -1;
+    }
+
+    memset(timing, 0, sizeof(*timing));
+    snprintf(timing->output_name, sizeof(timing->output_name), "%s", info->name);
+    timing->width = mode->width;
+    timing->height = mode->height;
+    timing->refresh_hz = refresh_hz;
+    timing->frame_period_ns = (int64_t)(1e9 / refresh_hz + 0.5);
+    timing->valid = true;
+    return 0;
+}
+
+// True if the output's CRTC covers the given root-window point
+static bool output_contains_point(Display *dpy, XRRScreenResources *res, XRROutputInfo *info, int x, int y) {
+    if (info->connection != RR_Connected || !info->crtc) {
+        return false;
+    }
+
+    XRRCrtcInfo *crtc = XRRGetCrtcInfo(dpy, res, info->crtc);
+    if (!crtc) {
+        return false;
+    }
+    bool contains = x >= crtc->x && y >= crtc->y &&
+                    x < crtc->x + (int)crtc->width && y < crtc->y + (int)crtc->height;
+    XRRFreeCrtcInfo(crtc);
+    return contains;
+}
+
+// Centre of the window in root coordinates
+static bool window_center(Display *dpy, Window window, int *x, int *y) {
+    XWindowAttributes attrs;
+    Window child;
+    if (!window || !XGetWindowAttributes(dpy, window, &attrs) ||
+        !XTranslateCoordinates(dpy, window, DefaultRootWindow(dpy), attrs.width / 2, attrs.height / 2, x, y, &child)) {
+        return false;
+    }
+    return true;
+}
+
+// Shared walk over RandR outputs; open our own connection if the caller didn't pass one
+static int find_output_timing(void *x_display, const char *output_name, const char *exclude_name,
+                              uint32_t window, DisplayTiming *timing) {
+    Display *dpy = (Display *)x_display;
+    bool own_display = false;
+    if (!dpy) {
+        dpy = XOpenDisplay(NULL);
+        if (!dpy) {
+            log_error("[Timing] Failed to open X display for RandR query\n");
+            return -1;
+        }
+        own_display = true;
+    }
+
+    int result = -1;
+    int event_base, error_base;
+    XRRScreenResources *res = NULL;
+    if (!XRRQueryExtension(dpy, &event_base, &error_base) ||
+        !(res = XRRGetScreenResourcesCurrent(dpy, DefaultRootWindow(dpy)))) {
+        log_error("[Timing] XRandR screen resources not available\n");
+        goto done;
+    }
+
+    if (output_name) {
+        for (int i = 0; i < res->noutput && result != 0; i++) {
+            XRROutputInfo *info = XRRGetOutputInfo(dpy, res, res->outputs[i]);
+            if (!info) continue;
+            if (strcmp(info->name, output_name) == 0) {
+                result = timing_from_output(dpy, res, info, timing);
+            }
+            XRRFreeOutputInfo(info);
+        }
+        goto done;
+    }
+
+    // Glasses: prefer an output flagged non-desktop, then the physical output showing the
+    // renderer's window, and only as a guess the first active physical output (on a laptop
+    // that is usually the built-in panel, not the glasses)
+    int window_x = 0, window_y = 0;
+    bool have_window = window_center(dpy, (Window)window, &window_x, &window_y);
+    for (int pass = 0; pass < 3 && result != 0; pass++) {
+        if (pass == 1 && !have_window) {
+            continue;
+        }
+        for (int i = 0; i < res->noutput && result != 0; i++) {
+            XRROutputInfo *info = XRRGetOutputInfo(dpy, res, res->outputs[i]);
+            if (!info) continue;
+            bool is_virtual = strncmp(info->name, "XR-", 3) == 0 ||
+                              (exclude_name && strcmp(info->name, exclude_name) == 0);
+            bool candidate = pass == 0 ? output_is_non_desktop(dpy, res->outputs[i]) :
+                             pass == 1 ? !is_virtual && output_contains_point(dpy, res, info, window_x, window_y) :
+                                         !is_virtual;
+            if (candidate) {
+                result = timing_from_output(dpy, res, info, timing);
+                if (result == 0 && pass == 2) {
+                    log_warn("[Timing] Guessing %s is the glasses output (set %s to choose one)\n",
+                             info->name, GLASSES_OUTPUT_ENV);
+                }
+            }
+            XRRFreeOutputInfo(info);
+        }
+    }
+
+done:
+    if (res) {
+        XRRFreeScreenResources(res);
+    }
+    if (own_display) {
+        XCloseDisplay(dpy);
+    }
+    return result;
+}
+
+int query_output_timing(void *x_display, const char *output_name, DisplayTiming *timing) {
+    if (find_output_timing(x_display, output_name, NULL, 0, timing) != 0) {
+        log_warn("[Timing] No active mode found for output %s\n", output_name);
+        return -1;
+    }
+
+    log_info("[Timing] %s: %ux%u @ %.3fHz (period %lld ns)\n", timing->output_name,
+             timing->width, timing->height, timing->refresh_hz, (long long)timing->frame_period_ns);
+    return 0;
+}
+
+int query_glasses_timing(void *x_display, const char *virtual_output_name, uint32_t window, DisplayTiming *timing) {
+    const char *override = getenv(GLASSES_OUTPUT_ENV);
+    if (override && override[0]) {
+        return query_output_timing(x_display, override, timing);
+    }
+
+    if (find_output_timing(x_display, NULL, virtual_output_name, window, timing) != 0) {
+        log_warn("[Timing] Could not identify the glasses output (set %s to choose one)\n", GLASSES_OUTPUT_ENV);
+        return -1;
+    }
+
+    log_info("[Timing] Glasses output %s: %ux%u @ %.3fHz (period %lld ns)\n", timing->output_name,
+             timing->width, timing->height, timing->refresh_hz, (long long)timing->frame_period_ns);
+    return 0;
+}
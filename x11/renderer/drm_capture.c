@@ -6,6 +6,7 @@
  * 
  * Framebuffer ID is obtained via XRandR property (FRAMEBUFFER_ID) on XR-0 output,
  * since virtual outputs don't have KMS connectors and can't be found via DRM enumeration.
+ * drm_capture_set_framebuffer_id_source replaces that lookup (tests/vkms_capture_harness.c).
  */
 
 #define _POSIX_C_SOURCE 200809L  // for O_CLOEXEC
@@ -140,32 +141,46 @@ void drm_capture_keep_alive(const char *output_name) {
     // Don't close display - keep it cached for next time
 }
 
-/* Cleanup function to close cached Display connection */
+// Connection for FRAMEBUFFER_ID lookups, kept open so a framebuffer change doesn't pay for
+// connection setup. Only one thread captures, so it isn't shared.
+static Display *randr_display = NULL;
+static Atom framebuffer_id_atom = None;
+
+/* Cleanup function to close cached Display connections */
 void drm_capture_cleanup_keepalive(void) {
     if (keepalive_display) {
         XCloseDisplay(keepalive_display);
         keepalive_display = NULL;
     }
+    if (randr_display) {
+        XCloseDisplay(randr_display);
+        randr_display = NULL;
+        framebuffer_id_atom = None;
+    }
 }
 
 static uint32_t query_framebuffer_id_from_randr(const char *output_name) {
-    Display *dpy = XOpenDisplay(NULL);
-    if (!dpy) {
-        log_error("[DRM] Failed to open X display for RandR query\n");
-        return 0;
-    }
-    
-    int event_base, error_base;
-    if (!XRRQueryExtension(dpy, &event_base, &error_base)) {
-        log_error("[DRM] XRandR extension not available\n");
-        XCloseDisplay(dpy);
-        return 0;
+    if (!randr_display) {
+        randr_display = XOpenDisplay(NULL);
+        if (!randr_display) {
+            log_error("[DRM] Failed to open X display for RandR query\n");
+            return 0;
+        }
+
+        int event_base, error_base;
+        if (!XRRQueryExtension(randr_display, &event_base, &error_base)) {
+            log_error("[DRM] XRandR extension not available\n");
+            XCloseDisplay(randr_display);
+            randr_display = NULL;
+            return 0;
+        }
     }
-    
-    XRRScreenResources *screen_res = XRRGetScreenResources(dpy, DefaultRootWindow(dpy));
+    Display *dpy = randr_display;
+
+    // The current resources are enough to find the output and don't make the server re-probe
+    XRRScreenResources *screen_res = XRRGetScreenResourcesCurrent(dpy, DefaultRootWindow(dpy));
     if (!screen_res) {
         log_error("[DRM] Failed to get XRandR screen resources\n");
-        XCloseDisplay(dpy);
         return 0;
     }
     
@@ -180,7 +195,10 @@ static uint32_t query_framebuffer_id_from_randr(const char *output_name) {
         
         if (strcmp(output_info->name, output_name) == 0) {
             // Found the output, query FRAMEBUFFER_ID property
-            Atom prop_atom = XInternAtom(dpy, FRAMEBUFFER_ID_PROPERTY, False);
+            if (framebuffer_id_atom == None) {
+                framebuffer_id_atom = XInternAtom(dpy, FRAMEBUFFER_ID_PROPERTY, False);
+            }
+            Atom prop_atom = framebuffer_id_atom;
             if (prop_atom != None) {
                 Atom actual_type;
                 int actual_format;
@@ -215,7 +233,6 @@ static uint32_t query_framebuffer_id_from_randr(const char *output_name) {
     }
     
     XRRFreeScreenResources(screen_res);
-    XCloseDisplay(dpy);
     
     if (fb_id == 0) {
         log_error("[DRM] Output %s not found or FRAMEBUFFER_ID property not set\n", output_name);
@@ -224,6 +241,20 @@ static uint32_t query_framebuffer_id_from_randr(const char *output_name) {
     return fb_id;
 }
 
+static DrmFramebufferIdSource framebuffer_id_source = NULL;
+static void *framebuffer_id_source_data = NULL;
+
+void drm_capture_set_framebuffer_id_source(DrmFramebufferIdSource source, void *user_data) {
+    framebuffer_id_source = source;
+    framebuffer_id_source_data = user_data;
+}
+
+static uint32_t query_framebuffer_id(const char *connector_name) {
+    return framebuffer_id_source
+        ? framebuffer_id_source(connector_name, framebuffer_id_source_data)
+        : query_framebuffer_id_from_randr(connector_name);
+}
+
 /**
  * Try to find framebuffer in devices matching a prefix (e.g., "renderD" or "card")
  * Returns 0 on success, -1 on failure
@@ -296,10 +327,10 @@ static int find_drm_device_for_framebuffer(uint32_t fb_id, char *device_path, si
 
 // Initialize DRM capture
 int init_drm_capture(CaptureThread *thread) {
-    // Query framebuffer ID from XRandR property
-    uint32_t fb_id = query_framebuffer_id_from_randr(thread->connector_name);
+    // Query framebuffer ID from XRandR property (or the source installed in its place)
+    uint32_t fb_id = query_framebuffer_id(thread->connector_name);
     if (fb_id == 0) {
-        log_error("[DRM] Failed to get framebuffer ID from XRandR property\n");
+        log_error("[DRM] Failed to get framebuffer ID for %s\n", thread->connector_name);
         return -1;
     }
     
@@ -362,6 +393,74 @@ int init_drm_capture(CaptureThread *thread) {
     return 0;
 }
 
+// Fast path for a framebuffer change: the new framebuffer is normally on the device that is
+// already open, so only it is looked up and exported - no device probing or reopening.
+// Returns 0 on success, -1 if the connector has no new framebuffer yet, -2 if the new one
+// isn't on this device (or can't be exported) and capture needs a full re-init
+static int rebind_drm_capture(CaptureThread *thread) {
+    uint32_t fb_id = query_framebuffer_id(thread->connector_name);
+    if (fb_id == 0 || fb_id == thread->fb_id) {
+        return -1;
+    }
+
+    drmModeFBPtr fb_info = drmModeGetFB(thread->drm_fd, fb_id);
+    if (!fb_info) {
+        return -2;
+    }
+
+    if (thread->cached_dmabuf_fd >= 0) {
+        close(thread->cached_dmabuf_fd);
+        thread->cached_dmabuf_fd = -1;
+    }
+    if (thread->fb_info) {
+        drmModeFreeFB(thread->fb_info);
+    }
+    thread->fb_info = fb_info;
+    thread->fb_id = fb_id;
+    thread->width = fb_info->width;
+    thread->height = fb_info->height;
+    thread->fb_handle = fb_info->handle;
+
+    if (export_drm_framebuffer_to_dmabuf(thread, &thread->cached_dmabuf_fd,
+                                          &thread->cached_format,
+                                          &thread->cached_stride,
+                                          &thread->cached_modifier) < 0) {
+        return -2;
+    }
+
+    log_info("[DRM] Rebound to framebuffer ID %u: %dx%d, DMA-BUF FD %d\n",
+             fb_id, thread->width, thread->height, thread->cached_dmabuf_fd);
+    return 0;
+}
+
+// Per-tick check shared by the capture thread and the capture service: drmModeGetFB fails
+// once the framebuffer is destroyed (mode change), and capture moves to the connector's new
+// framebuffer - on the same DRM device if it's there, otherwise by re-initializing.
+// Returns 0 if the framebuffer is unchanged, 1 if capture was rebound, 2 if it was
+// re-initialized, -1 on error (including no new framebuffer yet - retry next tick)
+int drm_capture_refresh(CaptureThread *thread) {
+    if (thread->drm_fd >= 0 && thread->cached_dmabuf_fd >= 0) {
+        drmModeFBPtr fb_check = drmModeGetFB(thread->drm_fd, thread->fb_id);
+        if (fb_check) {
+            drmModeFreeFB(fb_check);
+            return 0;
+        }
+
+        int rebound = rebind_drm_capture(thread);
+        if (rebound == 0) {
+            return 1;
+        }
+        if (rebound == -1) {
+            log_debug("[DRM] Framebuffer ID %u invalidated, waiting for the new one\n", thread->fb_id);
+            return -1;
+        }
+        log_info("[DRM] New framebuffer isn't on the open device, re-initializing capture\n");
+    }
+
+    cleanup_drm_capture(thread);
+    return init_drm_capture(thread) < 0 ? -1 : 2;
+}
+
 // Export DRM framebuffer as DMA-BUF file descriptor (zero-copy)
 // Returns 0 on success, -1 on error, -2 if framebuffer changed (FB ID invalidated)
 int export_drm_framebuffer_to_dmabuf(CaptureThread *thread, int *dmabuf_fd, uint32_t *format, uint32_t *stride, uint32_t *modifier) {
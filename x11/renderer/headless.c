@@ -0,0 +1,211 @@
+/*
+ * Headless latency mode
+ *
+ * With BREEZY_RENDERER_HEADLESS=<results file>, the renderer runs on a surfaceless EGL
+ * context and renders into an offscreen framebuffer instead of the glasses. Capture is
+ * replaced by a source thread that publishes numbered content frames; each one is
+ * painted into the source texture as a solid marker color (R, G = frame number low
+ * bits, B = 255) so it survives the Sombrero warp and filtering.
+ *
+ * "Presenting" a frame reads the middle row of the output into a PBO ring with a fence
+ * and doesn't wait for it; completed readbacks are collected on later frames. From the
+ * row we record the content frame on screen (center pixel) and the left edge of the
+ * virtual display (first marker pixel), which moves when the pose does. The results
+ * file holds one line per event, for tests/latency_harness.c:
+ *
+ *   content <frame> <produced_ns>
+ *   present <frame> <submit_ns> <complete_ns> <edge_x> <content_frame>
+ *
+ * Times are CLOCK_MONOTONIC. complete_ns is when the readback was seen complete, so
+ * it is late by at most one render period; edge_x is -1 if no marker pixel is visible.
+ */
+
+#define _GNU_SOURCE
+#include "breezy_x11_renderer.h"
+#include "logging.h"
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define READBACK_DEPTH 4  // Frames in flight between present and readback
+#define MARKER_BLUE 255
+#define MARKER_THRESHOLD 128
+
+typedef struct {
+    GLuint pbo;
+    GLsync fence;
+    uint32_t frame;
+    int64_t submit_ns;
+} Readback;
+
+typedef struct {
+    FILE *results;
+    GLuint content_fbo;       // Source texture as a render target, for painting markers
+    uint32_t painted_content; // Content frame currently in the source texture
+    uint32_t frame;           // Presented frame counter
+    Readback readbacks[READBACK_DEPTH];
+} HeadlessState;
+
+static int64_t headless_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int headless_init(RenderThread *thread, const char *results_path) {
+    HeadlessState *state = calloc(1, sizeof(*state));
+    if (!state) {
+        return -1;
+    }
+
+    state->results = fopen(results_path, "w");
+    if (!state->results) {
+        log_error("[Headless] Failed to open %s: %s\n", results_path, strerror(errno));
+        free(state);
+        return -1;
+    }
+    thread->headless_state = state;
+
+    // The source texture stands in for the imported DMA-BUF
+    uint32_t width = thread->current_width;
+    uint32_t height = thread->current_height;
+    glGenTextures(1, &thread->frame_texture);
+    glBindTexture(GL_TEXTURE_2D, thread->frame_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, (GLsizei)width, (GLsizei)height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &state->content_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, state->content_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, thread->frame_texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, thread->headless_fbo);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        log_error("[Headless] Source texture framebuffer incomplete\n");
+        headless_cleanup(thread);
+        return -1;
+    }
+
+    for (int i = 0; i < READBACK_DEPTH; i++) {
+        glGenBuffers(1, &state->readbacks[i].pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, state->readbacks[i].pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)thread->output_width * 4, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    fprintf(state->results, "# breezy headless latency %ux%u source, %ux%u output\n",
+            width, height, thread->output_width, thread->output_height);
+    fflush(state->results);
+    log_info("[Headless] Writing latency results to %s\n", results_path);
+    return 0;
+}
+
+void headless_cleanup(RenderThread *thread) {
+    HeadlessState *state = thread->headless_state;
+    if (!state) {
+        return;
+    }
+
+    for (int i = 0; i < READBACK_DEPTH; i++) {
+        if (state->readbacks[i].fence) {
+            glDeleteSync(state->readbacks[i].fence);
+        }
+        if (state->readbacks[i].pbo) {
+            glDeleteBuffers(1, &state->readbacks[i].pbo);
+        }
+    }
+    if (state->content_fbo) {
+        glDeleteFramebuffers(1, &state->content_fbo);
+    }
+    if (state->results) {
+        fclose(state->results);
+    }
+    free(state);
+    thread->headless_state = NULL;
+}
+
+void headless_record_content(RenderThread *thread, uint32_t content_frame, int64_t produced_ns) {
+    HeadlessState *state = thread->headless_state;
+    if (state) {
+        fprintf(state->results, "content %u %lld\n", content_frame, (long long)produced_ns);
+    }
+}
+
+void headless_paint_content(RenderThread *thread, uint32_t content_frame) {
+    HeadlessState *state = thread->headless_state;
+    if (!state || content_frame == state->painted_content) {
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, state->content_fbo);
+    glViewport(0, 0, (GLsizei)thread->current_width, (GLsizei)thread->current_height);
+    glClearColor((float)(content_frame & 0xff) / 255.0f, (float)((content_frame >> 8) & 0xff) / 255.0f,
+                 (float)MARKER_BLUE / 255.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glBindFramebuffer(GL_FRAMEBUFFER, thread->headless_fbo);
+    glViewport(0, 0, (GLsizei)thread->output_width, (GLsizei)thread->output_height);
+    state->painted_content = content_frame;
+}
+
+// Write the result of a readback whose fence has signaled
+static void collect_readback(RenderThread *thread, HeadlessState *state, Readback *readback, int64_t complete_ns) {
+    glDeleteSync(readback->fence);
+    readback->fence = NULL;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    const uint8_t *row = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)thread->output_width * 4, GL_MAP_READ_BIT);
+    if (row) {
+        int edge_x = -1;
+        for (uint32_t x = 0; x < thread->output_width; x++) {
+            if (row[x * 4 + 2] >= MARKER_THRESHOLD) {
+                edge_x = (int)x;
+                break;
+            }
+        }
+        const uint8_t *center = row + (thread->output_width / 2) * 4;
+        uint32_t content = center[2] >= MARKER_THRESHOLD ? (uint32_t)center[0] | ((uint32_t)center[1] << 8) : 0;
+        fprintf(state->results, "present %u %lld %lld %d %u\n", readback->frame,
+                (long long)readback->submit_ns, (long long)complete_ns, edge_x, content);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void headless_present(RenderThread *thread) {
+    HeadlessState *state = thread->headless_state;
+    if (!state) {
+        return;
+    }
+
+    // Collect finished readbacks, oldest first; the slot being reused must finish now
+    Readback *slot = &state->readbacks[state->frame % READBACK_DEPTH];
+    for (uint32_t i = 1; i <= READBACK_DEPTH; i++) {
+        Readback *readback = &state->readbacks[(state->frame + i) % READBACK_DEPTH];
+        if (!readback->fence) {
+            continue;
+        }
+        GLuint64 timeout = readback == slot ? GL_TIMEOUT_IGNORED : 0;
+        GLenum status = glClientWaitSync(readback->fence, 0, timeout);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            collect_readback(thread, state, readback, headless_now_ns());
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    glReadPixels(0, (GLint)(thread->output_height / 2), (GLsizei)thread->output_width, 1,
+                 GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->frame = state->frame++;
+    slot->submit_ns = headless_now_ns();
+    glFlush();
+}
@@ -0,0 +1,383 @@
+/*
+ * Performance HUD
+ *
+ * An overlay drawn at the end of render_frame, for diagnosing stutter while wearing the
+ * glasses: fps, recent frame intervals (average and a bar graph), pose age at render,
+ * capture age of the frame on screen and the number of dropped frames. It's off by
+ * default; BREEZY_RENDERER_HUD=1 starts with it shown and SIGUSR1 toggles it.
+ *
+ * Text comes from a 5x7 bitmap font compiled in below and uploaded once as a one-row
+ * atlas. Every glyph, the panel behind them and the graph bars is one instance of a unit
+ * quad (pixel rect, glyph index, color), so the whole HUD is a single instanced draw
+ * from a buffer refreshed with glBufferSubData. Nothing is allocated per frame.
+ *
+ * Frame intervals are swap-to-swap, recorded whether or not the HUD is shown; one longer
+ * than 1.5 render periods counts as dropped. Idle-rate frames aren't counted.
+ */
+
+#define _GNU_SOURCE
+#include "breezy_x11_renderer.h"
+#include "logging.h"
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HUD_GRAPH_FRAMES 90
+#define HUD_MAX_INSTANCES 256
+#define HUD_GLYPH_WIDTH 5
+#define HUD_GLYPH_HEIGHT 7
+#define HUD_SOLID_GLYPH '#'
+
+// Glyph order in the atlas; '#' is a solid cell for panels and bars
+static const char HUD_GLYPHS[] = " .0123456789ACDEFIMOPRSU#";
+#define HUD_GLYPH_COUNT ((int)sizeof(HUD_GLYPHS) - 1)
+
+// Rows top to bottom, bit 4 is the leftmost column
+static const uint8_t HUD_FONT[HUD_GLYPH_COUNT][HUD_GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c },  // '.'
+    { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e },  // '0'
+    { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e },  // '1'
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f },  // '2'
+    { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e },  // '3'
+    { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 },  // '4'
+    { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e },  // '5'
+    { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e },  // '6'
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },  // '7'
+    { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e },  // '8'
+    { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c },  // '9'
+    { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 },  // 'A'
+    { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e },  // 'C'
+    { 0x1e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1e },  // 'D'
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f },  // 'E'
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 },  // 'F'
+    { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e },  // 'I'
+    { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11 },  // 'M'
+    { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e },  // 'O'
+    { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 },  // 'P'
+    { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11 },  // 'R'
+    { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e },  // 'S'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e },  // 'U'
+    { 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f },  // '#'
+};
+
+static const char *HUD_VERTEX_SHADER =
+    "#version 330 core\n"
+    "layout(location = 0) in vec2 aCorner;\n"  // unit quad, origin top-left
+    "layout(location = 1) in vec4 aRect;\n"    // x, y, width, height in pixels from the top-left
+    "layout(location = 2) in float aGlyph;\n"
+    "layout(location = 3) in vec4 aColor;\n"
+    "uniform vec2 viewport;\n"
+    "uniform float glyphCount;\n"
+    "out vec2 uv;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "    vec2 pos = aRect.xy + aCorner * aRect.zw;\n"
+    "    gl_Position = vec4(pos.x / viewport.x * 2.0 - 1.0, 1.0 - pos.y / viewport.y * 2.0, 0.0, 1.0);\n"
+    "    uv = vec2((aGlyph + aCorner.x) / glyphCount, aCorner.y);\n"
+    "    color = aColor;\n"
+    "}\n";
+
+static const char *HUD_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "in vec2 uv;\n"
+    "in vec4 color;\n"
+    "uniform sampler2D atlas;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    float coverage = texture(atlas, uv).r;\n"
+    "    if (coverage < 0.5) discard;\n"
+    "    fragColor = color;\n"
+    "}\n";
+
+typedef struct {
+    float x, y, width, height;
+    float glyph;
+    float color[4];
+} HudInstance;
+
+typedef struct {
+    GLuint program;
+    GLuint atlas;
+    GLuint vao;
+    GLuint quad_vbo;
+    GLuint instance_vbo;
+    GLint viewport_loc;
+    int8_t glyph_index[128];  // ASCII to atlas index, -1 if the font has no glyph
+
+    HudInstance instances[HUD_MAX_INSTANCES];
+    int instance_count;
+
+    // Frame statistics, recorded on the render thread
+    float intervals_ms[HUD_GRAPH_FRAMES];
+    uint32_t interval_count;  // Total recorded, the ring index is interval_count % HUD_GRAPH_FRAMES
+    int64_t last_swap_ns;
+    float period_ms;
+    uint32_t dropped_frames;
+} HudState;
+
+static const float HUD_TEXT_COLOR[4] = { 0.95f, 0.95f, 0.95f, 1.0f };
+static const float HUD_PANEL_COLOR[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+static const float HUD_GOOD_COLOR[4] = { 0.3f, 0.9f, 0.4f, 1.0f };
+static const float HUD_LATE_COLOR[4] = { 0.95f, 0.8f, 0.2f, 1.0f };
+static const float HUD_DROPPED_COLOR[4] = { 0.95f, 0.25f, 0.2f, 1.0f };
+
+static GLuint compile_hud_shader(GLenum type, const char *source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char info_log[512];
+        glGetShaderInfoLog(shader, sizeof(info_log), NULL, info_log);
+        log_error("[HUD] Shader compile error: %s\n", info_log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint link_hud_program(void) {
+    GLuint vertex_shader = compile_hud_shader(GL_VERTEX_SHADER, HUD_VERTEX_SHADER);
+    GLuint fragment_shader = compile_hud_shader(GL_FRAGMENT_SHADER, HUD_FRAGMENT_SHADER);
+    GLuint program = 0;
+    if (vertex_shader && fragment_shader) {
+        program = glCreateProgram();
+        glAttachShader(program, vertex_shader);
+        glAttachShader(program, fragment_shader);
+        glLinkProgram(program);
+
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char info_log[512];
+            glGetProgramInfoLog(program, sizeof(info_log), NULL, info_log);
+            log_error("[HUD] Shader link error: %s\n", info_log);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    // The program keeps them alive while linked
+    if (vertex_shader) {
+        glDeleteShader(vertex_shader);
+    }
+    if (fragment_shader) {
+        glDeleteShader(fragment_shader);
+    }
+    return program;
+}
+
+static void upload_font_atlas(HudState *state) {
+    uint8_t pixels[HUD_GLYPH_HEIGHT][HUD_GLYPH_COUNT * HUD_GLYPH_WIDTH];
+    for (int glyph = 0; glyph < HUD_GLYPH_COUNT; glyph++) {
+        for (int row = 0; row < HUD_GLYPH_HEIGHT; row++) {
+            for (int column = 0; column < HUD_GLYPH_WIDTH; column++) {
+                bool set = HUD_FONT[glyph][row] & (1 << (HUD_GLYPH_WIDTH - 1 - column));
+                pixels[row][glyph * HUD_GLYPH_WIDTH + column] = set ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &state->atlas);
+    glBindTexture(GL_TEXTURE_2D, state->atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, HUD_GLYPH_COUNT * HUD_GLYPH_WIDTH, HUD_GLYPH_HEIGHT, 0,
+                 GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    memset(state->glyph_index, -1, sizeof(state->glyph_index));
+    for (int glyph = 0; glyph < HUD_GLYPH_COUNT; glyph++) {
+        state->glyph_index[(unsigned char)HUD_GLYPHS[glyph]] = (int8_t)glyph;
+    }
+}
+
+static void create_instance_buffers(HudState *state) {
+    static const float corners[] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+
+    glGenVertexArrays(1, &state->vao);
+    glGenBuffers(1, &state->quad_vbo);
+    glGenBuffers(1, &state->instance_vbo);
+    glBindVertexArray(state->vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, state->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, state->instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(state->instances), NULL, GL_STREAM_DRAW);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(HudInstance), (void *)offsetof(HudInstance, x));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(HudInstance), (void *)offsetof(HudInstance, glyph));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(HudInstance), (void *)offsetof(HudInstance, color));
+    for (GLuint attribute = 1; attribute <= 3; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int hud_init(RenderThread *thread, bool enabled) {
+    HudState *state = calloc(1, sizeof(*state));
+    if (!state) {
+        return -1;
+    }
+
+    state->program = link_hud_program();
+    if (!state->program) {
+        free(state);
+        return -1;
+    }
+    upload_font_atlas(state);
+    create_instance_buffers(state);
+
+    glUseProgram(state->program);
+    state->viewport_loc = glGetUniformLocation(state->program, "viewport");
+    glUniform1f(glGetUniformLocation(state->program, "glyphCount"), (float)HUD_GLYPH_COUNT);
+    glUniform1i(glGetUniformLocation(state->program, "atlas"), 0);
+    glUseProgram(0);
+
+    thread->hud_state = state;
+    thread->hud_enabled = enabled;
+    if (enabled) {
+        log_info("[HUD] Performance HUD shown (SIGUSR1 toggles it)\n");
+    }
+    return 0;
+}
+
+void hud_cleanup(RenderThread *thread) {
+    HudState *state = thread->hud_state;
+    if (!state) {
+        return;
+    }
+
+    glDeleteProgram(state->program);
+    glDeleteTextures(1, &state->atlas);
+    glDeleteVertexArrays(1, &state->vao);
+    glDeleteBuffers(1, &state->quad_vbo);
+    glDeleteBuffers(1, &state->instance_vbo);
+    free(state);
+    thread->hud_state = NULL;
+}
+
+void hud_record_frame(RenderThread *thread, int64_t swap_ns, int64_t period_ns) {
+    HudState *state = thread->hud_state;
+    if (!state) {
+        return;
+    }
+
+    if (swap_ns && state->last_swap_ns) {
+        float interval_ms = (float)(swap_ns - state->last_swap_ns) / 1e6f;
+        state->intervals_ms[state->interval_count % HUD_GRAPH_FRAMES] = interval_ms;
+        state->interval_count++;
+        state->period_ms = (float)period_ns / 1e6f;
+        if (interval_ms > state->period_ms * 1.5f) {
+            state->dropped_frames++;
+        }
+    }
+    state->last_swap_ns = swap_ns;
+}
+
+static void add_rect(HudState *state, float x, float y, float width, float height, char glyph, const float color[4]) {
+    if (state->instance_count == HUD_MAX_INSTANCES) {
+        return;
+    }
+    HudInstance *instance = &state->instances[state->instance_count++];
+    instance->x = x;
+    instance->y = y;
+    instance->width = width;
+    instance->height = height;
+    instance->glyph = (float)state->glyph_index[(unsigned char)glyph];
+    memcpy(instance->color, color, sizeof(instance->color));
+}
+
+static void add_text(HudState *state, float x, float y, float scale, const char *text) {
+    for (; *text; text++, x += (HUD_GLYPH_WIDTH + 1) * scale) {
+        unsigned char c = (unsigned char)*text;
+        if (c == ' ' || c >= sizeof(state->glyph_index) || state->glyph_index[c] < 0) {
+            continue;
+        }
+        add_rect(state, x, y, HUD_GLYPH_WIDTH * scale, HUD_GLYPH_HEIGHT * scale, (char)c, HUD_TEXT_COLOR);
+    }
+}
+
+void hud_draw(RenderThread *thread, float capture_age_ms) {
+    HudState *state = thread->hud_state;
+    if (!state || !thread->hud_enabled) {
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    float scale = viewport[3] >= 720 ? (float)(viewport[3] / 360) : 1.0f;
+    float line_height = (HUD_GLYPH_HEIGHT + 3) * scale;
+    float bar_width = 2.0f * scale;
+    float graph_height = 24.0f * scale;
+    float margin = 4.0f * scale;
+
+    // Inside the central part of the view, where it stays visible in the glasses
+    float x = (float)viewport[2] * 0.1f;
+    float y = (float)viewport[3] * 0.1f;
+
+    uint32_t samples = state->interval_count < HUD_GRAPH_FRAMES ? state->interval_count : HUD_GRAPH_FRAMES;
+    float interval_sum = 0.0f;
+    for (uint32_t i = 0; i < samples; i++) {
+        interval_sum += state->intervals_ms[i];
+    }
+    float average_ms = samples ? interval_sum / (float)samples : 0.0f;
+
+    char lines[5][32];
+    snprintf(lines[0], sizeof(lines[0]), "FPS %.1f", average_ms > 0.0f ? 1000.0f / average_ms : 0.0f);
+    snprintf(lines[1], sizeof(lines[1]), "FRAME %.1f MS", average_ms);
+    snprintf(lines[2], sizeof(lines[2]), "IMU %.1f MS", thread->last_pose_age_ms);
+    snprintf(lines[3], sizeof(lines[3]), "CAP %.1f MS", capture_age_ms);
+    snprintf(lines[4], sizeof(lines[4]), "DROP %u", state->dropped_frames);
+
+    state->instance_count = 0;
+    float panel_width = HUD_GRAPH_FRAMES * bar_width + 2.0f * margin;
+    float panel_height = 5 * line_height + graph_height + 3.0f * margin;
+    add_rect(state, x, y, panel_width, panel_height, HUD_SOLID_GLYPH, HUD_PANEL_COLOR);
+    for (int i = 0; i < 5; i++) {
+        add_text(state, x + margin, y + margin + (float)i * line_height, scale, lines[i]);
+    }
+
+    // Oldest interval on the left; full height is two render periods, the marker one period
+    float graph_x = x + margin;
+    float graph_bottom = y + panel_height - margin;
+    float full_scale_ms = state->period_ms > 0.0f ? 2.0f * state->period_ms : 33.4f;
+    for (uint32_t i = 0; i < samples; i++) {
+        float interval_ms = state->intervals_ms[(state->interval_count - samples + i) % HUD_GRAPH_FRAMES];
+        float height = interval_ms / full_scale_ms * graph_height;
+        height = height < scale ? scale : height > graph_height ? graph_height : height;
+        const float *color = interval_ms > state->period_ms * 1.5f ? HUD_DROPPED_COLOR :
+                             interval_ms > state->period_ms * 1.1f ? HUD_LATE_COLOR : HUD_GOOD_COLOR;
+        add_rect(state, graph_x + (float)i * bar_width, graph_bottom - height, bar_width * 0.5f, height,
+                 HUD_SOLID_GLYPH, color);
+    }
+    add_rect(state, graph_x, graph_bottom - graph_height / 2.0f, HUD_GRAPH_FRAMES * bar_width, scale,
+             HUD_SOLID_GLYPH, HUD_TEXT_COLOR);
+
+    glUseProgram(state->program);
+    glUniform2f(state->viewport_loc, (float)viewport[2], (float)viewport[3]);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, state->atlas);
+    glBindVertexArray(state->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, state->instance_vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(state->instance_count * sizeof(HudInstance)), state->instances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, state->instance_count);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
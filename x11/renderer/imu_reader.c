@@ -2,44 +2,107 @@
  * IMU data reader from shared memory
  * 
  * Reads IMU data from /dev/shm/breezy_desktop_imu
- * Format matches XRLinuxDriver's shared memory layout
+ * Format matches XRLinuxDriver's shared memory layout (versions 5 and 6,
+ * see shared/ipc/breezy_shm_layout.h)
  */
 
+#define _GNU_SOURCE
 #include "breezy_x11_renderer.h"
 #include "logging.h"
+#include "breezy_shm_layout.h"
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
-#define IMU_SHM_PATH "/dev/shm/breezy_desktop_imu"
-#define DATA_LAYOUT_VERSION 5
-
-// Data layout offsets (matches devicedatastream.js)
-#define OFFSET_VERSION 0
-#define OFFSET_ENABLED 1
-#define OFFSET_LOOK_AHEAD_CFG 2
-#define OFFSET_DISPLAY_RES 18
-#define OFFSET_DISPLAY_FOV 26
-#define OFFSET_LENS_DISTANCE_RATIO 30
-#define OFFSET_SBS_ENABLED 34
-#define OFFSET_CUSTOM_BANNER_ENABLED 35
-#define OFFSET_SMOOTH_FOLLOW_ENABLED 36
-#define OFFSET_SMOOTH_FOLLOW_ORIGIN_DATA 37
-#define OFFSET_POSE_POSITION 101
-#define OFFSET_EPOCH_MS 113
-#define OFFSET_POSE_ORIENTATION 121
-#define OFFSET_IMU_PARITY_BYTE 185
-
-static uint8_t calculate_parity(const uint8_t *data) {
-    uint8_t parity = 0;
-    // XOR all bytes in epoch and pose_orientation
-    for (int i = OFFSET_EPOCH_MS; i < OFFSET_IMU_PARITY_BYTE; i++) {
-        parity ^= data[i];
-    }
-    return parity;
+// Attempts at a consistent seqlock snapshot before giving up for this frame
+#define SEQLOCK_READ_ATTEMPTS 4
+
+// Layout version of the mapped segment, 0 if unknown or too short for its layout
+static uint8_t shm_layout_version(const IMUReader *reader) {
+    const uint8_t *data = (const uint8_t *)reader->shm_ptr;
+    uint8_t version = data[BREEZY_SHM_V6_OFFSET_VERSION];
+    if (version == BREEZY_SHM_V6_VERSION && reader->shm_size >= BREEZY_SHM_V6_LENGTH) {
+        return version;
+    }
+    if (version == BREEZY_SHM_V5_VERSION && reader->shm_size >= BREEZY_SHM_V5_LENGTH) {
+        return version;
+    }
+    return 0;
+}
+
+// Copy a v6 block [start, end) guarded by the seqlock counter at its first word and
+// verified by the checksum at its second word. Returns true if the copy is consistent.
+static bool read_v6_block(const uint8_t *data, size_t start, size_t end, uint8_t *out) {
+    const uint32_t *sequence_ptr = (const uint32_t *)(data + start);
+    for (int attempt = 0; attempt < SEQLOCK_READ_ATTEMPTS; attempt++) {
+        uint32_t before = __atomic_load_n(sequence_ptr, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;  // Writer mid-update
+        }
+
+        memcpy(out, data + start, end - start);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(sequence_ptr, __ATOMIC_RELAXED) != before) {
+            continue;
+        }
+
+        uint32_t checksum;
+        memcpy(&checksum, out + 4, sizeof(checksum));
+        if (breezy_shm_checksum(out, 8, end - start) == checksum) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The driver's file, or a test harness's via BREEZY_IMU_SHM_PATH (tests/latency_harness.c)
+const char *imu_shm_path(void) {
+    const char *path = getenv(IMU_SHM_PATH_ENV);
+    return path && path[0] ? path : IMU_SHM_PATH;
+}
+
+// Open and map the current imu_shm_path(). The fd is only kept for the inode identity.
+static int map_shm_file(int *fd_out, void **ptr_out, size_t *size_out, struct stat *st) {
+    int fd = open(imu_shm_path(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (fstat(fd, st) < 0 || st->st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+
+    void *ptr = mmap(NULL, (size_t)st->st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    *fd_out = fd;
+    *ptr_out = ptr;
+    *size_out = (size_t)st->st_size;
+    return 0;
+}
+
+static void log_layout_version(const IMUReader *reader) {
+    uint8_t version = shm_layout_version(reader);
+    if (version == 0) {
+        log_warn("[IMU] Unsupported layout: version %d, %zu bytes (expected version %d or %d)\n",
+                 ((uint8_t *)reader->shm_ptr)[BREEZY_SHM_V6_OFFSET_VERSION], reader->shm_size,
+                 BREEZY_SHM_V5_VERSION, BREEZY_SHM_V6_VERSION);
+        // Continue anyway - the driver may rewrite it
+    } else {
+        log_info("[IMU] Shared memory layout version %d\n", version);
+    }
 }
 
 int init_imu_reader(IMUReader *reader) {
@@ -52,39 +115,18 @@ int init_imu_reader(IMUReader *reader) {
         return -1;
     }
     
-    // Open shared memory file
-    reader->shm_fd = open(IMU_SHM_PATH, O_RDONLY);
-    if (reader->shm_fd < 0) {
-        log_error("[IMU] Failed to open %s: %s\n", IMU_SHM_PATH, strerror(errno));
-        return -1;
-    }
-    
-    // Get file size
+    // Open and map shared memory file
     struct stat st;
-    if (fstat(reader->shm_fd, &st) < 0) {
-        log_error("[IMU] Failed to stat %s: %s\n", IMU_SHM_PATH, strerror(errno));
-        close(reader->shm_fd);
-        reader->shm_fd = -1;
-        return -1;
-    }
-    reader->shm_size = st.st_size;
-    
-    // Map shared memory
-    reader->shm_ptr = mmap(NULL, reader->shm_size, PROT_READ, MAP_SHARED, reader->shm_fd, 0);
-    if (reader->shm_ptr == MAP_FAILED) {
-        log_error("[IMU] Failed to mmap %s: %s\n", IMU_SHM_PATH, strerror(errno));
-        close(reader->shm_fd);
+    if (map_shm_file(&reader->shm_fd, &reader->shm_ptr, &reader->shm_size, &st) != 0) {
+        log_error("[IMU] Failed to map %s: %s\n", imu_shm_path(), strerror(errno));
         reader->shm_fd = -1;
+        reader->shm_ptr = NULL;
         return -1;
     }
+    reader->shm_dev = (uint64_t)st.st_dev;
+    reader->shm_ino = (uint64_t)st.st_ino;
     
-    // Check version
-    uint8_t version = ((uint8_t *)reader->shm_ptr)[OFFSET_VERSION];
-    if (version != DATA_LAYOUT_VERSION) {
-        log_warn("[IMU] Version mismatch: expected %d, got %d\n", DATA_LAYOUT_VERSION, version);
-        // Continue anyway - might work
-    }
-    
+    log_layout_version(reader);
     log_info("[IMU] Reader initialized, mapped %zu bytes\n", reader->shm_size);
     return 0;
 }
@@ -99,6 +141,118 @@ void cleanup_imu_reader(IMUReader *reader) {
     pthread_mutex_destroy(&reader->lock);
 }
 
+int imu_reader_check_reattach(IMUReader *reader) {
+    // Cheap identity check by path; only remap when the driver replaced or resized the file
+    struct stat path_st;
+    if (stat(imu_shm_path(), &path_st) != 0) {
+        return -1;
+    }
+    if ((uint64_t)path_st.st_dev == reader->shm_dev && (uint64_t)path_st.st_ino == reader->shm_ino &&
+        (size_t)path_st.st_size == reader->shm_size && reader->shm_ptr) {
+        return 0;
+    }
+
+    // Map the new file before touching the reader so pose reads keep using the old mapping meanwhile
+    int new_fd;
+    void *new_ptr;
+    size_t new_size;
+    struct stat st;
+    if (map_shm_file(&new_fd, &new_ptr, &new_size, &st) != 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&reader->lock);
+    int old_fd = reader->shm_fd;
+    void *old_ptr = reader->shm_ptr;
+    size_t old_size = reader->shm_size;
+    uint64_t old_ino = reader->shm_ino;
+    reader->shm_fd = new_fd;
+    reader->shm_ptr = new_ptr;
+    reader->shm_size = new_size;
+    reader->shm_dev = (uint64_t)st.st_dev;
+    reader->shm_ino = (uint64_t)st.st_ino;
+    reader->retired_doorbell_waiters = reader->doorbell_waiters;
+    reader->doorbell_waiters = 0;
+    pthread_mutex_unlock(&reader->lock);
+
+    if (old_ptr) {
+        // Doorbell waiters may be parked on the old word. Keep waking it until they have all
+        // left - one can still enter FUTEX_WAIT just after a wake - so none sleeps on it to its
+        // deadline, and only then unmap it.
+        uint32_t *old_doorbell = (uint32_t *)((uint8_t *)old_ptr + BREEZY_SHM_V6_OFFSET_POSE_DOORBELL);
+        while (old_size >= BREEZY_SHM_V6_LENGTH) {
+            pthread_mutex_lock(&reader->lock);
+            uint32_t parked = reader->retired_doorbell_waiters;
+            pthread_mutex_unlock(&reader->lock);
+            if (!parked) {
+                break;
+            }
+            syscall(SYS_futex, old_doorbell, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+            struct timespec retry = { .tv_sec = 0, .tv_nsec = 100000 };  // 100us
+            nanosleep(&retry, NULL);
+        }
+        munmap(old_ptr, old_size);
+    }
+    if (old_fd >= 0) {
+        close(old_fd);
+    }
+
+    log_info("[IMU] %s replaced by the driver, re-attached (inode %llu -> %llu, %zu bytes)\n",
+             imu_shm_path(), (unsigned long long)old_ino, (unsigned long long)reader->shm_ino, new_size);
+    log_layout_version(reader);
+    return 1;
+}
+
+// Version 5: packed fields, XOR parity over epoch + orientation
+static bool read_imu_v5(const uint8_t *data, IMUData *result) {
+    if (breezy_shm_v5_parity(data) != data[BREEZY_SHM_V5_OFFSET_PARITY]) {
+        // Parity mismatch - data might be corrupted or in transition
+        return false;
+    }
+
+    // Read pose position (3 floats)
+    memcpy(result->position, &data[BREEZY_SHM_V5_OFFSET_POSE_POSITION], sizeof(float) * 3);
+
+    // Read epoch (2 uints, milliseconds)
+    uint32_t epoch_low, epoch_high;
+    memcpy(&epoch_low, &data[BREEZY_SHM_V5_OFFSET_EPOCH_MS], sizeof(uint32_t));
+    memcpy(&epoch_high, &data[BREEZY_SHM_V5_OFFSET_EPOCH_MS + 4], sizeof(uint32_t));
+    result->timestamp_ms = ((uint64_t)epoch_high << 32) | epoch_low;
+
+    // Read pose orientation (16 floats = 4x4 matrix)
+    // Row 0-2: quaternions at t0, t1, t2 (each 4 floats: x, y, z, w)
+    // Row 3: timestamps (4 floats: timestamp_t0, timestamp_t1, timestamp_t2, unused)
+    memcpy(result->pose_orientation, &data[BREEZY_SHM_V5_OFFSET_POSE_ORIENTATION], sizeof(float) * 16);
+    return true;
+}
+
+// Version 6: aligned pose block guarded by a sequence counter and checksum
+static bool read_imu_v6(const uint8_t *data, IMUData *result) {
+    uint8_t block[BREEZY_SHM_V6_POSE_BLOCK_END - BREEZY_SHM_V6_POSE_BLOCK];
+    if (!read_v6_block(data, BREEZY_SHM_V6_POSE_BLOCK, BREEZY_SHM_V6_POSE_BLOCK_END, block)) {
+        return false;
+    }
+
+    const uint8_t *pose = block - BREEZY_SHM_V6_POSE_BLOCK;  // Index the copy by absolute offsets
+    memcpy(&result->timestamp_ms, pose + BREEZY_SHM_V6_OFFSET_EPOCH_MS, sizeof(uint64_t));
+    memcpy(result->position, pose + BREEZY_SHM_V6_OFFSET_POSE_POSITION, sizeof(float) * 3);
+    memcpy(result->pose_orientation, pose + BREEZY_SHM_V6_OFFSET_POSE_ORIENTATION, sizeof(float) * 16);
+
+    if (data[BREEZY_SHM_V6_OFFSET_FLAGS] & BREEZY_SHM_V6_FLAG_MONOTONIC_TIME) {
+        uint64_t sample_time_ns[3];
+        memcpy(sample_time_ns, pose + BREEZY_SHM_V6_OFFSET_SAMPLE_TIME_NS, sizeof(sample_time_ns));
+        if (sample_time_ns[0] >= sample_time_ns[1] && sample_time_ns[1] >= sample_time_ns[2] && sample_time_ns[2] != 0) {
+            result->sample_time_ns = sample_time_ns[0];
+
+            // Row 3 only feeds sample deltas; rebase it on t2 so float ms keeps sub-ms precision
+            for (int i = 0; i < 3; i++) {
+                result->pose_orientation[12 + i] = (float)((double)(sample_time_ns[i] - sample_time_ns[2]) / 1e6);
+            }
+        }
+    }
+    return true;
+}
+
 IMUData read_latest_imu(IMUReader *reader) {
     IMUData result = {0};
     result.valid = false;
@@ -111,41 +265,22 @@ IMUData read_latest_imu(IMUReader *reader) {
     
     const uint8_t *data = (const uint8_t *)reader->shm_ptr;
     
-    // Check if enabled
-    bool enabled = data[OFFSET_ENABLED] != 0;
-    if (!enabled) {
-        pthread_mutex_unlock(&reader->lock);
-        return result;
+    // Check if enabled (same offset in every layout version)
+    bool enabled = data[BREEZY_SHM_V6_OFFSET_ENABLED] != 0;
+    uint8_t version = shm_layout_version(reader);
+    bool read_ok = false;
+    if (enabled && version == BREEZY_SHM_V6_VERSION) {
+        read_ok = read_imu_v6(data, &result);
+    } else if (enabled && version == BREEZY_SHM_V5_VERSION) {
+        read_ok = read_imu_v5(data, &result);
     }
     
-    // Verify parity
-    uint8_t expected_parity = calculate_parity(data);
-    uint8_t actual_parity = data[OFFSET_IMU_PARITY_BYTE];
-    if (expected_parity != actual_parity) {
-        // Parity mismatch - data might be corrupted or in transition
-        pthread_mutex_unlock(&reader->lock);
-        return result;
+    if (read_ok) {
+        result.valid = true;
+        // Update latest
+        reader->latest = result;
     }
     
-    // Read pose position (3 floats)
-    memcpy(result.position, &data[OFFSET_POSE_POSITION], sizeof(float) * 3);
-    
-    // Read epoch (2 uints, milliseconds)
-    uint32_t epoch_low, epoch_high;
-    memcpy(&epoch_low, &data[OFFSET_EPOCH_MS], sizeof(uint32_t));
-    memcpy(&epoch_high, &data[OFFSET_EPOCH_MS + 4], sizeof(uint32_t));
-    result.timestamp_ms = ((uint64_t)epoch_high << 32) | epoch_low;
-    
-    // Read pose orientation (16 floats = 4x4 matrix)
-    // Row 0-2: quaternions at t0, t1, t2 (each 4 floats: x, y, z, w)
-    // Row 3: timestamps (4 floats: timestamp_t0, timestamp_t1, timestamp_t2, unused)
-    memcpy(result.pose_orientation, &data[OFFSET_POSE_ORIENTATION], sizeof(float) * 16);
-    
-    result.valid = true;
-    
-    // Update latest
-    reader->latest = result;
-    
     pthread_mutex_unlock(&reader->lock);
     return result;
 }
@@ -164,43 +299,68 @@ DeviceConfig read_device_config(IMUReader *reader) {
     const uint8_t *data = (const uint8_t *)reader->shm_ptr;
     
     // Check if enabled
-    bool enabled = data[OFFSET_ENABLED] != 0;
-    if (!enabled) {
+    bool enabled = data[BREEZY_SHM_V6_OFFSET_ENABLED] != 0;
+    uint8_t version = shm_layout_version(reader);
+    if (!enabled || version == 0) {
+        pthread_mutex_unlock(&reader->lock);
+        return config;
+    }
+    
+    if (version == BREEZY_SHM_V6_VERSION) {
+        uint8_t pose_block[BREEZY_SHM_V6_POSE_BLOCK_END - BREEZY_SHM_V6_POSE_BLOCK];
+        uint8_t config_block[BREEZY_SHM_V6_CONFIG_BLOCK_END - BREEZY_SHM_V6_CONFIG_BLOCK];
+        if (!read_v6_block(data, BREEZY_SHM_V6_CONFIG_BLOCK, BREEZY_SHM_V6_CONFIG_BLOCK_END, config_block) ||
+            !read_v6_block(data, BREEZY_SHM_V6_POSE_BLOCK, BREEZY_SHM_V6_POSE_BLOCK_END, pose_block)) {
+            pthread_mutex_unlock(&reader->lock);
+            return config;
+        }
+        
+        // Index the copies by absolute offsets
+        const uint8_t *cfg = config_block - BREEZY_SHM_V6_CONFIG_BLOCK;
+        const uint8_t *pose = pose_block - BREEZY_SHM_V6_POSE_BLOCK;
+        memcpy(config.look_ahead_cfg, cfg + BREEZY_SHM_V6_OFFSET_LOOK_AHEAD_CFG, sizeof(float) * 4);
+        memcpy(config.display_resolution, cfg + BREEZY_SHM_V6_OFFSET_DISPLAY_RES, sizeof(uint32_t) * 2);
+        memcpy(&config.display_fov, cfg + BREEZY_SHM_V6_OFFSET_DISPLAY_FOV, sizeof(float));
+        memcpy(&config.lens_distance_ratio, cfg + BREEZY_SHM_V6_OFFSET_LENS_DISTANCE_RATIO, sizeof(float));
+        config.sbs_enabled = cfg[BREEZY_SHM_V6_OFFSET_SBS_ENABLED] != 0;
+        config.custom_banner_enabled = cfg[BREEZY_SHM_V6_OFFSET_CUSTOM_BANNER_ENABLED] != 0;
+        config.smooth_follow_enabled = pose[BREEZY_SHM_V6_OFFSET_SMOOTH_FOLLOW_ENABLED] != 0;
+        memcpy(config.smooth_follow_origin, pose + BREEZY_SHM_V6_OFFSET_SMOOTH_FOLLOW_ORIGIN, sizeof(float) * 16);
+        
+        config.valid = true;
         pthread_mutex_unlock(&reader->lock);
         return config;
     }
     
     // Verify parity
-    uint8_t expected_parity = calculate_parity(data);
-    uint8_t actual_parity = data[OFFSET_IMU_PARITY_BYTE];
-    if (expected_parity != actual_parity) {
+    if (breezy_shm_v5_parity(data) != data[BREEZY_SHM_V5_OFFSET_PARITY]) {
         pthread_mutex_unlock(&reader->lock);
         return config;
     }
     
     // Read look ahead config (4 floats)
-    memcpy(config.look_ahead_cfg, &data[OFFSET_LOOK_AHEAD_CFG], sizeof(float) * 4);
+    memcpy(config.look_ahead_cfg, &data[BREEZY_SHM_V5_OFFSET_LOOK_AHEAD_CFG], sizeof(float) * 4);
     
     // Read display resolution (2 uints)
-    memcpy(config.display_resolution, &data[OFFSET_DISPLAY_RES], sizeof(uint32_t) * 2);
+    memcpy(config.display_resolution, &data[BREEZY_SHM_V5_OFFSET_DISPLAY_RES], sizeof(uint32_t) * 2);
     
     // Read display FOV (1 float)
-    memcpy(&config.display_fov, &data[OFFSET_DISPLAY_FOV], sizeof(float));
+    memcpy(&config.display_fov, &data[BREEZY_SHM_V5_OFFSET_DISPLAY_FOV], sizeof(float));
     
     // Read lens distance ratio (1 float)
-    memcpy(&config.lens_distance_ratio, &data[OFFSET_LENS_DISTANCE_RATIO], sizeof(float));
+    memcpy(&config.lens_distance_ratio, &data[BREEZY_SHM_V5_OFFSET_LENS_DISTANCE_RATIO], sizeof(float));
     
     // Read SBS enabled (1 bool)
-    config.sbs_enabled = data[OFFSET_SBS_ENABLED] != 0;
+    config.sbs_enabled = data[BREEZY_SHM_V5_OFFSET_SBS_ENABLED] != 0;
     
     // Read custom banner enabled (1 bool)
-    config.custom_banner_enabled = data[OFFSET_CUSTOM_BANNER_ENABLED] != 0;
+    config.custom_banner_enabled = data[BREEZY_SHM_V5_OFFSET_CUSTOM_BANNER_ENABLED] != 0;
     
     // Read smooth follow enabled (1 bool)
-    config.smooth_follow_enabled = data[OFFSET_SMOOTH_FOLLOW_ENABLED] != 0;
+    config.smooth_follow_enabled = data[BREEZY_SHM_V5_OFFSET_SMOOTH_FOLLOW_ENABLED] != 0;
     
     // Read smooth follow origin (16 floats = 4x4 matrix)
-    memcpy(config.smooth_follow_origin, &data[OFFSET_SMOOTH_FOLLOW_ORIGIN_DATA], sizeof(float) * 16);
+    memcpy(config.smooth_follow_origin, &data[BREEZY_SHM_V5_OFFSET_SMOOTH_FOLLOW_ORIGIN], sizeof(float) * 16);
     
     config.valid = true;
     
@@ -208,3 +368,65 @@ DeviceConfig read_device_config(IMUReader *reader) {
     return config;
 }
 
+// Cheap check of the driver's ENABLED flag (no parity check, no copy)
+bool imu_source_enabled(IMUReader *reader) {
+    pthread_mutex_lock(&reader->lock);
+    bool enabled = reader->shm_ptr && reader->shm_fd >= 0 &&
+                   ((const volatile uint8_t *)reader->shm_ptr)[BREEZY_SHM_V6_OFFSET_ENABLED] != 0;
+    pthread_mutex_unlock(&reader->lock);
+    return enabled;
+}
+
+int imu_wait_for_sample(IMUReader *reader, uint32_t *last_doorbell, int64_t deadline_ns) {
+    struct timespec deadline = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000LL),
+        .tv_nsec = (long)(deadline_ns % 1000000000LL)
+    };
+
+    while (true) {
+        // Snapshot the doorbell under the lock: the mapping may be swapped by a re-attach,
+        // which keeps the old one mapped while we're registered as waiting on it
+        pthread_mutex_lock(&reader->lock);
+        const uint8_t *data = (const uint8_t *)reader->shm_ptr;
+        if (!data || reader->shm_fd < 0 || shm_layout_version(reader) != BREEZY_SHM_V6_VERSION ||
+            !(data[BREEZY_SHM_V6_OFFSET_FLAGS] & BREEZY_SHM_V6_FLAG_DOORBELL)) {
+            pthread_mutex_unlock(&reader->lock);
+            return -1;
+        }
+
+        // FUTEX_WAIT only reads the word, so the read-only mapping is fine
+        uint32_t *doorbell = (uint32_t *)(uintptr_t)(data + BREEZY_SHM_V6_OFFSET_POSE_DOORBELL);
+        uint32_t current = __atomic_load_n(doorbell, __ATOMIC_ACQUIRE);
+        if (current != *last_doorbell) {
+            pthread_mutex_unlock(&reader->lock);
+            *last_doorbell = current;
+            return 1;
+        }
+        reader->doorbell_waiters++;
+        pthread_mutex_unlock(&reader->lock);
+
+        // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout
+        int waited = (int)syscall(SYS_futex, doorbell, FUTEX_WAIT_BITSET, current, &deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+        int wait_errno = errno;
+
+        // Off the word: a re-attach that replaced this mapping may unmap it now
+        pthread_mutex_lock(&reader->lock);
+        if (reader->shm_ptr == data) {
+            reader->doorbell_waiters--;
+        } else {
+            reader->retired_doorbell_waiters--;
+        }
+        pthread_mutex_unlock(&reader->lock);
+
+        if (waited != 0) {
+            // A signal returns too, so the main loop sees a shutdown request promptly
+            if (wait_errno == ETIMEDOUT || wait_errno == EINTR) {
+                return 0;
+            }
+            if (wait_errno != EAGAIN) {
+                log_warn("[IMU] Doorbell wait failed: %s\n", strerror(wait_errno));
+                return -1;
+            }
+        }
+    }
+}
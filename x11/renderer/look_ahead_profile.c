@@ -0,0 +1,160 @@
+/*
+ * Per-device look-ahead profiles
+ *
+ * The X11 renderer's calibrated look-ahead lives in
+ * $XDG_CONFIG_HOME/breezy_desktop/x11_look_ahead_profiles.conf, one "<device>=<milliseconds>"
+ * line per device, where <device> is the driver's "connected_device_brand connected_device_model"
+ * from /dev/shm/xr_driver_state. The value is the measured render-to-present latency minus the
+ * driver's constant (look_ahead_cfg[0]) at calibration time, and is added back to the constant.
+ * The file is the X11 renderer's alone: the KWin and GNOME compositors have different
+ * pipelines and keep the driver's constant.
+ */
+
+#define _GNU_SOURCE
+#include "breezy_x11_renderer.h"
+#include "logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DRIVER_STATE_PATH "/dev/shm/xr_driver_state"
+#define PROFILE_DIR_NAME "breezy_desktop"
+#define PROFILE_FILE_NAME "x11_look_ahead_profiles.conf"
+#define PROFILE_MAX_LINES 64
+#define PROFILE_LINE_MAX 256
+
+static void trim_newline(char *s) {
+    s[strcspn(s, "\r\n")] = '\0';
+}
+
+static int profile_path(char *path, size_t size, bool create_dir) {
+    const char *config_home = getenv("XDG_CONFIG_HOME");
+    char dir[PATH_MAX];
+    int written;
+    if (config_home && config_home[0]) {
+        written = snprintf(dir, sizeof(dir), "%s/%s", config_home, PROFILE_DIR_NAME);
+    } else {
+        const char *home = getenv("HOME");
+        if (!home || !home[0]) {
+            return -1;
+        }
+        written = snprintf(dir, sizeof(dir), "%s/.config/%s", home, PROFILE_DIR_NAME);
+    }
+    if (written < 0 || (size_t)written >= sizeof(dir)) {
+        return -1;
+    }
+
+    if (create_dir && mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        return -1;
+    }
+
+    written = snprintf(path, size, "%s/%s", dir, PROFILE_FILE_NAME);
+    return (written < 0 || (size_t)written >= size) ? -1 : 0;
+}
+
+int look_ahead_profile_device_key(char *key, size_t size) {
+    FILE *f = fopen(DRIVER_STATE_PATH, "r");
+    if (!f) {
+        return -1;
+    }
+
+    char brand[PROFILE_LINE_MAX] = "";
+    char model[PROFILE_LINE_MAX] = "";
+    char line[PROFILE_LINE_MAX];
+    while (fgets(line, sizeof(line), f)) {
+        trim_newline(line);
+        if (strncmp(line, "connected_device_brand=", 23) == 0) {
+            snprintf(brand, sizeof(brand), "%s", line + 23);
+        } else if (strncmp(line, "connected_device_model=", 23) == 0) {
+            snprintf(model, sizeof(model), "%s", line + 23);
+        }
+    }
+    fclose(f);
+
+    if (!brand[0] || !model[0]) {
+        return -1;  // No supported device connected
+    }
+
+    int written = snprintf(key, size, "%s %s", brand, model);
+    return (written < 0 || (size_t)written >= size) ? -1 : 0;
+}
+
+int look_ahead_profile_load(const char *device_key, float *offset_ms) {
+    char path[PATH_MAX];
+    if (profile_path(path, sizeof(path), false) != 0) {
+        return -1;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+
+    int result = -1;
+    size_t key_len = strlen(device_key);
+    char line[PROFILE_LINE_MAX];
+    while (fgets(line, sizeof(line), f)) {
+        trim_newline(line);
+        if (strncmp(line, device_key, key_len) == 0 && line[key_len] == '=') {
+            char *end;
+            float value = strtof(line + key_len + 1, &end);
+            if (end != line + key_len + 1 && isfinite(value)) {
+                *offset_ms = value;
+                result = 0;
+            }
+        }
+    }
+    fclose(f);
+    return result;
+}
+
+int look_ahead_profile_save(const char *device_key, float offset_ms) {
+    char path[PATH_MAX];
+    if (profile_path(path, sizeof(path), true) != 0) {
+        log_error("[Calibration] No config directory for look-ahead profiles\n");
+        return -1;
+    }
+
+    // Keep every other device's line, replace ours
+    char lines[PROFILE_MAX_LINES][PROFILE_LINE_MAX];
+    int line_count = 0;
+    size_t key_len = strlen(device_key);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        char line[PROFILE_LINE_MAX];
+        while (line_count < PROFILE_MAX_LINES - 1 && fgets(line, sizeof(line), f)) {
+            trim_newline(line);
+            if (!line[0] || (strncmp(line, device_key, key_len) == 0 && line[key_len] == '=')) {
+                continue;
+            }
+            snprintf(lines[line_count++], PROFILE_LINE_MAX, "%s", line);
+        }
+        fclose(f);
+    }
+    snprintf(lines[line_count++], PROFILE_LINE_MAX, "%s=%.2f", device_key, offset_ms);
+
+    // Write-then-rename so a renderer starting up never reads a partial file
+    char tmp_path[PATH_MAX + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    f = fopen(tmp_path, "w");
+    if (!f) {
+        log_error("[Calibration] Failed to write %s: %s\n", tmp_path, strerror(errno));
+        return -1;
+    }
+    for (int i = 0; i < line_count; i++) {
+        fprintf(f, "%s\n", lines[i]);
+    }
+    if (fclose(f) != 0 || rename(tmp_path, path) != 0) {
+        log_error("[Calibration] Failed to save %s: %s\n", path, strerror(errno));
+        unlink(tmp_path);
+        return -1;
+    }
+
+    log_info("[Calibration] Saved look-ahead offset %+.2fms for \"%s\" to %s\n", offset_ms, device_key, path);
+    return 0;
+}
@@ -10,6 +10,7 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
+#define GL_GLEXT_PROTOTYPES
 #include <GL/gl.h>
 #include <GL/glx.h>
 #include <GL/glxext.h>
@@ -27,6 +28,10 @@
 #define DRM_FORMAT_XRGB8888 0x34325258
 #endif
 
+// Presentation timestamps (GLX_OML_sync_control), used by look-ahead calibration
+static PFNGLXGETSYNCVALUESOMLPROC glx_get_sync_values = NULL;
+static PFNGLXWAITFORSBCOMLPROC glx_wait_for_sbc = NULL;
+
 // GLX helper functions
 static int create_glx_context_on_display(RenderThread *thread, const char *display_name) {
     // Open X display
@@ -116,6 +121,7 @@ static int create_glx_context_on_display(RenderThread *thread, const char *displ
         glXGetProcAddress((const GLubyte *)"glXSwapIntervalSGI");
     if (glXSwapIntervalSGI) {
         glXSwapIntervalSGI(1);  // 1 = vsync enabled
+        thread->vsync_enabled = true;
         log_debug("[GLX] VSync enabled\n");
     } else {
         // Try MESA_swap_control
@@ -123,11 +129,23 @@ static int create_glx_context_on_display(RenderThread *thread, const char *displ
             glXGetProcAddress((const GLubyte *)"glXSwapIntervalMESA");
         if (glXSwapIntervalMESA) {
             glXSwapIntervalMESA(1);
+            thread->vsync_enabled = true;
             log_debug("[GLX] VSync enabled (MESA)\n");
         } else {
             log_warn("[GLX] Warning: VSync extension not available\n");
         }
     }
+
+    // Swap timestamps for look-ahead calibration
+    const char *glx_extensions = glXQueryExtensionsString(thread->x_display, screen);
+    if (glx_extensions && strstr(glx_extensions, "GLX_OML_sync_control")) {
+        glx_get_sync_values = (PFNGLXGETSYNCVALUESOMLPROC)glXGetProcAddress((const GLubyte *)"glXGetSyncValuesOML");
+        glx_wait_for_sbc = (PFNGLXWAITFORSBCOMLPROC)glXGetProcAddress((const GLubyte *)"glXWaitForSbcOML");
+    }
+    int64_t ust, msc, sbc;
+    thread->present_timestamps = glx_get_sync_values && glx_wait_for_sbc &&
+                                 glx_get_sync_values(thread->x_display, thread->x_window, &ust, &msc, &sbc);
+    thread->swap_count = thread->present_timestamps ? sbc : 0;
     
     log_info("[GLX] OpenGL context created successfully\n");
     log_info("[GLX] OpenGL version: %s\n", glGetString(GL_VERSION));
@@ -138,7 +156,76 @@ static int create_glx_context_on_display(RenderThread *thread, const char *displ
     return 0;
 }
 
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+// Headless: an EGL context with no window system (llvmpipe in CI) rendering into an
+// offscreen framebuffer the size of the glasses display
+static int create_surfaceless_egl_context(RenderThread *thread) {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!eglGetPlatformDisplayEXT) {
+        log_error("[EGL] eglGetPlatformDisplayEXT not available\n");
+        return -1;
+    }
+
+    EGLDisplay display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        log_error("[EGL] Failed to initialize surfaceless display (EGL_MESA_platform_surfaceless)\n");
+        return -1;
+    }
+    thread->egl_display = display;
+
+    // No window configs without a window system; the default EGL_SURFACE_TYPE would ask for one
+    EGLint config_attribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) ||
+        !eglChooseConfig(display, config_attribs, &config, 1, &config_count) || config_count == 0) {
+        log_error("[EGL] No desktop OpenGL config\n");
+        return -1;
+    }
+
+    thread->egl_context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    if (thread->egl_context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, thread->egl_context)) {
+        log_error("[EGL] Failed to create a surfaceless context: 0x%x\n", eglGetError());
+        return -1;
+    }
+
+    GLuint renderbuffer = 0;
+    GLuint fbo = 0;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, (GLsizei)thread->output_width, (GLsizei)thread->output_height);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    thread->headless_renderbuffer = renderbuffer;
+    thread->headless_fbo = fbo;
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        log_error("[EGL] Offscreen framebuffer incomplete\n");
+        return -1;
+    }
+    glViewport(0, 0, (GLsizei)thread->output_width, (GLsizei)thread->output_height);
+
+    log_info("[EGL] Headless context created (%ux%u offscreen)\n", thread->output_width, thread->output_height);
+    log_info("[EGL] OpenGL version: %s\n", glGetString(GL_VERSION));
+    log_info("[EGL] OpenGL renderer: %s\n", glGetString(GL_RENDERER));
+    return 0;
+}
+
 int init_opengl_context(RenderThread *thread) {
+    if (thread->headless) {
+        if (create_surfaceless_egl_context(thread) == 0) {
+            return 0;
+        }
+        cleanup_opengl_context(thread);
+        log_error("[OpenGL] Failed to create headless OpenGL context\n");
+        return -1;
+    }
+
     // Try GLX first (X11-based)
     const char *display_name = getenv("DISPLAY");
     if (display_name) {
@@ -170,31 +257,80 @@ void cleanup_opengl_context(RenderThread *thread) {
         XCloseDisplay(thread->x_display);
         thread->x_display = NULL;
     }
-    
+
+    if (thread->headless_fbo) {
+        glDeleteFramebuffers(1, &thread->headless_fbo);
+        thread->headless_fbo = 0;
+    }
+    if (thread->headless_renderbuffer) {
+        glDeleteRenderbuffers(1, &thread->headless_renderbuffer);
+        thread->headless_renderbuffer = 0;
+    }
+
+    // Surface and context belong to the display, so they go before it is terminated
     if (thread->egl_display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(thread->egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (thread->egl_surface != EGL_NO_SURFACE) {
+            eglDestroySurface(thread->egl_display, thread->egl_surface);
+        }
+        if (thread->egl_context != EGL_NO_CONTEXT) {
+            eglDestroyContext(thread->egl_display, thread->egl_context);
+        }
         eglTerminate(thread->egl_display);
-        thread->egl_display = EGL_NO_DISPLAY;
     }
-    
-    if (thread->egl_surface != EGL_NO_SURFACE) {
-        eglDestroySurface(thread->egl_display, thread->egl_surface);
-        thread->egl_surface = EGL_NO_SURFACE;
+    thread->egl_surface = EGL_NO_SURFACE;
+    thread->egl_context = EGL_NO_CONTEXT;
+    thread->egl_display = EGL_NO_DISPLAY;
+}
+
+int opengl_context_make_current(RenderThread *thread, bool current) {
+    if (thread->glx_context && thread->x_display) {
+        bool ok = current ? glXMakeCurrent(thread->x_display, thread->x_window, thread->glx_context)
+                          : glXMakeCurrent(thread->x_display, None, NULL);
+        return ok ? 0 : -1;
     }
-    
-    if (thread->egl_context != EGL_NO_CONTEXT) {
-        eglDestroyContext(thread->egl_display, thread->egl_context);
-        thread->egl_context = EGL_NO_CONTEXT;
+    if (thread->egl_display != EGL_NO_DISPLAY && thread->egl_context != EGL_NO_CONTEXT) {
+        EGLSurface surface = current ? thread->egl_surface : EGL_NO_SURFACE;
+        EGLContext context = current ? thread->egl_context : EGL_NO_CONTEXT;
+        return eglMakeCurrent(thread->egl_display, surface, surface, context) ? 0 : -1;
     }
+    return -1;
 }
 
 void swap_buffers(RenderThread *thread) {
     if (thread->glx_context && thread->x_display && thread->x_window) {
         glXSwapBuffers(thread->x_display, thread->x_window);
+        thread->swap_count++;
     } else if (thread->egl_display != EGL_NO_DISPLAY && thread->egl_surface != EGL_NO_SURFACE) {
         eglSwapBuffers(thread->egl_display, thread->egl_surface);
     }
 }
 
+int opengl_present_time(RenderThread *thread, int64_t sbc, int64_t *present_ns) {
+    if (!thread->present_timestamps) {
+        return -1;
+    }
+
+    int64_t ust, msc, completed_sbc;
+    if (!glx_get_sync_values(thread->x_display, thread->x_window, &ust, &msc, &completed_sbc)) {
+        return -1;
+    }
+    if (completed_sbc < sbc) {
+        return 0;
+    }
+
+    // Already completed, so this returns at once - with the UST of the newest swap, which is
+    // only ours if no later one completed meanwhile
+    if (!glx_wait_for_sbc(thread->x_display, thread->x_window, sbc, &ust, &msc, &completed_sbc) ||
+        completed_sbc != sbc) {
+        return -1;
+    }
+
+    // Mesa's UST is CLOCK_MONOTONIC in microseconds
+    *present_ns = ust * 1000;
+    return 1;
+}
+
 // Check if EGL DMA-BUF extensions are available
 static bool check_dmabuf_extensions(EGLDisplay egl_display) {
     const char *extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
@@ -214,6 +350,20 @@ static bool check_dmabuf_extensions(EGLDisplay egl_display) {
     return has_dmabuf;
 }
 
+// EGL image entry points, resolved on first use. They don't depend on the display, so a
+// framebuffer change doesn't look them up again.
+static PFNEGLCREATEIMAGEKHRPROC egl_create_image = NULL;
+static PFNEGLDESTROYIMAGEKHRPROC egl_destroy_image = NULL;
+static PFNGLEGLIMAGETARGETTEXTURE2DOESPROC gl_egl_image_target_texture_2d = NULL;
+static pthread_once_t egl_image_procs_once = PTHREAD_ONCE_INIT;
+
+static void resolve_egl_image_procs(void) {
+    egl_create_image = (PFNEGLCREATEIMAGEKHRPROC)eglGetProcAddress("eglCreateImageKHR");
+    egl_destroy_image = (PFNEGLDESTROYIMAGEKHRPROC)eglGetProcAddress("eglDestroyImageKHR");
+    gl_egl_image_target_texture_2d = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)
+        eglGetProcAddress("glEGLImageTargetTexture2DOES");
+}
+
 // Import DMA-BUF file descriptor as OpenGL texture (zero-copy)
 GLuint import_dmabuf_as_texture(RenderThread *thread, int dmabuf_fd, uint32_t width, uint32_t height, uint32_t format, uint32_t stride, uint64_t modifier) {
     // For now, we need EGL display - if using GLX, we'd need to create EGL context too
@@ -245,18 +395,16 @@ GLuint import_dmabuf_as_texture(RenderThread *thread, int dmabuf_fd, uint32_t wi
         return 0;
     }
     
-    // Check for DMA-BUF extensions (check_dmabuf_extensions already logs the error)
-    if (!check_dmabuf_extensions(egl_display)) {
+    // Check for DMA-BUF extensions once per display (check_dmabuf_extensions already logs the error)
+    if (thread->frame_egl_image == EGL_NO_IMAGE_KHR && !check_dmabuf_extensions(egl_display)) {
         return 0;
     }
     
     // Get function pointers
-    PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR = (PFNEGLCREATEIMAGEKHRPROC)
-        eglGetProcAddress("eglCreateImageKHR");
-    PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR = (PFNEGLDESTROYIMAGEKHRPROC)
-        eglGetProcAddress("eglDestroyImageKHR");
-    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)
-        eglGetProcAddress("glEGLImageTargetTexture2DOES");
+    pthread_once(&egl_image_procs_once, resolve_egl_image_procs);
+    PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR = egl_create_image;
+    PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR = egl_destroy_image;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES = gl_egl_image_target_texture_2d;
     
     if (!eglCreateImageKHR || !eglDestroyImageKHR || !glEGLImageTargetTexture2DOES) {
         log_fallback("EGL DMA-BUF import", "Required function pointers not available (eglCreateImageKHR/eglDestroyImageKHR/glEGLImageTargetTexture2DOES)");
@@ -318,22 +466,25 @@ GLuint import_dmabuf_as_texture(RenderThread *thread, int dmabuf_fd, uint32_t wi
     
     glBindTexture(GL_TEXTURE_2D, texture);
     
-    // Cleanup old EGL image if it exists
-    if (thread->frame_egl_image != EGL_NO_IMAGE_KHR) {
-        glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, EGL_NO_IMAGE_KHR);
-        eglDestroyImageKHR(egl_display, thread->frame_egl_image);
+    // Bind EGL image to texture (zero-copy!). This respecifies the existing texture, which
+    // releases the previous image, so the texture object survives a framebuffer change.
+    while (glGetError() != GL_NO_ERROR) {
     }
-    
-    // Bind EGL image to texture (zero-copy!)
     glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, egl_image);
     
     GLenum gl_error = glGetError();
     if (gl_error != GL_NO_ERROR) {
         log_error("Error binding EGL image to texture: 0x%x - DMA-BUF import failed!\n", gl_error);
+        glBindTexture(GL_TEXTURE_2D, 0);
         eglDestroyImageKHR(egl_display, egl_image);
         return 0;
     }
     
+    // Cleanup old EGL image if it exists
+    if (thread->frame_egl_image != EGL_NO_IMAGE_KHR) {
+        eglDestroyImageKHR(egl_display, thread->frame_egl_image);
+    }
+    
     // Set texture parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -345,6 +496,9 @@ GLuint import_dmabuf_as_texture(RenderThread *thread, int dmabuf_fd, uint32_t wi
     // Store EGL image for cleanup later
     thread->frame_egl_image = egl_image;
     
+    // New source image - any mip chain built from the previous one is stale
+    thread->mip_valid = false;
+    
     log_info("DMA-BUF successfully imported as texture (zero-copy): texture=%u, %dx%d, format=0x%x, stride=%u\n",
              texture, width, height, format, stride);
     
@@ -355,10 +509,9 @@ void cleanup_dmabuf_texture(RenderThread *thread) {
     EGLDisplay egl_display = thread->egl_display;
     
     if (thread->frame_egl_image != EGL_NO_IMAGE_KHR && egl_display != EGL_NO_DISPLAY) {
-        PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR = (PFNEGLDESTROYIMAGEKHRPROC)
-            eglGetProcAddress("eglDestroyImageKHR");
-        if (eglDestroyImageKHR) {
-            eglDestroyImageKHR(egl_display, thread->frame_egl_image);
+        pthread_once(&egl_image_procs_once, resolve_egl_image_procs);
+        if (egl_destroy_image) {
+            egl_destroy_image(egl_display, thread->frame_egl_image);
         }
         thread->frame_egl_image = EGL_NO_IMAGE_KHR;
     }
@@ -374,3 +527,167 @@ void cleanup_dmabuf_texture(RenderThread *thread) {
     }
 }
 
+
+
+// Number of mip levels needed to reach a 1x1 level from width x height
+static uint32_t mip_level_count(uint32_t width, uint32_t height) {
+    uint32_t size = width > height ? width : height;
+    uint32_t levels = 1;
+    while (size > 1) {
+        size >>= 1;
+        levels++;
+    }
+    return levels;
+}
+
+static uint32_t mip_dimension(uint32_t size, uint32_t level) {
+    uint32_t value = size >> level;
+    return value > 0 ? value : 1;
+}
+
+// (Re)allocate the mip chain storage when the source size changes
+static int ensure_mipmapped_storage(RenderThread *thread, uint32_t width, uint32_t height) {
+    if (thread->mip_texture != 0 && thread->mip_width == width && thread->mip_height == height) {
+        return 0;
+    }
+    
+    if (thread->mip_texture == 0) {
+        glGenTextures(1, &thread->mip_texture);
+    }
+    if (thread->mip_fbos[0] == 0) {
+        glGenFramebuffers(2, thread->mip_fbos);
+    }
+    
+    uint32_t levels = mip_level_count(width, height);
+    glBindTexture(GL_TEXTURE_2D, thread->mip_texture);
+    for (uint32_t level = 0; level < levels; level++) {
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA8,
+                     (GLsizei)mip_dimension(width, level), (GLsizei)mip_dimension(height, level),
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)(levels - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    GLenum gl_error = glGetError();
+    if (gl_error != GL_NO_ERROR) {
+        log_error("[Mipmap] Failed to allocate %ux%u mip chain (%u levels): 0x%x\n", width, height, levels, gl_error);
+        cleanup_mipmapped_texture(thread);
+        return -1;
+    }
+    
+    thread->mip_width = width;
+    thread->mip_height = height;
+    thread->mip_levels = levels;
+    thread->mip_valid = false;
+    
+    log_info("[Mipmap] Allocated %ux%u mip chain with %u levels\n", width, height, levels);
+    return 0;
+}
+
+// Copy the damaged region of the imported frame into level 0 of the mip chain and
+// downsample only the affected texels of each further level. Each level is a 2:1 linear
+// blit from the one above it, so the chain matches what glGenerateMipmap would produce
+// for the touched area without re-filtering the whole 4K surface every capture.
+int update_mipmapped_texture(RenderThread *thread, uint32_t width, uint32_t height, const DamageRect *damage) {
+    if (thread->frame_texture == 0 || width == 0 || height == 0) {
+        return -1;
+    }
+    
+    if (ensure_mipmapped_storage(thread, width, height) != 0) {
+        return -1;
+    }
+    
+    // Without a complete level 0 a partial update would leave stale texels behind
+    uint32_t x0 = 0, y0 = 0, x1 = width, y1 = height;
+    if (thread->mip_valid && damage) {
+        if (damage->width == 0 || damage->height == 0) {
+            return 0;  // Nothing changed since the chain was built
+        }
+        x0 = damage->x < width ? damage->x : width;
+        y0 = damage->y < height ? damage->y : height;
+        x1 = damage->x + damage->width < width ? damage->x + damage->width : width;
+        y1 = damage->y + damage->height < height ? damage->y + damage->height : height;
+        if (x0 >= x1 || y0 >= y1) {
+            return 0;
+        }
+    }
+    
+    GLuint read_fbo = thread->mip_fbos[0];
+    GLuint draw_fbo = thread->mip_fbos[1];
+    
+    // Level 0: exact copy of the damaged region
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_fbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, thread->frame_texture, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_fbo);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, thread->mip_texture, 0);
+    glBlitFramebuffer((GLint)x0, (GLint)y0, (GLint)x1, (GLint)y1,
+                      (GLint)x0, (GLint)y0, (GLint)x1, (GLint)y1,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    
+    // Further levels: expand the region to even texel bounds so each destination texel
+    // sees all four of its source texels, then halve it
+    for (uint32_t level = 1; level < thread->mip_levels; level++) {
+        uint32_t src_w = mip_dimension(width, level - 1);
+        uint32_t src_h = mip_dimension(height, level - 1);
+        uint32_t dst_w = mip_dimension(width, level);
+        uint32_t dst_h = mip_dimension(height, level);
+        
+        uint32_t dx0 = x0 / 2;
+        uint32_t dy0 = y0 / 2;
+        uint32_t dx1 = (x1 + 1) / 2 < dst_w ? (x1 + 1) / 2 : dst_w;
+        uint32_t dy1 = (y1 + 1) / 2 < dst_h ? (y1 + 1) / 2 : dst_h;
+        
+        // Source extent for the destination region; odd-sized levels fold the last texel in
+        uint32_t sx0 = dx0 * 2;
+        uint32_t sy0 = dy0 * 2;
+        uint32_t sx1 = dx1 == dst_w ? src_w : dx1 * 2;
+        uint32_t sy1 = dy1 == dst_h ? src_h : dy1 * 2;
+        
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, thread->mip_texture, (GLint)(level - 1));
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, thread->mip_texture, (GLint)level);
+        glBlitFramebuffer((GLint)sx0, (GLint)sy0, (GLint)sx1, (GLint)sy1,
+                          (GLint)dx0, (GLint)dy0, (GLint)dx1, (GLint)dy1,
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        
+        x0 = dx0;
+        y0 = dy0;
+        x1 = dx1;
+        y1 = dy1;
+    }
+    
+    // Back to the display framebuffer (the offscreen one when headless)
+    glBindFramebuffer(GL_FRAMEBUFFER, thread->headless_fbo);
+    
+    GLenum gl_error = glGetError();
+    if (gl_error != GL_NO_ERROR) {
+        log_error("[Mipmap] Error updating mip chain: 0x%x\n", gl_error);
+        thread->mip_valid = false;
+        return -1;
+    }
+    
+    thread->mip_valid = true;
+    return 0;
+}
+
+void cleanup_mipmapped_texture(RenderThread *thread) {
+    if (thread->mip_fbos[0] != 0) {
+        glDeleteFramebuffers(2, thread->mip_fbos);
+        thread->mip_fbos[0] = 0;
+        thread->mip_fbos[1] = 0;
+    }
+    
+    if (thread->mip_texture != 0) {
+        glDeleteTextures(1, &thread->mip_texture);
+        thread->mip_texture = 0;
+    }
+    
+    thread->mip_width = 0;
+    thread->mip_height = 0;
+    thread->mip_levels = 0;
+    thread->mip_valid = false;
+}
@@ -0,0 +1,515 @@
+/*
+ * Motion-to-photon latency harness
+ *
+ * Runs the renderer in headless mode (headless.c) against a synthetic IMU: the
+ * harness publishes poses into its own v6 shared memory file (BREEZY_IMU_SHM_PATH)
+ * at IMU rate, with a scripted yaw step every STEP_INTERVAL_MS, and reads back what
+ * the renderer presented. The step sample carries the old pose as t1, so with
+ * prediction enabled the renderer sees a large angular velocity for a few frames.
+ *
+ * Each run is done twice, with prediction disabled (BREEZY_DISABLE_PREDICTION=1)
+ * and enabled, and reports:
+ *   - pose-to-present: step sample published -> first completed frame whose virtual
+ *     display edge moved
+ *   - content-to-present: content frame produced -> first completed frame showing it
+ *   - overshoot: how far past its settled position the edge went after a step
+ *
+ * Needs an EGL implementation with EGL_MESA_platform_surfaceless (Mesa; llvmpipe in
+ * CI with LIBGL_ALWAYS_SOFTWARE=1) and Sombrero.frag where the renderer looks for it,
+ * so run it from x11/renderer. Exits 0 on success, 1 on failure (a renderer that
+ * doesn't exit cleanly, or a pose-to-present p99 over max_p99_ms) and 77 if the
+ * renderer can't start headless (skip).
+ *
+ * Usage: latency_harness [renderer] [seconds] [render_hz] [max_p99_ms]
+ */
+
+#define _GNU_SOURCE
+#include "../logging.h"
+#include "breezy_shm_layout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#define EXIT_SKIP 77
+#define DEFAULT_RENDERER "./breezy_x11_renderer"
+#define DEFAULT_SECONDS 10
+#define DEFAULT_RENDER_HZ 60
+#define VIRTUAL_WIDTH 640
+#define VIRTUAL_HEIGHT 360
+#define CAPTURE_HZ 30
+#define IMU_HZ 1000
+#define STEP_INTERVAL_MS 250
+#define STEP_YAW_DEGREES 4.0
+#define WARMUP_MS 1500       // Shader compile and first frames on llvmpipe
+#define EDGE_MOVED_PX 2
+#define MAX_STEPS 1024
+#define MAX_EVENTS 65536
+
+typedef struct {
+    float quat[4];  // x, y, z, w
+    int64_t time_ns;
+} PoseSample;
+
+typedef struct {
+    uint8_t *shm;
+    atomic_bool stop;
+    atomic_bool stepping;
+    PoseSample history[3];  // t0, t1, t2
+
+    int64_t step_ns[MAX_STEPS];
+    atomic_uint step_count;
+} Harness;
+
+typedef struct {
+    uint32_t frame;
+    int64_t submit_ns;
+    int64_t complete_ns;
+    int edge_x;
+    uint32_t content;
+} PresentEvent;
+
+typedef struct {
+    uint32_t frame;
+    int64_t produced_ns;
+} ContentEvent;
+
+typedef struct {
+    PresentEvent *presents;
+    uint32_t present_count;
+    ContentEvent *contents;
+    uint32_t content_count;
+} Results;
+
+static int64_t monotonic_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint64_t realtime_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void sleep_until_ns(int64_t deadline_ns) {
+    struct timespec ts = { .tv_sec = deadline_ns / 1000000000LL, .tv_nsec = deadline_ns % 1000000000LL };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static void yaw_quaternion(double degrees, float quat[4]) {
+    double half = degrees * M_PI / 360.0;
+    quat[0] = 0.0f;
+    quat[1] = 0.0f;
+    quat[2] = (float)sin(half);
+    quat[3] = (float)cos(half);
+}
+
+// Seqlock-publish the pose history and ring the doorbell, the way the driver does
+static void publish_pose(Harness *harness) {
+    uint8_t *shm = harness->shm;
+    uint32_t *sequence = (uint32_t *)(shm + BREEZY_SHM_V6_OFFSET_POSE_SEQUENCE);
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    uint64_t epoch_ms = realtime_now_ms();
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_EPOCH_MS, &epoch_ms, sizeof(epoch_ms));
+    float orientation[16];
+    uint64_t sample_time_ns[3];
+    for (int i = 0; i < 3; i++) {
+        memcpy(&orientation[i * 4], harness->history[i].quat, sizeof(float) * 4);
+        sample_time_ns[i] = (uint64_t)harness->history[i].time_ns;
+        orientation[12 + i] = (float)((double)(harness->history[i].time_ns - harness->history[2].time_ns) / 1e6);
+    }
+    orientation[15] = 0.0f;
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_POSE_ORIENTATION, orientation, sizeof(orientation));
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_SAMPLE_TIME_NS, sample_time_ns, sizeof(sample_time_ns));
+    uint32_t checksum = breezy_shm_checksum(shm, BREEZY_SHM_V6_POSE_DATA_START, BREEZY_SHM_V6_POSE_BLOCK_END);
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_POSE_CHECKSUM, &checksum, sizeof(checksum));
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);
+
+    uint32_t *doorbell = (uint32_t *)(shm + BREEZY_SHM_V6_OFFSET_POSE_DOORBELL);
+    __atomic_add_fetch(doorbell, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, doorbell, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static void init_shm(uint8_t *shm) {
+    memset(shm, 0, BREEZY_SHM_V6_LENGTH);
+    shm[BREEZY_SHM_V6_OFFSET_VERSION] = BREEZY_SHM_V6_VERSION;
+    shm[BREEZY_SHM_V6_OFFSET_ENABLED] = 1;
+    shm[BREEZY_SHM_V6_OFFSET_FLAGS] = BREEZY_SHM_V6_FLAG_MONOTONIC_TIME | BREEZY_SHM_V6_FLAG_DOORBELL;
+    uint32_t length = BREEZY_SHM_V6_LENGTH;
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_LENGTH, &length, sizeof(length));
+
+    // Glasses the size of the virtual display, so the display fills the view at rest
+    float look_ahead_cfg[4] = { 10.0f, 1.25f, 30.0f, 0.0f };
+    uint32_t display_res[2] = { VIRTUAL_WIDTH, VIRTUAL_HEIGHT };
+    float display_fov = 46.0f;
+    float lens_distance_ratio = 0.035f;
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_LOOK_AHEAD_CFG, look_ahead_cfg, sizeof(look_ahead_cfg));
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_DISPLAY_RES, display_res, sizeof(display_res));
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_DISPLAY_FOV, &display_fov, sizeof(display_fov));
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_LENS_DISTANCE_RATIO, &lens_distance_ratio, sizeof(lens_distance_ratio));
+    uint32_t checksum = breezy_shm_checksum(shm, BREEZY_SHM_V6_CONFIG_DATA_START, BREEZY_SHM_V6_CONFIG_BLOCK_END);
+    memcpy(shm + BREEZY_SHM_V6_OFFSET_CONFIG_CHECKSUM, &checksum, sizeof(checksum));
+}
+
+// Synthetic IMU: holds a pose, and alternates between +/-STEP_YAW_DEGREES once stepping
+static void *imu_thread_func(void *arg) {
+    Harness *harness = arg;
+    const int64_t period_ns = 1000000000LL / IMU_HZ;
+    const int64_t step_period_ns = STEP_INTERVAL_MS * 1000000LL;
+
+    double yaw = -STEP_YAW_DEGREES;
+    float quat[4];
+    yaw_quaternion(yaw, quat);
+    int64_t now_ns = monotonic_now_ns();
+    for (int i = 0; i < 3; i++) {
+        memcpy(harness->history[i].quat, quat, sizeof(quat));
+        harness->history[i].time_ns = now_ns - i * period_ns;
+    }
+
+    int64_t next_sample_ns = now_ns;
+    int64_t next_step_ns = 0;
+    while (!atomic_load(&harness->stop)) {
+        sleep_until_ns(next_sample_ns);
+        next_sample_ns += period_ns;
+        now_ns = monotonic_now_ns();
+
+        bool step = false;
+        if (atomic_load(&harness->stepping)) {
+            if (next_step_ns == 0) {
+                next_step_ns = now_ns + step_period_ns;
+            } else if (now_ns >= next_step_ns) {
+                yaw = -yaw;
+                yaw_quaternion(yaw, quat);
+                next_step_ns += step_period_ns;
+                step = true;
+            }
+        } else {
+            next_step_ns = 0;
+        }
+
+        harness->history[2] = harness->history[1];
+        harness->history[1] = harness->history[0];
+        memcpy(harness->history[0].quat, quat, sizeof(quat));
+        harness->history[0].time_ns = now_ns;
+        publish_pose(harness);
+
+        uint32_t count = atomic_load(&harness->step_count);
+        if (step && count < MAX_STEPS) {
+            harness->step_ns[count] = now_ns;
+            atomic_store(&harness->step_count, count + 1);
+        }
+    }
+    return NULL;
+}
+
+static int load_results(const char *path, Results *results) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+
+    results->presents = calloc(MAX_EVENTS, sizeof(PresentEvent));
+    results->contents = calloc(MAX_EVENTS, sizeof(ContentEvent));
+    results->present_count = 0;
+    results->content_count = 0;
+    if (!results->presents || !results->contents) {
+        fclose(f);
+        return -1;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        PresentEvent present;
+        ContentEvent content;
+        long long submit_ns, complete_ns, produced_ns;
+        if (sscanf(line, "present %u %lld %lld %d %u", &present.frame, &submit_ns, &complete_ns,
+                   &present.edge_x, &present.content) == 5) {
+            if (results->present_count < MAX_EVENTS) {
+                present.submit_ns = submit_ns;
+                present.complete_ns = complete_ns;
+                results->presents[results->present_count++] = present;
+            }
+        } else if (sscanf(line, "content %u %lld", &content.frame, &produced_ns) == 2) {
+            if (results->content_count < MAX_EVENTS) {
+                content.produced_ns = produced_ns;
+                results->contents[results->content_count++] = content;
+            }
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static void free_results(Results *results) {
+    free(results->presents);
+    free(results->contents);
+}
+
+static int compare_int64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts samples; returns the p99 in units, or -1 without samples
+static double report(const char *mode, const char *what, int64_t *samples, uint32_t count, double unit_ns, const char *unit) {
+    if (count == 0) {
+        log_info("[Latency] %s %s: no samples\n", mode, what);
+        return -1.0;
+    }
+    qsort(samples, count, sizeof(samples[0]), compare_int64);
+    double p99 = samples[(uint32_t)((count - 1) * 0.99)] / unit_ns;
+    log_info("[Latency] %s %s: n=%u p50=%.1f%s p90=%.1f%s p99=%.1f%s max=%.1f%s\n", mode, what, count,
+             samples[count / 2] / unit_ns, unit,
+             samples[(uint32_t)((count - 1) * 0.9)] / unit_ns, unit,
+             p99, unit,
+             samples[count - 1] / unit_ns, unit);
+    return p99;
+}
+
+// The edge the display settles on after the step at step_ns, before the next one
+static int settled_edge(const Results *results, int64_t next_step_ns) {
+    int edge = INT_MIN;
+    for (uint32_t i = 0; i < results->present_count; i++) {
+        if (results->presents[i].submit_ns < next_step_ns) {
+            edge = results->presents[i].edge_x;
+        }
+    }
+    return edge;
+}
+
+static double analyze(const char *mode, const Harness *harness, const Results *results) {
+    uint32_t step_count = atomic_load(&harness->step_count);
+    int64_t *pose_ns = calloc(step_count ? step_count : 1, sizeof(int64_t));
+    int64_t *overshoot_px = calloc(step_count ? step_count : 1, sizeof(int64_t));
+    int64_t *content_ns = calloc(results->content_count ? results->content_count : 1, sizeof(int64_t));
+    uint32_t pose_count = 0, overshoot_count = 0, content_count = 0;
+    if (!pose_ns || !overshoot_px || !content_ns) {
+        free(pose_ns);
+        free(overshoot_px);
+        free(content_ns);
+        return -1.0;
+    }
+
+    // Pose-to-present: the last step is skipped since the run may end before it settles
+    for (uint32_t s = 0; s + 1 < step_count; s++) {
+        int64_t step_ns = harness->step_ns[s];
+        int64_t next_step_ns = harness->step_ns[s + 1];
+        int before = INT_MIN;
+        uint32_t i = 0;
+        for (; i < results->present_count && results->presents[i].submit_ns < step_ns; i++) {
+            before = results->presents[i].edge_x;
+        }
+        if (before == INT_MIN) {
+            continue;
+        }
+
+        int settled = settled_edge(results, next_step_ns);
+        int64_t max_overshoot = 0;
+        bool moved = false;
+        for (; i < results->present_count && results->presents[i].submit_ns < next_step_ns; i++) {
+            const PresentEvent *present = &results->presents[i];
+            if (!moved && abs(present->edge_x - before) > EDGE_MOVED_PX) {
+                pose_ns[pose_count++] = present->complete_ns - step_ns;
+                moved = true;
+            }
+            // Past the settled edge, in the direction of travel
+            int64_t past = (int64_t)(present->edge_x - settled) * (settled > before ? 1 : -1);
+            if (moved && past > max_overshoot) {
+                max_overshoot = past;
+            }
+        }
+        if (moved && settled != before) {
+            overshoot_px[overshoot_count++] = max_overshoot;
+        }
+    }
+
+    // Content-to-present: the frame number is painted modulo 16 bits, 0 means no content
+    uint32_t p = 0;
+    for (uint32_t c = 0; c < results->content_count; c++) {
+        const ContentEvent *content = &results->contents[c];
+        uint32_t painted = content->frame & 0xffff;
+        if (painted == 0) {
+            continue;
+        }
+        while (p < results->present_count && results->presents[p].complete_ns < content->produced_ns) {
+            p++;
+        }
+        for (uint32_t i = p; i < results->present_count; i++) {
+            if (results->presents[i].content == painted) {
+                content_ns[content_count++] = results->presents[i].complete_ns - content->produced_ns;
+                break;
+            }
+        }
+    }
+
+    double p99 = report(mode, "pose-to-present", pose_ns, pose_count, 1e6, "ms");
+    report(mode, "content-to-present", content_ns, content_count, 1e6, "ms");
+    report(mode, "overshoot", overshoot_px, overshoot_count, 1.0, "px");
+    if (step_count > 1 && pose_count == 0) {
+        log_error("[Latency] %s: the display never moved for %u pose steps\n", mode, step_count);
+    }
+
+    free(pose_ns);
+    free(overshoot_px);
+    free(content_ns);
+    return pose_count ? p99 : -1.0;
+}
+
+static pid_t start_renderer(const char *renderer, const char *shm_path, const char *results_path,
+                            bool prediction, uint32_t render_hz) {
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+
+    char width[16], height[16], capture_hz[16], render_rate[16];
+    snprintf(width, sizeof(width), "%d", VIRTUAL_WIDTH);
+    snprintf(height, sizeof(height), "%d", VIRTUAL_HEIGHT);
+    snprintf(capture_hz, sizeof(capture_hz), "%d", CAPTURE_HZ);
+    snprintf(render_rate, sizeof(render_rate), "%u", render_hz);
+    setenv("BREEZY_RENDERER_HEADLESS", results_path, 1);
+    setenv("BREEZY_IMU_SHM_PATH", shm_path, 1);
+    setenv("BREEZY_DISABLE_PREDICTION", prediction ? "0" : "1", 1);
+    execl(renderer, renderer, width, height, capture_hz, render_rate, (char *)NULL);
+    fprintf(stderr, "Failed to run %s: %s\n", renderer, strerror(errno));
+    _exit(EXIT_SKIP);
+}
+
+// Returns the pose-to-present p99 in ms, -1 if nothing was measured, -2 to skip
+static double run_mode(Harness *harness, const char *renderer, const char *shm_path,
+                       bool prediction, uint32_t seconds, uint32_t render_hz) {
+    const char *mode = prediction ? "prediction on:" : "prediction off:";
+    char results_path[] = "/tmp/breezy_latency_results_XXXXXX";
+    int results_fd = mkstemp(results_path);
+    if (results_fd < 0) {
+        return -1.0;
+    }
+    close(results_fd);
+
+    atomic_store(&harness->stepping, false);
+    atomic_store(&harness->step_count, 0);
+    pid_t pid = start_renderer(renderer, shm_path, results_path, prediction, render_hz);
+    if (pid < 0) {
+        unlink(results_path);
+        return -1.0;
+    }
+
+    // Let the renderer start at a steady pose, then step for the rest of the run
+    sleep_until_ns(monotonic_now_ns() + WARMUP_MS * 1000000LL);
+    int status = 0;
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+        log_warn("[Latency] Renderer exited during start-up (status %d), skipping\n",
+                 WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        unlink(results_path);
+        return -2.0;
+    }
+    atomic_store(&harness->stepping, true);
+    sleep_until_ns(monotonic_now_ns() + (int64_t)seconds * 1000000000LL);
+    atomic_store(&harness->stepping, false);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, &status, 0);
+    // A clean shutdown exits 0; anything else (e.g. a strict allocation trace) fails the run
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        log_error("[Latency] %s renderer exited with status %d\n", mode,
+                  WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        unlink(results_path);
+        return -1.0;
+    }
+
+    Results results;
+    double p99 = -1.0;
+    if (load_results(results_path, &results) == 0) {
+        log_info("[Latency] %s %u frames, %u content frames, %u pose steps\n", mode,
+                 results.present_count, results.content_count, atomic_load(&harness->step_count));
+        p99 = analyze(mode, harness, &results);
+        free_results(&results);
+    }
+    unlink(results_path);
+    return p99;
+}
+
+int main(int argc, char *argv[]) {
+    const char *renderer = argc > 1 ? argv[1] : DEFAULT_RENDERER;
+    uint32_t seconds = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : DEFAULT_SECONDS;
+    uint32_t render_hz = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : DEFAULT_RENDER_HZ;
+    double max_p99_ms = argc > 4 ? strtod(argv[4], NULL) : 0.0;
+    if (seconds == 0 || render_hz == 0) {
+        fprintf(stderr, "Usage: %s [renderer] [seconds] [render_hz] [max_p99_ms]\n", argv[0]);
+        return 1;
+    }
+
+    log_init();
+
+    if (access(renderer, X_OK) != 0) {
+        log_warn("[Latency] %s not built, skipping\n", renderer);
+        return EXIT_SKIP;
+    }
+
+    char shm_path[] = "/dev/shm/breezy_latency_imu_XXXXXX";
+    int shm_fd = mkstemp(shm_path);
+    if (shm_fd < 0 || ftruncate(shm_fd, BREEZY_SHM_V6_LENGTH) != 0) {
+        log_error("[Latency] Failed to create %s: %s\n", shm_path, strerror(errno));
+        return 1;
+    }
+
+    static Harness harness;
+    harness.shm = mmap(NULL, BREEZY_SHM_V6_LENGTH, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);
+    if (harness.shm == MAP_FAILED) {
+        unlink(shm_path);
+        return 1;
+    }
+    init_shm(harness.shm);
+
+    pthread_t imu_thread;
+    if (pthread_create(&imu_thread, NULL, imu_thread_func, &harness) != 0) {
+        log_error("[Latency] Failed to start IMU thread\n");
+        unlink(shm_path);
+        return 1;
+    }
+
+    int result = 0;
+    for (int prediction = 0; prediction <= 1 && result == 0; prediction++) {
+        double p99 = run_mode(&harness, renderer, shm_path, prediction, seconds, render_hz);
+        if (p99 == -2.0) {
+            result = EXIT_SKIP;
+        } else if (p99 < 0.0) {
+            result = 1;
+        } else if (max_p99_ms > 0.0 && p99 > max_p99_ms) {
+            log_error("[Latency] Pose-to-present p99 %.1fms exceeds %.1fms\n", p99, max_p99_ms);
+            result = 1;
+        }
+    }
+
+    atomic_store(&harness.stop, true);
+    pthread_join(imu_thread, NULL);
+    munmap(harness.shm, BREEZY_SHM_V6_LENGTH);
+    unlink(shm_path);
+
+    log_info("[Latency] %s\n", result == 0 ? "PASS" : result == EXIT_SKIP ? "SKIP" : "FAIL");
+    log_cleanup();
+    return result;
+}
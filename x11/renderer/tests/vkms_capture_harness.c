@@ -0,0 +1,398 @@
+/*
+ * vkms capture harness
+ *
+ * Exercises the DRM/DMA-BUF capture path without the patched Xorg or a GPU. The
+ * kernel's vkms driver provides the DRM device: the harness creates a dumb-buffer
+ * framebuffer on it, publishes the FB ID the way the FRAMEBUFFER_ID RandR property
+ * would (through drm_capture_set_framebuffer_id_source), and runs a capture thread
+ * doing what the renderer's does each tick: drm_capture_refresh, then hand the
+ * DMA-BUF FD over (dup on framebuffer change).
+ *
+ * It then replaces the framebuffer several times, like a mode change does, and
+ * reports:
+ *   - capture overhead: time per steady-state tick
+ *   - rebind cost: drm_capture_refresh moving onto the new FB on the open device
+ *   - framebuffer-change recovery: old FB removed -> capture on the new FB
+ *   - FD leaks: open FDs before init vs. after cleanup
+ *
+ * A change has to take the rebind path, not a full re-init, and recover within one
+ * render frame (render_hz).
+ *
+ * Needs the vkms module (modprobe vkms) and root: drmModeGetFB only returns buffer
+ * handles to the DRM master or CAP_SYS_ADMIN. Exits 0 on success, 1 on failure and
+ * 77 if vkms isn't available (skip).
+ *
+ * Usage: vkms_capture_harness [frames] [changes] [capture_hz] [render_hz]
+ */
+
+#define _GNU_SOURCE
+#include "../breezy_x11_renderer.h"
+#include "../logging.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm/drm.h>
+
+#define EXIT_SKIP 77
+#define DEFAULT_FRAMES 1200
+#define DEFAULT_CHANGES 20
+#define DEFAULT_CAPTURE_HZ 120
+#define DEFAULT_RENDER_HZ 60
+#define WAIT_TIMEOUT_NS 2000000000LL
+
+typedef struct {
+    uint32_t fb_id;
+    uint32_t handle;
+    uint32_t width;
+    uint32_t height;
+} TestFramebuffer;
+
+typedef struct {
+    CaptureThread capture;
+    int64_t period_ns;
+    atomic_bool stop;
+
+    atomic_uint published_fb_id;
+    atomic_uint captured_fb_id;  // FB the capture thread last handed off
+    atomic_llong captured_at_ns;
+
+    // Steady-state tick costs (written by the capture thread until full)
+    int64_t *tick_ns;
+    atomic_uint tick_count;
+    uint32_t tick_capacity;
+
+    // Cost of the drm_capture_refresh calls that rebound or re-initialized
+    int64_t rebind_ns[64];
+    atomic_uint rebind_count;
+    int64_t reinit_ns[64];
+    atomic_uint reinit_count;
+    atomic_uint refresh_errors;
+
+    int handed_fd;  // the render thread's copy of the DMA-BUF FD
+} Harness;
+
+static int64_t monotonic_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until_ns(int64_t deadline_ns) {
+    struct timespec ts = { .tv_sec = deadline_ns / 1000000000LL, .tv_nsec = deadline_ns % 1000000000LL };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static int count_open_fds(void) {
+    DIR *dir = opendir("/proc/self/fd");
+    if (!dir) {
+        return -1;
+    }
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count - 1;  // the directory's own FD
+}
+
+static int open_vkms_card(void) {
+    for (int i = 0; i < 16; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/dev/dri/card%d", i);
+        int fd = open(path, O_RDWR | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        drmVersionPtr version = drmGetVersion(fd);
+        bool is_vkms = version && version->name && strcmp(version->name, "vkms") == 0;
+        if (version) {
+            drmFreeVersion(version);
+        }
+        if (is_vkms) {
+            log_info("[vkms] Using %s\n", path);
+            return fd;
+        }
+        close(fd);
+    }
+    return -1;
+}
+
+static int create_framebuffer(int card_fd, uint32_t width, uint32_t height, TestFramebuffer *fb) {
+    struct drm_mode_create_dumb create = { .width = width, .height = height, .bpp = 32 };
+    if (drmIoctl(card_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+        log_error("[vkms] CREATE_DUMB %ux%u failed: %s\n", width, height, strerror(errno));
+        return -1;
+    }
+
+    uint32_t fb_id = 0;
+    if (drmModeAddFB(card_fd, width, height, 24, 32, create.pitch, create.handle, &fb_id) != 0) {
+        log_error("[vkms] ADDFB %ux%u failed: %s\n", width, height, strerror(errno));
+        struct drm_mode_destroy_dumb destroy = { .handle = create.handle };
+        drmIoctl(card_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+        return -1;
+    }
+
+    fb->fb_id = fb_id;
+    fb->handle = create.handle;
+    fb->width = width;
+    fb->height = height;
+    return 0;
+}
+
+static void destroy_framebuffer(int card_fd, TestFramebuffer *fb) {
+    if (fb->fb_id) {
+        drmModeRmFB(card_fd, fb->fb_id);
+    }
+    if (fb->handle) {
+        struct drm_mode_destroy_dumb destroy = { .handle = fb->handle };
+        drmIoctl(card_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    }
+    memset(fb, 0, sizeof(*fb));
+}
+
+// Stands in for the FRAMEBUFFER_ID RandR property
+static uint32_t published_framebuffer_id(const char *connector_name, void *user_data) {
+    (void)connector_name;
+    Harness *harness = user_data;
+    return atomic_load(&harness->published_fb_id);
+}
+
+static void *capture_thread_func(void *arg) {
+    Harness *harness = arg;
+    CaptureThread *capture = &harness->capture;
+    int64_t next_tick_ns = monotonic_now_ns();
+
+    while (!atomic_load(&harness->stop)) {
+        int64_t start_ns = monotonic_now_ns();
+        int refreshed = drm_capture_refresh(capture);
+        int64_t end_ns = monotonic_now_ns();
+
+        if (refreshed < 0) {
+            atomic_fetch_add(&harness->refresh_errors, 1);
+        } else {
+            if (refreshed == 1) {
+                uint32_t rebind = atomic_load(&harness->rebind_count);
+                if (rebind < sizeof(harness->rebind_ns) / sizeof(harness->rebind_ns[0])) {
+                    harness->rebind_ns[rebind] = end_ns - start_ns;
+                    atomic_store(&harness->rebind_count, rebind + 1);
+                }
+            } else if (refreshed > 1) {
+                uint32_t reinit = atomic_load(&harness->reinit_count);
+                if (reinit < sizeof(harness->reinit_ns) / sizeof(harness->reinit_ns[0])) {
+                    harness->reinit_ns[reinit] = end_ns - start_ns;
+                    atomic_store(&harness->reinit_count, reinit + 1);
+                }
+            } else {
+                uint32_t tick = atomic_load(&harness->tick_count);
+                if (tick < harness->tick_capacity) {
+                    harness->tick_ns[tick] = end_ns - start_ns;
+                    atomic_store(&harness->tick_count, tick + 1);
+                }
+            }
+
+            // What hand_off_dmabuf does: the render thread gets its own FD per framebuffer
+            if (capture->fb_id != atomic_load(&harness->captured_fb_id)) {
+                int dup_fd = dup(capture->cached_dmabuf_fd);
+                if (dup_fd >= 0) {
+                    if (harness->handed_fd >= 0) {
+                        close(harness->handed_fd);
+                    }
+                    harness->handed_fd = dup_fd;
+                    atomic_store(&harness->captured_at_ns, monotonic_now_ns());
+                    atomic_store(&harness->captured_fb_id, capture->fb_id);
+                }
+            }
+        }
+
+        next_tick_ns += harness->period_ns;
+        if (next_tick_ns < end_ns) {
+            next_tick_ns = end_ns;
+        }
+        sleep_until_ns(next_tick_ns);
+    }
+    return NULL;
+}
+
+static bool wait_for_capture(Harness *harness, uint32_t fb_id) {
+    int64_t deadline_ns = monotonic_now_ns() + WAIT_TIMEOUT_NS;
+    while (atomic_load(&harness->captured_fb_id) != fb_id) {
+        if (monotonic_now_ns() > deadline_ns) {
+            return false;
+        }
+        sleep_until_ns(monotonic_now_ns() + 100000);
+    }
+    return true;
+}
+
+static int compare_int64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *what, int64_t *samples, uint32_t count, double unit_ns, const char *unit) {
+    if (count == 0) {
+        log_info("[vkms] %s: no samples\n", what);
+        return;
+    }
+    qsort(samples, count, sizeof(samples[0]), compare_int64);
+    double sum = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += (double)samples[i];
+    }
+    log_info("[vkms] %s: n=%u mean=%.1f%s p50=%.1f%s p99=%.1f%s max=%.1f%s\n", what, count,
+             sum / count / unit_ns, unit,
+             samples[count / 2] / unit_ns, unit,
+             samples[(uint32_t)((count - 1) * 0.99)] / unit_ns, unit,
+             samples[count - 1] / unit_ns, unit);
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_FRAMES;
+    uint32_t changes = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : DEFAULT_CHANGES;
+    uint32_t capture_hz = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : DEFAULT_CAPTURE_HZ;
+    uint32_t render_hz = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 10) : DEFAULT_RENDER_HZ;
+    if (frames == 0 || capture_hz == 0 || render_hz == 0) {
+        fprintf(stderr, "Usage: %s [frames] [changes] [capture_hz] [render_hz]\n", argv[0]);
+        return 1;
+    }
+
+    log_init();
+
+    int card_fd = open_vkms_card();
+    if (card_fd < 0) {
+        log_warn("[vkms] No vkms device (modprobe vkms), skipping\n");
+        return EXIT_SKIP;
+    }
+
+    int baseline_fds = count_open_fds();
+
+    static Harness harness;
+    harness.capture.connector_name = "XR-0";
+    harness.capture.drm_fd = -1;
+    harness.capture.cached_dmabuf_fd = -1;
+    harness.capture.service_fd = -1;
+    harness.period_ns = 1000000000LL / capture_hz;
+    harness.handed_fd = -1;
+    harness.tick_capacity = frames;
+    harness.tick_ns = calloc(frames, sizeof(int64_t));
+    if (!harness.tick_ns) {
+        return 1;
+    }
+    drm_capture_set_framebuffer_id_source(published_framebuffer_id, &harness);
+
+    static const uint32_t sizes[][2] = { {1920, 1080}, {1280, 720}, {2560, 1440} };
+    TestFramebuffer current = {0};
+    if (create_framebuffer(card_fd, sizes[0][0], sizes[0][1], &current) != 0) {
+        return 1;
+    }
+    atomic_store(&harness.published_fb_id, current.fb_id);
+
+    int result = 0;
+    int64_t init_start_ns = monotonic_now_ns();
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, capture_thread_func, &harness) != 0) {
+        log_error("[vkms] Failed to start capture thread\n");
+        return 1;
+    }
+
+    if (!wait_for_capture(&harness, current.fb_id)) {
+        log_error("[vkms] Capture never picked up FB %u (running as root?)\n", current.fb_id);
+        result = 1;
+    } else {
+        log_info("[vkms] First capture after %.2fms\n", (atomic_load(&harness.captured_at_ns) - init_start_ns) / 1e6);
+
+        // Steady state
+        while (atomic_load(&harness.tick_count) < frames) {
+            sleep_until_ns(monotonic_now_ns() + harness.period_ns);
+        }
+
+        // Mode changes: the new framebuffer is published before the old one goes away
+        int64_t *recovery_ns = calloc(changes ? changes : 1, sizeof(int64_t));
+        uint32_t recovered = 0;
+        for (uint32_t i = 0; i < changes && recovery_ns; i++) {
+            const uint32_t *size = sizes[(i + 1) % (sizeof(sizes) / sizeof(sizes[0]))];
+            TestFramebuffer next = {0};
+            if (create_framebuffer(card_fd, size[0], size[1], &next) != 0) {
+                result = 1;
+                break;
+            }
+            atomic_store(&harness.published_fb_id, next.fb_id);
+            int64_t removed_ns = monotonic_now_ns();
+            destroy_framebuffer(card_fd, &current);
+            current = next;
+
+            if (!wait_for_capture(&harness, current.fb_id)) {
+                log_error("[vkms] Capture didn't recover onto FB %u\n", current.fb_id);
+                result = 1;
+                break;
+            }
+            if (harness.capture.width != current.width || harness.capture.height != current.height) {
+                log_error("[vkms] Captured %ux%u, expected %ux%u\n", harness.capture.width,
+                          harness.capture.height, current.width, current.height);
+                result = 1;
+            }
+            recovery_ns[recovered++] = atomic_load(&harness.captured_at_ns) - removed_ns;
+        }
+
+        // The first capture is a full init; every change after it should rebind
+        uint32_t reinits = atomic_load(&harness.reinit_count);
+        if (reinits > 1) {
+            log_error("[vkms] %u framebuffer changes re-initialized capture instead of rebinding\n", reinits - 1);
+            result = 1;
+        }
+
+        report("capture tick", harness.tick_ns, atomic_load(&harness.tick_count), 1e3, "us");
+        report("rebind", harness.rebind_ns, atomic_load(&harness.rebind_count), 1e3, "us");
+        report("re-init", harness.reinit_ns, reinits, 1e6, "ms");
+        if (recovery_ns && recovered) {
+            report("framebuffer change recovery", recovery_ns, recovered, 1e6, "ms");
+            int64_t render_period_ns = 1000000000LL / render_hz;
+            int64_t worst_ns = recovery_ns[recovered - 1];  // report() sorted them
+            if (worst_ns > render_period_ns) {
+                log_error("[vkms] Worst framebuffer change recovery %.2fms exceeds one %uHz render frame (%.2fms)\n",
+                          worst_ns / 1e6, render_hz, render_period_ns / 1e6);
+                result = 1;
+            }
+        }
+        free(recovery_ns);
+    }
+
+    atomic_store(&harness.stop, true);
+    pthread_join(thread, NULL);
+    if (harness.handed_fd >= 0) {
+        close(harness.handed_fd);
+    }
+    cleanup_drm_capture(&harness.capture);
+    drm_capture_set_framebuffer_id_source(NULL, NULL);
+    destroy_framebuffer(card_fd, &current);
+    free(harness.tick_ns);
+
+    int remaining_fds = count_open_fds();
+    if (remaining_fds != baseline_fds) {
+        log_error("[vkms] FD leak: %d open before capture, %d after cleanup\n", baseline_fds, remaining_fds);
+        result = 1;
+    } else {
+        log_info("[vkms] No FD leaks (%d open)\n", remaining_fds);
+    }
+    if (atomic_load(&harness.refresh_errors)) {
+        log_warn("[vkms] %u capture ticks failed to refresh\n", atomic_load(&harness.refresh_errors));
+    }
+
+    close(card_fd);
+    log_info("[vkms] %s\n", result == 0 ? "PASS" : "FAIL");
+    log_cleanup();
+    return result;
+}